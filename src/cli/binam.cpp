@@ -16,7 +16,9 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <core/any_binam.hpp>
 #include <core/binam.hpp>
+#include <core/capacity_curve.hpp>
 #include <core/entropy.hpp>
 #include <core/parameters.hpp>
 #include <csignal>
@@ -53,16 +55,16 @@ void information_graph(size_t bits_in, size_t bits_out, size_t ones_in,
 {
 	std::ofstream file;
 	file.open("data.txt", std::ios::out);
-	for (size_t i = 1; i <= max_sample; i++) {
-		DataParameters params(bits_in, bits_out, ones_in, ones_out, i);
-		BiNAM_Container<uint64_t> binam(params);
-		binam.set_up().recall();
-		auto se = binam.false_bits();
-		double info = entropy_hetero(params, se);
-		file << i << "," << info << ","
-		     << binam.sum_false_bits(binam.false_bits()).fp << "\n";
-		show_progress(double(i) / double(max_sample));
-	}
+	DataParameters params(bits_in, bits_out, ones_in, ones_out, max_sample);
+	dispatch_cell_type(CellCalibration::select(params), [&](auto tag) {
+		CapacityCurve<typename decltype(tag)::type> curve(params);
+		curve.set_up();
+		for (size_t i = 1; i <= max_sample; i++) {
+			auto res = curve.train_until(i).analysis();
+			file << i << "," << res.Info << "," << res.fp << "\n";
+			show_progress(double(i) / double(max_sample));
+		}
+	});
 	std::cerr << std::endl;
 	file.close();
 }
@@ -102,9 +104,9 @@ int main(int argc, char *argv[])
 	          << DataParameters::optimal_sample_count(params) << std::endl;
 	std::cout << n_bits << " bits, " << n_ones << " ones and " << n_samples
 	          << " samples" << std::endl;
-	BiNAM_Container<uint64_t> binam(params);
-	binam.set_up().recall().analysis();
-	binam.trained_matrix().print();
+	auto binam = AnyBiNAM_Container::make(params);
+	binam->set_up().recall().analysis();
+	binam->visit([](auto &cont) { cont.trained_matrix().print(); });
 	// binam.print();
 	return 0;
 }
@@ -0,0 +1,140 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Tool for training large BiNAMs with independent jobs: the sample files
+ * written by the data_generator are split into shards, every shard is trained
+ * by a separate process and the resulting matrices are merged afterwards.
+ * All files are written in the MatrixFile format, sample files may also use
+ * the older raw format of BinaryMatrix::write() or be sparse pattern files,
+ * which are split into sparse pattern files again.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <core/binam.hpp>
+#include <util/binary_matrix.hpp>
+#include <util/matrix_file.hpp>
+#include <util/pattern_file.hpp>
+#include <util/thread_pool.hpp>
+
+using namespace nam;
+
+static BinaryMatrix<uint64_t> read_file(
+    const std::string &name, MatrixFile::Info *info = nullptr)
+{
+	return MatrixFile::read<uint64_t>(name, true, info);
+}
+
+static BinaryMatrix<uint64_t> read_data(
+    const std::string &name, MatrixFile::Info *info = nullptr)
+{
+	return read_pattern_file<uint64_t>(name, info);
+}
+
+static void write_file(const std::string &name,
+                       const BinaryMatrix<uint64_t> &mat,
+                       const MatrixFile::Info &info)
+{
+	MatrixFile::write(name, mat, info);
+}
+
+static MatrixFile::Info binam_info()
+{
+	MatrixFile::Info info;
+	info.content = MatrixFile::Content::BINAM;
+	return info;
+}
+
+/**
+ * Splits the samples in @param data into @param shards files <data>.<k>.
+ */
+static void split(const std::string &data, size_t shards)
+{
+	MatrixFile::Info info;
+	const bool sparse = is_pattern_file(data);
+	auto mat = read_data(data, &info);
+	for (size_t k = 0; k < shards; k++) {
+		const std::string name = data + "." + std::to_string(k);
+		auto shard = mat.row_range(k * mat.rows() / shards,
+		                           (k + 1) * mat.rows() / shards);
+		if (sparse) {
+			PatternFileWriter(name, mat.cols(), info).add(shard).close();
+		}
+		else {
+			write_file(name, shard, info);
+		}
+	}
+}
+
+/**
+ * Trains a BiNAM with the samples in @param data_in and @param data_out and
+ * writes it to @param matrix.
+ */
+static void train(const std::string &data_in, const std::string &data_out,
+                  const std::string &matrix)
+{
+	auto in = read_data(data_in);
+	auto out = read_data(data_out);
+	BiNAM<uint64_t> binam(out.cols(), in.cols());
+	binam.pool(ThreadPool::shared());
+	binam.train_mat(in, out);
+	write_file(matrix, binam, binam_info());
+}
+
+/**
+ * Merges the trained matrices in @param shards and writes the result to
+ * @param matrix.
+ */
+static void merge(const std::string &matrix,
+                  const std::vector<std::string> &shards)
+{
+	BiNAM<uint64_t> binam(read_file(shards[0]));
+	binam.pool(ThreadPool::shared());
+	for (size_t k = 1; k < shards.size(); k++) {
+		binam.merge(BiNAM<uint64_t>(read_file(shards[k])));
+	}
+	write_file(matrix, binam, binam_info());
+}
+
+int main(int argc, char *argv[])
+{
+	const std::string cmd = argc > 1 ? argv[1] : "";
+	if (cmd == "split" && argc == 4 && std::stoi(argv[3]) > 0) {
+		split(argv[2], std::stoi(argv[3]));
+	}
+	else if (cmd == "train" && argc == 5) {
+		train(argv[2], argv[3], argv[4]);
+	}
+	else if (cmd == "merge" && argc >= 4) {
+		merge(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+	}
+	else {
+		std::cerr << "Usage: ./binam_shard split <DATA> <SHARDS>" << std::endl
+		          << "    or ./binam_shard train <DATA_IN> <DATA_OUT> <MATRIX>"
+		          << std::endl
+		          << "    or ./binam_shard merge <MATRIX> <SHARD_MATRIX>..."
+		          << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -24,6 +24,8 @@
 
 #include <util/binary_matrix.hpp>
 #include <util/data.hpp>
+#include <util/matrix_file.hpp>
+#include <util/pattern_file.hpp>
 
 using namespace nam;
 
@@ -67,8 +69,11 @@ int main(int argc, char *argv[])
 {
 	signal(SIGINT, int_handler);
 
-	if (argc != 5) {
-		std::cerr << "Usage: ./data_generator <BITS> <ONES> <SAMPLES> <seed>"
+	if (argc < 5 || argc > 7 ||
+	    (argc == 7 && std::string(argv[6]) != "dense" &&
+	     std::string(argv[6]) != "sparse")) {
+		std::cerr << "Usage: ./data_generator <BITS> <ONES> <SAMPLES> <seed> "
+		             "[<FILE> [dense|sparse]]"
 		          << std::endl;
 		return 1;
 	}
@@ -77,6 +82,8 @@ int main(int argc, char *argv[])
 	int n_ones = std::stoi(argv[2]);
 	int n_samples = std::stoi(argv[3]);
 	size_t seed = std::stoi(argv[4]);
+	std::string file = argc >= 6 ? argv[5] : "data";
+	bool sparse = argc == 7 && std::string(argv[6]) == "sparse";
 
 	if (n_bits < 0 || n_ones < 0 || n_samples < 0) {
 		std::cerr << "Invalid parameter combination, all arguments "
@@ -91,9 +98,26 @@ int main(int argc, char *argv[])
 	std::cout << "bits, ones, samples, seed: " << n_bits << ", " << n_ones
 	          << ", " << n_samples << ", " << seed << std::endl;
 
+	MatrixFile::Info info;
+	info.ones = n_ones;
+	info.seed = seed;
+	info.random = info.balanced = info.unique = true;
+
 	// Generate the requested data
 	std::cerr << "Generating data..." << std::endl;
 	DataGenerator empty(seed, true, true, true);
+	if (sparse) {
+		// Patterns are written as they are generated, no matrix is built
+		PatternFileWriter writer(file, n_bits, info);
+		empty.generate_idx(n_bits, n_ones, n_samples,
+		                   [&writer](size_t, const std::vector<uint32_t> &idx) {
+			                   writer.add(idx);
+			               },
+		                   show_progress);
+		writer.close();
+		std::cerr << std::endl;
+		return 0;
+	}
 	auto data =
 	    empty.generate<uint64_t>(n_bits, n_ones, n_samples, show_progress);
 	std::cerr << std::endl;
@@ -105,15 +129,7 @@ int main(int argc, char *argv[])
 	    }
 	    std::cout << std::endl;
 	}*/
-	std::fstream ss("data", std::fstream::out);
-	size_t height = n_samples;
-	size_t width = n_bits;
-	ss.write((char *)&width, sizeof(width));
-	ss.write((char *)&height, sizeof(height));
-	ss.write((char *)data.cells().data(),
-	         data.cells().size() * sizeof(uint64_t));
-
-	ss.close();
+	MatrixFile::write(file, data, info);
 
 	return 0;
 }
@@ -17,14 +17,43 @@
  */
 
 #include <cmath>
+#include <tuple>
+#include <utility>
 
 #include "util/binary_matrix.hpp"
+#include "core/any_binam.hpp"
 #include "core/binam.hpp"
 #include "core/entropy.hpp"
 #include "core/parameters.hpp"
 
 using namespace nam;
 
+/**
+ * Analyses the recall of @param binam replaced by random patterns, returns the
+ * sum and the sum of squares of the information relative to @param info_th
+ */
+template <typename T>
+std::pair<double, double> random_recalls(BiNAM_Container<T> &binam,
+                                         size_t info_th)
+{
+	const DataParameters &params = binam.m_params;
+	double sum = 0.0, sum_sq = 0.0;
+	for (size_t i = 0; i < 50; i++) {
+		for (size_t j = 0; j < 10; j++) {
+			auto res_mat =
+			    DataGenerator(true, false, false)
+			        .generate<T>(params.bits_out(), params.ones_out(),
+			                     params.samples());
+			auto res = binam.analysis(res_mat);
+			float info_res = float(res.Info) / float(info_th);
+			sum += info_res;
+			sum_sq += info_res * info_res;
+			std::cout << i << ", " << info_res << std::endl;
+		}
+	}
+	return std::make_pair(sum, sum_sq);
+}
+
 /**
  * This program calculates the information stored in a BiNAM with random output
  */
@@ -43,25 +72,15 @@ int main(int argc, char *argv[])
 	int n_ones_out = std::stoi(argv[4]);
 	int n_samples = std::stoi(argv[5]);
 
-	auto binam = BiNAM_Container<uint64_t>(
+	auto binam = AnyBiNAM_Container::make(
 	    DataParameters(n_bits_in, n_bits_out, n_ones_in, n_ones_out, n_samples),
 	    DataGenerationParameters(1234, 1, 1, 1));
-	binam.set_up().recall();
-	size_t info_th = binam.analysis().Info;
+	size_t info_th = binam->set_up().recall_analysis().Info;
 	double average = 0.0;
 	double deviation = 0.0;
-	for (size_t i = 0; i < 50; i++) {
-		for (size_t j = 0; j < 10; j++) {
-			auto res_mat =
-			    DataGenerator(true, false, false)
-			        .generate<uint64_t>(n_bits_out, n_ones_out, n_samples);
-			auto res = binam.analysis(res_mat);
-			float info_res = float(res.Info) / float(info_th);
-			average += info_res;
-			deviation += info_res * info_res;
-			std::cout << i << ", " << info_res << std::endl;
-		}
-	}
+	binam->visit([&](auto &cont) {
+		std::tie(average, deviation) = random_recalls(cont, info_th);
+	});
 	deviation = std::sqrt((deviation - average * average / 500) / 499);
 	average = average / 500;
 	std::cout << "Average : " << average << std::endl;
@@ -17,11 +17,13 @@
  */
 
 #include "recurrent/rec_binam.hpp"
+#include "recurrent/rec_capacity_curve.hpp"
 
 #include <cstring>
 #include <iomanip>
 #include <thread>
 
+#include "core/any_binam.hpp"
 #include "core/binam.hpp"
 #include "core/entropy.hpp"
 
@@ -59,34 +61,21 @@ void information_graph(size_t bits_in, size_t bits_out, size_t ones_in,
 		file << ", info_rec_opti, fp_rec_opti, fn_rec_opti";
 	}
 	file << std::endl;
+
+	DataParameters params(bits_in, bits_out, ones_in, ones_out, max_sample);
+	RecCapacityCurve curve_res(params, true), curve_out(params, false);
+	curve_res.set_up();
+	if (rec) {
+		curve_out.set_up();
+	}
 	for (size_t i = 1; i <= max_sample; i++) {
-		DataParameters params(bits_in, bits_out, ones_in, ones_out, i);
-		BiNAM_Container<uint64_t> binam(params);
 		ExpResults se1, se2, se3;
-		std::thread normal_binam([&]() mutable {
-			binam.set_up().recall();
-			se1 = binam.analysis();
-		});
-		RecBinam binam2, binam3;
-
+		se1 = curve_res.train_until(i).analysis();
 		if (rec) {
-			binam2 = RecBinam(params);
-			binam3 = RecBinam(params);
-			std::thread true_rec_binam([&]() mutable {
-				binam2.set_up(true);
-				se2 = binam2.analysis();
-			});
-			std::thread false_rec_binam([&]() mutable {
-				binam3.set_up(false);
-				se3 = binam3.analysis();
-			});
-
-			true_rec_binam.join();
-			false_rec_binam.join();
+			se2 = curve_res.analysis_rec();
+			se3 = curve_out.train_until(i).analysis_rec();
 		}
 
-		normal_binam.join();
-
 		// double info = entropy_hetero(params, se1);
 		file << i << "," << se1.Info << "," << se1.fp;
 		if (rec) {
@@ -152,8 +141,9 @@ int main(int argc, char *argv[])
 			res.print();
 		}
 		else {
-			BiNAM_Container<uint64_t> binam(params);
-			auto res = binam.set_up().recall().analysis();
+			auto res = AnyBiNAM_Container::make(params)
+			               ->set_up()
+			               .recall_analysis();
 			res.print();
 		}
 	}
@@ -0,0 +1,200 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "any_binam.hpp"
+#include "util/data.hpp"
+
+namespace nam {
+
+constexpr size_t CellCalibration::MAX_SAMPLES;
+constexpr size_t CellCalibration::MAX_BYTES;
+constexpr size_t CellCalibration::REPEAT;
+
+namespace {
+using Key = std::tuple<size_t, size_t, size_t, size_t, size_t>;
+
+std::mutex &cache_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::map<Key, size_t> &cache()
+{
+	static std::map<Key, size_t> cache;
+	return cache;
+}
+
+size_t env_bits()
+{
+	const char *env = std::getenv(CellCalibration::ENV_CELL_BITS);
+	if (!env || !*env) {
+		return 0;
+	}
+	for (size_t bits : cell_type_widths()) {
+		if (std::to_string(bits) == env) {
+			return bits;
+		}
+	}
+	throw std::invalid_argument(std::string("Invalid value \"") + env +
+	                            "\" for " + CellCalibration::ENV_CELL_BITS);
+}
+
+/**
+ * Time of the fastest of CellCalibration::REPEAT runs of training, recall
+ * and evaluation of the samples @param in and @param out
+ */
+template <typename T>
+double run_benchmark(const BinaryMatrix<T> &in, const BinaryMatrix<T> &out)
+{
+	double res = std::numeric_limits<double>::max();
+	size_t errors = 0;
+	for (size_t r = 0; r < CellCalibration::REPEAT; r++) {
+		const auto start = std::chrono::steady_clock::now();
+		BiNAM<T> binam(out.cols(), in.cols());
+		binam.train_mat(in, out);
+		const auto recall = binam.recallMat(in);
+		for (const auto &se : BiNAM<T>::false_bits_mat(out, recall)) {
+			errors += se.fp + se.fn;
+		}
+		const std::chrono::duration<double> time =
+		    std::chrono::steady_clock::now() - start;
+		res = std::min(res, time.count());
+	}
+	// Keeps the evaluation from being optimised away
+	volatile size_t sink = errors;
+	(void)sink;
+	return res;
+}
+}
+
+std::vector<size_t> CellCalibration::candidates(const DataParameters &params)
+{
+	const size_t longest = std::max(params.bits_in(), params.bits_out());
+	std::vector<size_t> res;
+	for (size_t bits : cell_type_widths()) {
+		if (res.empty() || bits <= 2 * longest) {
+			res.push_back(bits);
+		}
+	}
+	return res;
+}
+
+DataParameters CellCalibration::benchmark_params(const DataParameters &params)
+{
+	const size_t samples =
+	    params.samples() ? std::min(params.samples(), MAX_SAMPLES)
+	                     : MAX_SAMPLES;
+	const size_t row_bytes =
+	    BinaryMatrix<uint64_t>::rowStride(params.bits_in()) * sizeof(uint64_t);
+	const size_t max_rows = std::max<size_t>(MAX_BYTES / row_bytes, 1);
+	size_t bits_out = params.bits_out(), ones_out = params.ones_out();
+	if (bits_out > max_rows) {
+		ones_out = std::max<size_t>(ones_out * max_rows / bits_out, 1);
+		bits_out = max_rows;
+	}
+	return DataParameters(params.bits_in(), bits_out, params.ones_in(),
+	                      ones_out, samples);
+}
+
+std::vector<CellCalibration::Timing> CellCalibration::benchmark(
+    const DataParameters &params)
+{
+	const DataParameters p = benchmark_params(params);
+	std::vector<Timing> res;
+	for (size_t bits : candidates(params)) {
+		dispatch_cell_type(bits, [&](auto tag) {
+			using T = typename decltype(tag)::type;
+			const auto in = DataGenerator(size_t(1234)).generate<T>(
+			    p.bits_in(), p.ones_in(), p.samples());
+			const auto out = DataGenerator(size_t(4321)).generate<T>(
+			    p.bits_out(), p.ones_out(), p.samples());
+			res.push_back({bits, run_benchmark(in, out)});
+		});
+	}
+	return res;
+}
+
+size_t CellCalibration::select(const DataParameters &params)
+{
+	const size_t env = env_bits();
+	if (env) {
+		return env;
+	}
+	const std::vector<size_t> widths = candidates(params);
+	if (widths.size() == 1) {
+		return widths[0];
+	}
+
+	const DataParameters p = benchmark_params(params);
+	const Key key(p.bits_in(), p.bits_out(), p.ones_in(), p.ones_out(),
+	              p.samples());
+	std::lock_guard<std::mutex> lock(cache_mutex());
+	auto it = cache().find(key);
+	if (it == cache().end()) {
+		const auto timings = benchmark(params);
+		const auto best = std::min_element(
+		    timings.begin(), timings.end(),
+		    [](const Timing &a, const Timing &b) {
+			    return a.seconds < b.seconds;
+			});
+		it = cache().emplace(key, best->bits).first;
+	}
+	return it->second;
+}
+
+void CellCalibration::clear()
+{
+	std::lock_guard<std::mutex> lock(cache_mutex());
+	cache().clear();
+}
+
+std::unique_ptr<AnyBiNAM_Container> AnyBiNAM_Container::make(
+    DataParameters params, DataGenerationParameters datagen, size_t bits)
+{
+	if (bits == 0) {
+		bits = CellCalibration::select(params);
+	}
+	std::unique_ptr<AnyBiNAM_Container> res;
+	dispatch_cell_type(bits, [&](auto tag) {
+		using T = typename decltype(tag)::type;
+		res.reset(new CellBiNAM_Container<T>(params, datagen));
+	});
+	if (!res) {
+		std::stringstream ss;
+		ss << "No cell type with " << bits << " bits" << std::endl;
+		throw std::invalid_argument(ss.str());
+	}
+	return res;
+}
+
+std::unique_ptr<AnyBiNAM_Container> AnyBiNAM_Container::make(
+    DataParameters params, size_t bits)
+{
+	return make(params, DataGenerationParameters(), bits);
+}
+}
@@ -0,0 +1,350 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_CORE_ANY_BINAM_HPP
+#define CPPNAM_CORE_ANY_BINAM_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "core/binam.hpp"
+#include "core/entropy.hpp"
+#include "core/parameters.hpp"
+#include "util/binary_matrix.hpp"
+#include "util/population_count.hpp"
+
+namespace nam {
+
+/**
+ * Cell types of the matrices which can be selected at runtime, see
+ * dispatch_cell_type(). Wider vectors are used by the kernels of BitOps
+ * independently of the cell type, as they work on whole rows.
+ */
+using CellTypes = std::tuple<uint32_t, uint64_t, uint128_t>;
+
+/**
+ * Tag passed to the callback of dispatch_cell_type(), carries the selected
+ * cell type
+ */
+template <typename T>
+struct CellType {
+	using type = T;
+};
+
+namespace internal {
+template <typename Types>
+struct CellDispatch;
+
+template <>
+struct CellDispatch<std::tuple<>> {
+	template <typename F>
+	static bool run(size_t, F &)
+	{
+		return false;
+	}
+
+	static void widths(std::vector<size_t> &) {}
+};
+
+template <typename T, typename... Types>
+struct CellDispatch<std::tuple<T, Types...>> {
+	template <typename F>
+	static bool run(size_t bits, F &f)
+	{
+		if (bits == BinaryMatrix<T>::intWidth) {
+			f(CellType<T>());
+			return true;
+		}
+		return CellDispatch<std::tuple<Types...>>::run(bits, f);
+	}
+
+	static void widths(std::vector<size_t> &res)
+	{
+		res.push_back(BinaryMatrix<T>::intWidth);
+		CellDispatch<std::tuple<Types...>>::widths(res);
+	}
+};
+}
+
+/**
+ * Calls @param f with a CellType tag of the cell type of @param bits bits if
+ * it is one of @param Types (by default CellTypes). Returns false, without
+ * calling f, otherwise. Usually f is a generic lambda:
+ *
+ *     dispatch_cell_type(CellCalibration::select(params), [&](auto tag) {
+ *         using T = typename decltype(tag)::type;
+ *         CapacityCurve<T> curve(params);
+ *         ...
+ *     });
+ */
+template <typename Types = CellTypes, typename F>
+bool dispatch_cell_type(size_t bits, F &&f)
+{
+	return internal::CellDispatch<Types>::run(bits, f);
+}
+
+/**
+ * Widths of the cell types @param Types in bits, in the order of the tuple
+ */
+template <typename Types = CellTypes>
+std::vector<size_t> cell_type_widths()
+{
+	std::vector<size_t> res;
+	internal::CellDispatch<Types>::widths(res);
+	return res;
+}
+
+/**
+ * Selects the cell width of the matrices for a network geometry. Narrow cells
+ * waste fewer bits in the last cell of a row and in the loops over the set
+ * bits, wide cells need fewer steps for the bit-sliced counters and the cell
+ * loops of large networks, so the best width depends on the geometry and the
+ * CPU. A short benchmark trains and recalls every candidate on a network of
+ * the same geometry, the choice is cached per geometry for the lifetime of
+ * the process. As the choice is based on timing, it may differ between runs
+ * and machines unless it is fixed with the environment variable
+ * CPPNAM_CELL_BITS. The results of the networks do not depend on the width.
+ */
+class CellCalibration {
+public:
+	/**
+	 * Name of the environment variable fixing the cell width, one of "32",
+	 * "64" or "128"
+	 */
+	static constexpr const char *ENV_CELL_BITS = "CPPNAM_CELL_BITS";
+
+	/**
+	 * Limits of the benchmark network: number of samples and size of the
+	 * storage matrix in bytes. Larger networks are benchmarked with fewer
+	 * output neurons, as the rows are processed independently.
+	 */
+	static constexpr size_t MAX_SAMPLES = 500;
+	static constexpr size_t MAX_BYTES = size_t(4) << 20;
+
+	/**
+	 * Number of runs per candidate, the fastest one counts
+	 */
+	static constexpr size_t REPEAT = 3;
+
+	/**
+	 * Result of the benchmark for one cell width
+	 */
+	struct Timing {
+		size_t bits;
+		double seconds;
+	};
+
+	/**
+	 * Cell widths worth trying for @param params: all widths of CellTypes
+	 * which are at most twice as wide as the longest pattern, but at least
+	 * the narrowest one.
+	 */
+	static std::vector<size_t> candidates(const DataParameters &params);
+
+	/**
+	 * Geometry of the benchmark network for @param params, see MAX_SAMPLES
+	 * and MAX_BYTES
+	 */
+	static DataParameters benchmark_params(const DataParameters &params);
+
+	/**
+	 * Trains and recalls a network of the geometry benchmark_params() with
+	 * every candidate width and returns the run times. Uses a single thread.
+	 */
+	static std::vector<Timing> benchmark(const DataParameters &params);
+
+	/**
+	 * Cell width for @param params: the value of CPPNAM_CELL_BITS if set, the
+	 * only candidate if there is one, otherwise the fastest width of
+	 * benchmark(). The benchmark runs on first use of a geometry, later
+	 * calls return the cached choice. Throws std::invalid_argument if
+	 * CPPNAM_CELL_BITS is invalid.
+	 */
+	static size_t select(const DataParameters &params);
+
+	/**
+	 * Forgets all cached choices
+	 */
+	static void clear();
+};
+
+template <typename T>
+class CellBiNAM_Container;
+
+/**
+ * BiNAM_Container with a cell type chosen at runtime, for tools which work on
+ * networks of arbitrary size. Only the interface of the container which does
+ * not depend on the cell type is available directly, the typed container is
+ * accessible via visit():
+ *
+ *     auto binam = AnyBiNAM_Container::make(params);
+ *     binam->set_up().recall();
+ *     binam->visit([](auto &cont) { cont.trained_matrix().print(); });
+ *
+ * See BiNAM_Container for the documentation of the functions.
+ */
+class AnyBiNAM_Container {
+public:
+	virtual ~AnyBiNAM_Container(){};
+
+	/**
+	 * Creates a container with cells of @param bits bits, or of the width
+	 * selected by CellCalibration::select() if @param bits is zero. Throws
+	 * std::invalid_argument if there is no cell type of that width.
+	 */
+	static std::unique_ptr<AnyBiNAM_Container> make(
+	    DataParameters params, DataGenerationParameters datagen,
+	    size_t bits = 0);
+	static std::unique_ptr<AnyBiNAM_Container> make(DataParameters params,
+	                                                size_t bits = 0);
+
+	/**
+	 * Width of the cells in bits
+	 */
+	virtual size_t cell_bits() const = 0;
+
+	virtual AnyBiNAM_Container &input_major(bool input_major = true) = 0;
+	virtual AnyBiNAM_Container &kwta(size_t k) = 0;
+	virtual AnyBiNAM_Container &fixed(bool fixed) = 0;
+	virtual AnyBiNAM_Container &set_up() = 0;
+	virtual AnyBiNAM_Container &set_up_from_file() = 0;
+	virtual AnyBiNAM_Container &recall() = 0;
+
+	virtual ExpResults recall_analysis(bool sample_errors = false) = 0;
+	virtual ExpResults analysis(size_t n_samples_max = 0) = 0;
+	virtual std::vector<ExpResults> analysis_thresholds(size_t thresh_min,
+	                                                    size_t thresh_max) = 0;
+	virtual const std::vector<SampleError> &false_bits() = 0;
+	virtual SampleError theoretical_false_bits() = 0;
+	virtual std::vector<SampleError> predicted_false_bits() const = 0;
+	virtual FillStatistics fill_statistics() const = 0;
+	virtual void print(std::ostream &ofs = std::cout) = 0;
+
+	/**
+	 * Calls @param f with the typed BiNAM_Container
+	 */
+	template <typename F>
+	void visit(F &&f);
+};
+
+/**
+ * Implementation of AnyBiNAM_Container for the cell type T
+ */
+template <typename T>
+class CellBiNAM_Container : public AnyBiNAM_Container {
+private:
+	BiNAM_Container<T> m_container;
+
+public:
+	CellBiNAM_Container(DataParameters params,
+	                    DataGenerationParameters datagen)
+	    : m_container(params, datagen)
+	{
+	}
+
+	BiNAM_Container<T> &container() { return m_container; }
+	const BiNAM_Container<T> &container() const { return m_container; }
+
+	size_t cell_bits() const override { return BinaryMatrix<T>::intWidth; }
+
+	AnyBiNAM_Container &input_major(bool input_major = true) override
+	{
+		m_container.input_major(input_major);
+		return *this;
+	}
+	AnyBiNAM_Container &kwta(size_t k) override
+	{
+		m_container.kwta(k);
+		return *this;
+	}
+	AnyBiNAM_Container &fixed(bool fixed) override
+	{
+		m_container.fixed(fixed);
+		return *this;
+	}
+	AnyBiNAM_Container &set_up() override
+	{
+		m_container.set_up();
+		return *this;
+	}
+	AnyBiNAM_Container &set_up_from_file() override
+	{
+		m_container.set_up_from_file();
+		return *this;
+	}
+	AnyBiNAM_Container &recall() override
+	{
+		m_container.recall();
+		return *this;
+	}
+
+	ExpResults recall_analysis(bool sample_errors = false) override
+	{
+		return m_container.recall_analysis(sample_errors);
+	}
+	ExpResults analysis(size_t n_samples_max = 0) override
+	{
+		return m_container.analysis(n_samples_max);
+	}
+	std::vector<ExpResults> analysis_thresholds(size_t thresh_min,
+	                                            size_t thresh_max) override
+	{
+		return m_container.analysis_thresholds(thresh_min, thresh_max);
+	}
+	const std::vector<SampleError> &false_bits() override
+	{
+		return m_container.false_bits();
+	}
+	SampleError theoretical_false_bits() override
+	{
+		return m_container.theoretical_false_bits();
+	}
+	std::vector<SampleError> predicted_false_bits() const override
+	{
+		return m_container.predicted_false_bits();
+	}
+	FillStatistics fill_statistics() const override
+	{
+		return m_container.fill_statistics();
+	}
+	void print(std::ostream &ofs = std::cout) override
+	{
+		m_container.print(ofs);
+	}
+};
+
+template <typename F>
+void AnyBiNAM_Container::visit(F &&f)
+{
+	dispatch_cell_type(cell_bits(), [&](auto tag) {
+		using T = typename decltype(tag)::type;
+		f(static_cast<CellBiNAM_Container<T> &>(*this).container());
+	});
+}
+}
+
+#endif /* CPPNAM_CORE_ANY_BINAM_HPP */
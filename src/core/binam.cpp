@@ -16,8 +16,36 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "binam.hpp"
 
 namespace nam {
-// Do nothing here, just make sure the header compiles.
+
+double FillStatistics::fill() const
+{
+	const double size = double(row_ones.size()) * col_ones.size();
+	return size > 0 ? synapses / size : 0.0;
+}
+
+uint32_t FillStatistics::max_row_ones() const
+{
+	return row_ones.empty() ? 0 : *std::max_element(row_ones.begin(),
+	                                                 row_ones.end());
+}
+
+uint32_t FillStatistics::max_col_ones() const
+{
+	return col_ones.empty() ? 0 : *std::max_element(col_ones.begin(),
+	                                                 col_ones.end());
+}
+
+ExpResults &FillStatistics::annotate(ExpResults &res) const
+{
+	res.fill = fill();
+	res.synapses = synapses;
+	res.max_in = max_row_ones();
+	res.max_out = max_col_ones();
+	return res;
+}
 }
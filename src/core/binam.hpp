@@ -20,21 +20,62 @@
 
 #ifndef CPPNAM_CORE_BINAM_HPP
 #define CPPNAM_CORE_BINAM_HPP
+#include <algorithm>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "core/entropy.hpp"
+#include "core/fixed_binam.hpp"
+#include "core/overlap.hpp"
 #include "core/parameters.hpp"
 #include "util/binary_matrix.hpp"
+#include "util/bit_sliced_counter.hpp"
 #include "util/data.hpp"
+#include "util/bitops.hpp"
+#include "util/matrix_file.hpp"
+#include "util/pattern_file.hpp"
 #include "util/population_count.hpp"
+#include "util/sparse_pattern_matrix.hpp"
+#include "util/thread_pool.hpp"
 
 namespace nam {
 
+/**
+ * Number of set synapses of a BiNAM per output neuron (row), per input neuron
+ * (column) and in total, see BiNAM::fill_statistics()
+ */
+struct FillStatistics {
+	std::vector<uint32_t> row_ones, col_ones;
+	size_t synapses = 0;
+
+	/**
+	 * Fraction of set synapses, zero for an empty matrix
+	 */
+	double fill() const;
+
+	/**
+	 * Largest number of synapses of an output and of an input neuron, i.e.
+	 * the largest fan-in and fan-out of the network
+	 */
+	uint32_t max_row_ones() const;
+	uint32_t max_col_ones() const;
+
+	/**
+	 * Copies the statistics into the corresponding fields of @param res
+	 */
+	ExpResults &annotate(ExpResults &res) const;
+};
+
 /**
  * The BiNAM class is the BinaryMatrix class with additional instructions used
  * by the BiNAM_Container. This is basically still a simple matrix class, which
@@ -44,116 +85,1217 @@ template <typename T>
 class BiNAM : public BinaryMatrix<T> {
 private:
 	/**
-	 * Training of a sample pair. Dimensions are not checked, is only for
-	 * internal used
+	 * Input-major copy of the storage matrix: row j contains the synapses of
+	 * input neuron j onto all output neurons. Only maintained if the
+	 * input-major mode is active, see input_major().
+	 */
+	BinaryMatrix<T> m_columns;
+	bool m_input_major = false;
+
+	/**
+	 * Number of set bits of every row and column, maintained by the training
+	 * functions if m_counted is set, see recount(). Threads training in
+	 * parallel count their columns separately, see train_mat().
+	 */
+	std::vector<uint32_t> m_row_ones, m_col_ones;
+	bool m_counted = false;
+
+	/**
+	 * OR of the rows of every block of SUMMARY_ROWS rows, used to prune the
+	 * row-major recall. Only maintained if active, see summaries().
+	 */
+	BinaryMatrix<T> m_block_or;
+	bool m_summaries = false;
+
+	/**
+	 * Pool used to parallelise training and recall of whole matrices, these
+	 * run in the calling thread if no pool is set. See pool().
+	 */
+	std::shared_ptr<ThreadPool> m_pool;
+
+	/**
+	 * Training of a sample pair given as lists of active input and output
+	 * bits. Only the n_in x n_out affected synapses are set, new synapses are
+	 * counted in @param col_ones if the counts are maintained. Dimensions are
+	 * not checked, is only for internal use
+	 */
+	BiNAM<T> &train_idx(const uint32_t *in, size_t n_in, const uint32_t *out,
+	                    size_t n_out, uint32_t *col_ones)
+	{
+		for (size_t i = 0; i < n_out; i++) {
+			for (size_t j = 0; j < n_in; j++) {
+				if (m_counted && !Base::get_bit(out[i], in[j])) {
+					count_synapse(out[i], in[j], col_ones);
+				}
+				Base::set_bit(out[i], in[j]);
+			}
+		}
+		if (m_input_major) {
+			for (size_t j = 0; j < n_in; j++) {
+				for (size_t i = 0; i < n_out; i++) {
+					m_columns.set_bit(in[j], out[i]);
+				}
+			}
+		}
+		return *this;
+	}
+
+	/**
+	 * Training of a sample pair. Every row of an active output neuron gets
+	 * the input pattern OR-ed in cell by cell (and vice versa for the
+	 * input-major copy), nothing is allocated. Dimensions are not checked,
+	 * is only for internal used
+	 */
+	BiNAM<T> &train_vec(const ConstRowView<T> &in, const ConstRowView<T> &out)
+	{
+		for (size_t c = 0; c < out.numberOfCells(); c++) {
+			T cell = out.get_cell(c);
+			while (cell) {
+				const size_t i = c * Base::intWidth + trailing_zeros<T>(cell);
+				T *row = Base::row_ptr(i);
+				cell &= cell - 1;
+				for (size_t k = 0; m_counted && k < in.numberOfCells(); k++) {
+					T added = T(in.get_cell(k) & ~row[k]);
+					while (added) {
+						count_synapse(i,
+						              k * Base::intWidth +
+						                  trailing_zeros<T>(added),
+						              m_col_ones.data());
+						added &= added - 1;
+					}
+				}
+				BitOps::bit_or(row, row, in.data(), in.numberOfCells());
+			}
+		}
+		if (m_input_major) {
+			for (size_t c = 0; c < in.numberOfCells(); c++) {
+				T cell = in.get_cell(c);
+				while (cell) {
+					T *row = m_columns.row_ptr(c * Base::intWidth +
+					                           trailing_zeros<T>(cell));
+					cell &= cell - 1;
+					BitOps::bit_or(row, row, out.data(), out.numberOfCells());
+				}
+			}
+		}
+		return *this;
+	}
+
+	/**
+	 * Recall procedure for a single sample using a matrix @param cols with
+	 * one row per active bit of @param in, i.e. the input-major copy for the
+	 * forward and the matrix itself for the reverse direction. If
+	 * @param exact is set, the result is the bit-wise AND of the rows
+	 * selected by the active bits, otherwise the rows are summed up in
+	 * bit-sliced vertical counters and compared against @param thresh for a
+	 * whole cell of neurons at once.
+	 */
+	void recall_columns(const BinaryMatrix<T> &cols, const ConstRowView<T> &in,
+	                    bool exact, size_t thresh,
+	                    const RowView<T> &res) const
+	{
+		const size_t n_cells = Base::numberOfCells(cols.cols());
+		if (exact) {
+			for (size_t k = 0; k < n_cells; k++) {
+				res.set_cell(k, Base::intMax);
+			}
+			for (size_t j = 0; j < in.numberOfCells(); j++) {
+				T cell = in.get_cell(j);
+				while (cell) {
+					const T *col = cols.row_ptr(j * Base::intWidth +
+					                            trailing_zeros<T>(cell));
+					cell &= cell - 1;
+					BitOps::bit_and(res.data(), res.data(), col, n_cells);
+				}
+			}
+		}
+		else {
+			BitSlicedCounter<T> counter;
+			for (size_t k = 0; k < n_cells; k++) {
+				counter.reset();
+				for (size_t j = 0; j < in.numberOfCells(); j++) {
+					T cell = in.get_cell(j);
+					while (cell) {
+						counter.add(cols.get_cell(
+						    j * Base::intWidth + trailing_zeros<T>(cell), k));
+						cell &= cell - 1;
+					}
+				}
+				res.set_cell(k, counter.greater_equal(thresh));
+			}
+		}
+
+		// Clear the padding bits of the last cell
+		if (n_cells > 0 && cols.cols() % Base::intWidth) {
+			res.set_cell(n_cells - 1,
+			             res.get_cell(n_cells - 1) &
+			                 T((T(1) << (cols.cols() % Base::intWidth)) - 1));
+		}
+	}
+
+	/**
+	 * Throws if @param in and @param res do not fit to the input and output
+	 * size of the matrix
+	 */
+	void check_recall(const ConstRowView<T> &in,
+	                  const ConstRowView<T> &res) const
+	{
+		if (in.size() != Base::cols() || res.size() != Base::rows()) {
+			std::stringstream ss;
+			ss << "[" << in.size() << ", " << res.size()
+			   << "] out of range for matrix of size " << Base::cols() << " x "
+			   << Base::rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	/**
+	 * Builds the input-major copy of the trained matrix, see input_major().
+	 */
+	BinaryMatrix<T> build_columns() const
+	{
+		return Base::transposed(m_pool.get());
+	}
+
+	/**
+	 * Throws if @param out and @param res do not fit to the output and input
+	 * size of the matrix, see recall_reverse()
+	 */
+	void check_reverse(const ConstRowView<T> &out,
+	                   const ConstRowView<T> &res) const
+	{
+		if (out.size() != Base::rows() || res.size() != Base::cols()) {
+			std::stringstream ss;
+			ss << "[" << out.size() << ", " << res.size()
+			   << "] out of range for reverse recall with matrix of size "
+			   << Base::cols() << " x " << Base::rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	/**
+	 * Batched recall of the samples [begin, end) of @param in, at most
+	 * RECALL_TILE at once, using the input-major matrix @param columns. The
+	 * result cells of a query are the combination of the ones_in columns
+	 * selected by its active bits. The output neurons are processed in tiles
+	 * of RECALL_CELL_TILE cells, so the column segments of a tile stay in
+	 * cache for all queries of the tile.
+	 * If @param exact is set, an output bit is recalled if its row contains
+	 * every active bit of the query (bit-wise AND of the columns). Otherwise
+	 * the columns are summed up in bit-sliced vertical counters, one lane per
+	 * output neuron, and compared against @param thresh. The results are
+	 * written to the rows [begin, end) of @param res, shifted by
+	 * @param res_offs rows. The buffers @param idx and @param offs are reused
+	 * between tiles.
+	 */
+	void recall_tile(const BinaryMatrix<T> &columns, const BinaryMatrix<T> &in,
+	                 size_t begin, size_t end, bool exact, size_t thresh,
+	                 BinaryMatrix<T> &res, std::vector<uint32_t> &idx,
+	                 std::vector<size_t> &offs, ptrdiff_t res_offs = 0) const
+	{
+		// Gather the active bits of all queries in this tile
+		idx.clear();
+		offs.clear();
+		for (size_t q = begin; q < end; q++) {
+			offs.push_back(idx.size());
+			for (size_t c = 0; c < Base::numberOfCells(in.cols()); c++) {
+				T cell = in.get_cell(q, c);
+				while (cell) {
+					idx.push_back(c * Base::intWidth + trailing_zeros<T>(cell));
+					cell &= cell - 1;
+				}
+			}
+		}
+		offs.push_back(idx.size());
+
+		// Mapped columns are read in random order, ask the kernel to fetch
+		// the selected ones while the first queries are processed
+		if (columns.mapped()) {
+			for (auto j : idx) {
+				columns.advise_rows(j, j + 1, AlignedMemory::Advice::WILLNEED);
+			}
+		}
+
+		const size_t n_cells = Base::numberOfCells(columns.cols());
+		const T last_mask =
+		    columns.cols() % Base::intWidth
+		        ? T((T(1) << (columns.cols() % Base::intWidth)) - 1)
+		        : Base::intMax;
+		BitSlicedCounter<T> counter;
+		for (size_t c0 = 0; c0 < n_cells; c0 += RECALL_CELL_TILE) {
+			const size_t c1 = std::min(n_cells, c0 + RECALL_CELL_TILE);
+			for (size_t q = begin; q < end; q++) {
+				const uint32_t *first = idx.data() + offs[q - begin];
+				const uint32_t *last = idx.data() + offs[q - begin + 1];
+				T *dst = res.row_ptr(q + res_offs);
+				if (exact) {
+					// AND of the column segments, stops once nothing is left
+					if (first == last) {
+						std::fill(dst + c0, dst + c1, Base::intMax);
+					}
+					else {
+						std::copy(columns.row_ptr(*first) + c0,
+						          columns.row_ptr(*first) + c1, dst + c0);
+					}
+					for (auto j = first + 1; j < last; j++) {
+						if (BitOps::none(dst + c0, c1 - c0)) {
+							break;
+						}
+						BitOps::bit_and(dst + c0, dst + c0,
+						                columns.row_ptr(*j) + c0, c1 - c0);
+					}
+				}
+				else {
+					for (size_t c = c0; c < c1; c++) {
+						counter.reset();
+						for (auto j = first; j != last; j++) {
+							counter.add(columns.get_cell(*j, c));
+						}
+						dst[c] = counter.greater_equal(thresh);
+					}
+				}
+				if (c1 == n_cells) {
+					dst[n_cells - 1] &= last_mask;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Recall of a whole matrix of samples with the matrix @param cols, see
+	 * recall_columns(), processed in tiles of RECALL_TILE queries. The tiles
+	 * are distributed onto the thread pool. See recall_tile() for
+	 * @param exact and @param thresh.
+	 */
+	BinaryMatrix<T> recall_batched(const BinaryMatrix<T> &cols,
+	                               const BinaryMatrix<T> &in, bool exact,
+	                               size_t thresh) const
+	{
+		BinaryMatrix<T> res(in.rows(), cols.cols());
+		auto recall_samples = [&](size_t begin, size_t end) {
+			std::vector<uint32_t> idx;
+			std::vector<size_t> offs;
+			for (size_t i = begin; i < end; i += RECALL_TILE) {
+				recall_tile(cols, in, i, std::min(end, i + RECALL_TILE), exact,
+				            thresh, res, idx, offs);
+			}
+		};
+		parallel_for(m_pool.get(), 0, in.rows(), RECALL_TILE, recall_samples);
+		return res;
+	}
+
+	/**
+	 * k-winners-take-all recall of a single query given by its active bits
+	 * @param idx. The selected columns of @param cols are summed up in the
+	 * vertical counters @param counters, one per output cell. Starting at the
+	 * largest possible dendritic sum, the threshold is lowered until at least
+	 * @param k output neurons reach it (partial selection, nothing is
+	 * sorted). All neurons reaching the final threshold fire, so ties at the
+	 * k-th largest sum do not depend on the order of the neurons; neurons
+	 * with a sum of zero never fire. The result is written to row @param row
+	 * of @param res.
+	 */
+	void recall_kwta_row(const BinaryMatrix<T> &cols,
+	                     const std::vector<uint32_t> &idx, size_t k,
+	                     std::vector<BitSlicedCounter<T>> &counters,
+	                     BinaryMatrix<T> &res, size_t row) const
+	{
+		const size_t n_cells = Base::numberOfCells(Base::rows());
+		if (k == 0 || idx.empty()) {
+			for (size_t c = 0; c < n_cells; c++) {
+				res.set_cell(row, c, 0);
+			}
+			return;
+		}
+		const T last_mask =
+		    Base::rows() % Base::intWidth
+		        ? T((T(1) << (Base::rows() % Base::intWidth)) - 1)
+		        : Base::intMax;
+		for (size_t c = 0; c < n_cells; c++) {
+			counters[c].reset();
+			for (auto j : idx) {
+				counters[c].add(cols.get_cell(j, c));
+			}
+		}
+		size_t thresh = idx.size();
+		for (; thresh > 1; thresh--) {
+			size_t n = 0;
+			for (size_t c = 0; c < n_cells; c++) {
+				T ge = counters[c].greater_equal(thresh);
+				n += population_count<T>(c == n_cells - 1 ? T(ge & last_mask)
+				                                          : ge);
+			}
+			if (n >= k) {
+				break;
+			}
+		}
+		for (size_t c = 0; c < n_cells; c++) {
+			T ge = counters[c].greater_equal(thresh);
+			res.set_cell(row, c, c == n_cells - 1 ? T(ge & last_mask) : ge);
+		}
+	}
+
+	/**
+	 * Updates the counts and summaries for the new synapse from input
+	 * @param col to output @param row. Training threads own whole blocks of
+	 * rows, so only the column counts @param col_ones may be thread-local.
+	 */
+	void count_synapse(size_t row, size_t col, uint32_t *col_ones)
+	{
+		if (m_summaries) {
+			m_block_or.set_bit(row / SUMMARY_ROWS, col);
+		}
+		m_row_ones[row]++;
+		col_ones[col]++;
+	}
+
+	/**
+	 * Column counts for a training thread: the counts of the matrix if
+	 * @param shared, otherwise zeroed local counts in @param local, which are
+	 * added to the counts of the matrix by merge_col_ones(). Returns nullptr
+	 * if the counts are not maintained.
+	 */
+	uint32_t *col_ones(bool shared, std::vector<uint32_t> &local)
+	{
+		if (!m_counted) {
+			return nullptr;
+		}
+		if (shared) {
+			return m_col_ones.data();
+		}
+		local.assign(Base::cols(), 0);
+		return local.data();
+	}
+
+	void merge_col_ones(const std::vector<uint32_t> &local, std::mutex &mutex)
+	{
+		if (local.empty()) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t j = 0; j < local.size(); j++) {
+			m_col_ones[j] += local[j];
+		}
+	}
+
+	/**
+	 * Counts the set bits of every row and column of the matrix. The rows
+	 * are split between the threads, every thread sums up the columns of its
+	 * rows in bit-sliced vertical counters, one lane per column, so a cell
+	 * of columns is counted with a few word operations per row.
+	 */
+	void count_ones(std::vector<uint32_t> &row_ones,
+	                std::vector<uint32_t> &col_ones) const
+	{
+		const size_t n_cells = Base::numberOfCells(Base::cols());
+		row_ones.assign(Base::rows(), 0);
+		col_ones.assign(Base::cols(), 0);
+		std::mutex mutex;
+		auto count_rows = [&](size_t begin, size_t end) {
+			std::vector<BitSlicedCounter<T>> counters(n_cells);
+			for (size_t i = begin; i < end; i++) {
+				const T *row = Base::row_ptr(i);
+				row_ones[i] = BitOps::popcount(row, n_cells);
+				for (size_t c = 0; c < n_cells; c++) {
+					counters[c].add(row[c]);
+				}
+			}
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t c = 0; c < n_cells; c++) {
+				const size_t lanes =
+				    std::min<size_t>(Base::intWidth,
+				                     Base::cols() - c * Base::intWidth);
+				for (size_t k = 0; counters[c].planes() && k < lanes; k++) {
+					col_ones[c * Base::intWidth + k] += counters[c].count(k);
+				}
+			}
+		};
+		parallel_for(m_pool.get(), 0, Base::rows(), 1, count_rows);
+	}
+
+	/**
+	 * Alignment of the blocks of output rows trained by one thread: whole
+	 * cells, and whole summary blocks if the summaries are maintained
 	 */
-	BiNAM<T> &train_vec(BinaryVector<T> in, BinaryVector<T> out)
+	size_t train_align() const
 	{
-		for (size_t i = 0; i < out.size(); i++) {
-			if (out.get_bit(i)) {
-				for (size_t j = 0; j < Base::numberOfCells(Base::cols()); j++)
-					Base::set_cell(i, j, Base::get_cell(i, j) | in.get_cell(j));
+		return m_summaries ? std::max<size_t>(Base::intWidth, SUMMARY_ROWS)
+		                   : Base::intWidth;
+	}
+
+	/**
+	 * Builds the block summaries from the current content of the matrix
+	 */
+	void build_summaries()
+	{
+		const size_t n_cells = Base::numberOfCells(Base::cols());
+		m_block_or = BinaryMatrix<T>(
+		    (Base::rows() + SUMMARY_ROWS - 1) / SUMMARY_ROWS, Base::cols());
+		for (size_t i = 0; i < Base::rows(); i++) {
+			T *summary = m_block_or.row_ptr(i / SUMMARY_ROWS);
+			BitOps::bit_or(summary, summary, Base::row_ptr(i), n_cells);
+		}
+	}
+
+	/**
+	 * Row-major recall using the summaries. Blocks of rows whose OR does not
+	 * cover the query (if @param exact) or has less than @param thresh bits
+	 * in common with it are skipped without reading their rows, as are rows
+	 * with fewer set bits than needed. The remaining rows of an exact recall
+	 * are probed starting with the query cells whose bits are set in the
+	 * fewest rows, so most rows are rejected after a single cell.
+	 */
+	void recall_pruned(const ConstRowView<T> &in, bool exact, size_t thresh,
+	                   const RowView<T> &res) const
+	{
+		const size_t n_cells = in.numberOfCells();
+		if (exact) {
+			thresh = BitOps::popcount(in.data(), n_cells);
+		}
+
+		// Query cells ordered by the rarest of their bits, reused per thread
+		static thread_local std::vector<std::pair<uint32_t, uint32_t>> order;
+		order.clear();
+		for (size_t c = 0; exact && c < n_cells; c++) {
+			T cell = in.get_cell(c);
+			uint32_t rarest = std::numeric_limits<uint32_t>::max();
+			while (cell) {
+				rarest = std::min(rarest, m_col_ones[c * Base::intWidth +
+				                                     trailing_zeros<T>(cell)]);
+				cell &= cell - 1;
+			}
+			if (in.get_cell(c)) {
+				order.emplace_back(rarest, c);
+			}
+		}
+		std::sort(order.begin(), order.end());
+
+		res.clear();
+		for (size_t b = 0; b < m_block_or.rows(); b++) {
+			const T *summary = m_block_or.row_ptr(b);
+			if (exact ? !BitOps::is_subset(in.data(), summary, n_cells)
+			          : BitOps::popcount_and(in.data(), summary, n_cells) <
+			                thresh) {
+				continue;
+			}
+			const size_t end = std::min(Base::rows(), (b + 1) * SUMMARY_ROWS);
+			for (size_t i = b * SUMMARY_ROWS; i < end; i++) {
+				if (m_row_ones[i] < thresh) {
+					continue;
+				}
+				const T *row = Base::row_ptr(i);
+				bool match = true;
+				if (exact) {
+					for (const auto &o : order) {
+						if (in.get_cell(o.second) & ~row[o.second]) {
+							match = false;
+							break;
+						}
+					}
+				}
+				else {
+					match = BitOps::popcount_and(row, in.data(), n_cells) >=
+					        thresh;
+				}
+				if (match) {
+					res.set_bit(i);
+				}
+			}
+		}
+	}
+
+	/**
+	 * See the public merge(). If all matrices keep an input-major copy, the
+	 * copies are merged as well, otherwise the copy is rebuilt.
+	 */
+	BiNAM<T> &merge_ptrs(const std::vector<const BiNAM<T> *> &shards)
+	{
+		bool mirrored = m_input_major;
+		for (auto shard : shards) {
+			if (shard->rows() != Base::rows() ||
+			    shard->cols() != Base::cols()) {
+				std::stringstream ss;
+				ss << "Cannot merge matrix of size " << shard->rows() << " x "
+				   << shard->cols() << " into matrix of size " << Base::rows()
+				   << " x " << Base::cols() << std::endl;
+				throw std::out_of_range(ss.str());
+			}
+			mirrored = mirrored && shard->m_input_major;
+		}
+		auto merge_rows = [&](size_t begin, size_t end) {
+			for (auto shard : shards) {
+				Base::or_rows(*shard, begin, end);
+			}
+		};
+		parallel_for(m_pool.get(), 0, Base::rows(), 1, merge_rows);
+		if (mirrored) {
+			auto merge_columns = [&](size_t begin, size_t end) {
+				for (auto shard : shards) {
+					m_columns.or_rows(shard->m_columns, begin, end);
+				}
+			};
+			parallel_for(m_pool.get(), 0, Base::cols(), 1, merge_columns);
+		}
+		else if (m_input_major) {
+			m_columns = build_columns();
+		}
+		if (m_counted) {
+			count_ones(m_row_ones, m_col_ones);
+		}
+		if (m_summaries) {
+			build_summaries();
+		}
+		return *this;
+	}
+
+public:
+	using Base = BinaryMatrix<T>;
+
+	/**
+	 * Number of samples and number of output cells processed at once by
+	 * recallMat()
+	 */
+	static constexpr size_t RECALL_TILE = 64;
+	static constexpr size_t RECALL_CELL_TILE = 64;
+
+	/**
+	 * Number of rows summarised by one row of the block summaries, see
+	 * summaries()
+	 */
+	static constexpr size_t SUMMARY_ROWS = 64;
+
+	/**
+	 * Constructor, @param input_major activates the input-major storage mode
+	 * from the beginning, see input_major()
+	 */
+	BiNAM(){};
+	BiNAM(size_t output, size_t input, bool input_major = false)
+	    : BinaryMatrix<T>(output, input)
+	{
+		this->input_major(input_major);
+	};
+
+	/**
+	 * Constructor from an already trained matrix, e.g. read from a file with
+	 * BinaryMatrix::read().
+	 */
+	explicit BiNAM(const BinaryMatrix<T> &mat, bool input_major = false)
+	    : BinaryMatrix<T>(mat)
+	{
+		this->input_major(input_major);
+	};
+
+	/**
+	 * Constructor taking over the storage of @param mat, e.g. a matrix mapped
+	 * from a file with BinaryMatrix::mapped(). The input-major copy uses the
+	 * same kind of storage.
+	 */
+	explicit BiNAM(BinaryMatrix<T> &&mat, bool input_major = false)
+	    : BinaryMatrix<T>(std::move(mat))
+	{
+		this->input_major(input_major);
+	};
+	BiNAM(const BiNAM<T> &) = default;
+	BiNAM(BiNAM<T> &&) = default;
+	BiNAM<T> &operator=(const BiNAM<T> &) = default;
+	BiNAM<T> &operator=(BiNAM<T> &&) = default;
+	~BiNAM() = default;
+
+	/**
+	 * Activates or deactivates the input-major storage mode. In this mode the
+	 * trained matrix is additionally kept column-major (one row of output bits
+	 * per input neuron), recall() then only touches the columns selected by
+	 * the active input bits instead of testing every output row. When
+	 * activated, the copy is built from the current content of the matrix.
+	 * Note that bits changed via set_bit() or set_cell() afterwards are not
+	 * mirrored, use the training functions instead.
+	 */
+	BiNAM<T> &input_major(bool input_major)
+	{
+		m_input_major = input_major;
+		if (!m_input_major) {
+			m_columns = BinaryMatrix<T>();
+			return *this;
+		}
+		m_columns = build_columns();
+		return *this;
+	}
+
+	/**
+	 * Returns true if the input-major storage mode is active.
+	 */
+	bool input_major() const { return m_input_major; }
+
+	/**
+	 * Activates or deactivates the recall summaries: for every block of
+	 * SUMMARY_ROWS output rows the OR of the rows, together with the number
+	 * of set bits of every row and column (see fill_statistics()). They are
+	 * built from the current content and then maintained by the training
+	 * functions (not by set_bit() or set_cell()). The row-major recall_into()
+	 * uses them to skip blocks and rows which cannot match before reading
+	 * them, so for lightly loaded memories most rows are never read. Needs
+	 * about 1/64 of the matrix.
+	 */
+	BiNAM<T> &summaries(bool active)
+	{
+		m_summaries = active;
+		if (m_summaries) {
+			if (!m_counted) {
+				recount();
+			}
+			build_summaries();
+		}
+		else {
+			m_block_or = BinaryMatrix<T>();
+		}
+		return *this;
+	}
+
+	/**
+	 * Returns true if the recall summaries are active.
+	 */
+	bool summaries() const { return m_summaries; }
+
+	/**
+	 * Number of set synapses per output neuron (row), per input neuron
+	 * (column) and in total. The matrix is counted on every call, unless the
+	 * counts are maintained during training after a call of recount(). Bits
+	 * changed via set_bit() or set_cell() are not counted, call recount()
+	 * afterwards.
+	 */
+	FillStatistics fill_statistics() const
+	{
+		FillStatistics res;
+		if (m_counted) {
+			res.row_ones = m_row_ones;
+			res.col_ones = m_col_ones;
+		}
+		else {
+			count_ones(res.row_ones, res.col_ones);
+		}
+		for (auto n : res.row_ones) {
+			res.synapses += n;
+		}
+		return res;
+	}
+
+	/**
+	 * Counts the synapses of the current content, the counts are maintained
+	 * by the training functions (including merge()) afterwards, so the
+	 * statistics are available at any time without reading the matrix. This
+	 * slows down training, which is why the counts are not maintained by
+	 * default. See fill_statistics().
+	 */
+	BiNAM<T> &recount()
+	{
+		count_ones(m_row_ones, m_col_ones);
+		m_counted = true;
+		return *this;
+	}
+
+	/**
+	 * Number of set synapses and their fraction of the matrix, see
+	 * fill_statistics()
+	 */
+	size_t synapses() const
+	{
+		if (!m_counted) {
+			return fill_statistics().synapses;
+		}
+		size_t res = 0;
+		for (auto n : m_row_ones) {
+			res += n;
+		}
+		return res;
+	}
+	double fill() const
+	{
+		return Base::size() ? double(synapses()) / Base::size() : 0.0;
+	}
+
+	/**
+	 * Sets the thread pool used by train_mat(), the matrix recall functions
+	 * and false_bits_thresholds(). Training is split into blocks of output
+	 * neurons aligned to whole cells, so no two threads write the same cell,
+	 * recall is split into blocks of samples. Passing nullptr runs everything
+	 * in the calling thread.
+	 */
+	BiNAM<T> &pool(std::shared_ptr<ThreadPool> pool)
+	{
+		m_pool = std::move(pool);
+		return *this;
+	}
+
+	/**
+	 * Returns the thread pool, may be nullptr.
+	 */
+	const std::shared_ptr<ThreadPool> &pool() const { return m_pool; }
+
+	/**
+	 * Training of a sample pair with checking of dimensions
+	 */
+	BiNAM<T> &train_vec_check(const BinaryVector<T> &in,
+	                          const BinaryVector<T> &out)
+	{
+		return train_vec_check(in.row(0), out.row(0));
+	}
+
+	/**
+	 * Training of a sample pair given as views, e.g. rows of the sample
+	 * matrices, with checking of dimensions
+	 */
+	BiNAM<T> &train_vec_check(const ConstRowView<T> &in,
+	                          const ConstRowView<T> &out)
+	{
+		if (in.size() != Base::cols() || out.size() != Base::rows()) {
+			std::stringstream ss;
+			ss << "[" << in.size() << ", " << out.size()
+			   << "] out of range for matrix of size " << Base::cols() << " x "
+			   << Base::rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		return train_vec(in, out);
+	}
+
+	/**
+	 * Training of a sample pair given as lists of active input and output
+	 * neurons, with checking of the indices
+	 */
+	BiNAM<T> &train_idx(const std::vector<uint32_t> &in,
+	                    const std::vector<uint32_t> &out)
+	{
+		for (auto idx : in) {
+			if (idx >= Base::cols()) {
+				throw std::out_of_range("Input index " + std::to_string(idx) +
+				                        " out of range for matrix with " +
+				                        std::to_string(Base::cols()) +
+				                        " columns");
+			}
+		}
+		for (auto idx : out) {
+			if (idx >= Base::rows()) {
+				throw std::out_of_range("Output index " + std::to_string(idx) +
+				                        " out of range for matrix with " +
+				                        std::to_string(Base::rows()) + " rows");
+			}
+		}
+		return train_idx(in.data(), in.size(), out.data(), out.size(),
+		                 m_col_ones.data());
+	}
+
+	/**
+	 * Training of whole matrices, should be favoured for using. The active
+	 * bits of every sample are extracted into reused buffers, so training
+	 * does not allocate per sample. With a thread pool every thread trains a
+	 * block of output neurons and skips the samples without active outputs in
+	 * its block.
+	 */
+	BiNAM<T> &train_mat(const BinaryMatrix<T> &in, const BinaryMatrix<T> &out)
+	{
+		return train_mat(in, out, 0, in.rows());
+	}
+
+	/**
+	 * Training with the samples [@param first, @param last) of the given
+	 * matrices only, e.g. to train one shard of a sample set.
+	 */
+	BiNAM<T> &train_mat(const BinaryMatrix<T> &in, const BinaryMatrix<T> &out,
+	                    size_t first, size_t last)
+	{
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() != out.rows() || first > last || last > in.rows()) {
+			std::stringstream ss;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << Base::size()
+			   << " or invalid sample range [" << first << ", " << last << ")"
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		const bool shared = !m_pool || m_pool->threads() == 1;
+		std::mutex mutex;
+		auto train_outputs = [&](size_t begin, size_t end) {
+			std::vector<uint32_t> idx_in, idx_out, local;
+			uint32_t *cols = col_ones(shared, local);
+			idx_in.reserve(Base::cols());
+			idx_out.reserve(end - begin);
+			Base::advise_rows(begin, end, AlignedMemory::Advice::WILLNEED);
+			for (size_t i = first; i < last; i++) {
+				out.active_bits(i, begin, end, idx_out);
+				if (idx_out.empty()) {
+					continue;
+				}
+				in.active_bits(i, idx_in);
+				train_idx(idx_in.data(), idx_in.size(), idx_out.data(),
+				          idx_out.size(), cols);
+			}
+			merge_col_ones(local, mutex);
+		};
+		parallel_for(m_pool.get(), 0, Base::rows(), train_align(),
+		             train_outputs);
+		return *this;
+	}
+
+	/**
+	 * Training with sparse patterns, see train_mat(). The stored indices are
+	 * used directly, so nothing is extracted per sample.
+	 */
+	BiNAM<T> &train_mat(const SparsePatternMatrix &in,
+	                    const SparsePatternMatrix &out)
+	{
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() != out.rows()) {
+			std::stringstream ss;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << Base::size()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		const bool shared = !m_pool || m_pool->threads() == 1;
+		std::mutex mutex;
+		auto train_outputs = [&](size_t begin, size_t end) {
+			std::vector<uint32_t> local;
+			uint32_t *cols = col_ones(shared, local);
+			for (size_t i = 0; i < in.rows(); i++) {
+				const uint32_t *o0 =
+				    std::lower_bound(out.row_begin(i), out.row_end(i), begin);
+				const uint32_t *o1 = std::lower_bound(o0, out.row_end(i), end);
+				if (o0 != o1) {
+					train_idx(in.row_ptr(i), in.ones(), o0, o1 - o0, cols);
+				}
+			}
+			merge_col_ones(local, mutex);
+		};
+		parallel_for(m_pool.get(), 0, Base::rows(), train_align(),
+		             train_outputs);
+		return *this;
+	}
+
+	/**
+	 * Training with the pattern files @param in and @param out, which must
+	 * have the same number of patterns per block. The files are decoded and
+	 * trained block by block, so they never have to fit into memory. Files
+	 * with a fixed number of ones per pattern are trained as sparse patterns.
+	 */
+	BiNAM<T> &train_stream(const PatternFileReader &in,
+	                       const PatternFileReader &out)
+	{
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() != out.rows() || in.block_rows() != out.block_rows()) {
+			std::stringstream ss;
+			ss << in.rows() << " x " << in.cols() << " and " << out.rows()
+			   << " x " << out.cols() << " patterns in blocks of "
+			   << in.block_rows() << " and " << out.block_rows()
+			   << " out of range for matrix of size " << Base::size()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		const bool sparse = in.ones() > 0 && out.ones() > 0;
+		for (size_t b = 0; b < in.blocks(); b++) {
+			if (sparse) {
+				train_mat(in.sparse_block(b), out.sparse_block(b));
+			}
+			else {
+				train_mat(in.template dense_block<T>(b),
+				          out.template dense_block<T>(b));
+			}
+		}
+		return *this;
+	}
+
+	/**
+	 * Sample-sharded training: the samples are split into @param shards
+	 * contiguous shards (default: one per thread of the pool), each shard is
+	 * trained into a separate matrix and these are merged afterwards. Gives
+	 * the same result as train_mat(), as training only ever sets bits.
+	 */
+	BiNAM<T> &train_mat_sharded(const BinaryMatrix<T> &in,
+	                            const BinaryMatrix<T> &out, size_t shards = 0)
+	{
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() != out.rows()) {
+			std::stringstream ss;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << Base::size()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		if (shards == 0) {
+			shards = m_pool ? m_pool->threads() : 1;
+		}
+		std::vector<BiNAM<T>> parts(shards);
+		auto train_shards = [&](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				parts[k] = BiNAM<T>(Base::rows(), Base::cols());
+				parts[k].train_mat(in, out, k * in.rows() / shards,
+				                   (k + 1) * in.rows() / shards);
+			}
+		};
+		parallel_for(m_pool.get(), 0, shards, 1, train_shards);
+		return merge(parts);
+	}
+
+	/**
+	 * Merges the synapses of @param shards, e.g. matrices trained with
+	 * disjoint parts of the samples, into this matrix by a bit-wise OR. The
+	 * rows are distributed onto the thread pool.
+	 */
+	BiNAM<T> &merge(const std::vector<BiNAM<T>> &shards)
+	{
+		std::vector<const BiNAM<T> *> ptrs;
+		for (auto &shard : shards) {
+			ptrs.push_back(&shard);
+		}
+		return merge_ptrs(ptrs);
+	}
+
+	BiNAM<T> &merge(const BiNAM<T> &other)
+	{
+		return merge_ptrs(std::vector<const BiNAM<T> *>{&other});
+	}
+
+	/**
+	 * Sum of all set bits of a BinaryVector. Used for recall
+	 */
+	size_t digit_sum(const BinaryVector<T> &vec)
+	{
+		return BitOps::popcount(vec.row_ptr(0), Base::numberOfCells(vec.size()));
+	}
+
+	/*
+	 * Recall procedure for a single sample
+	 * @param thresh is the threshold
+	 */
+	BinaryVector<T> recall(const BinaryVector<T> &in) const
+	{
+		BinaryVector<T> vec(Base::rows());
+		recall_into(in.row(0), vec.row(0));
+		return vec;
+	};
+
+	/**
+	 * Recall of the sample @param in into the caller-provided row
+	 * @param res, which must have one bit per output neuron. Together with
+	 * views onto the rows of a sample matrix, this recalls without any
+	 * allocation.
+	 */
+	void recall_into(const ConstRowView<T> &in, const RowView<T> &res) const
+	{
+		check_recall(in, res);
+		if (m_input_major) {
+			recall_columns(m_columns, in, true, 0, res);
+			return;
+		}
+		if (m_summaries) {
+			recall_pruned(in, true, 0, res);
+			return;
+		}
+		res.clear();
+		for (size_t i = 0; i < Base::rows(); i++) {
+			if (BitOps::is_subset(in.data(), Base::row_ptr(i),
+			                      in.numberOfCells())) {
+				res.set_bit(i);
 			}
 		}
-		return *this;
 	}
 
-public:
-	using Base = BinaryMatrix<T>;
-	/**
-	 * Constructor - nothing to do here
+	/*
+	 * Recall procedure for a single sample with threshold @param thresh: an
+	 * output neuron fires if at least thresh of its synapses from active input
+	 * neurons are set. No temporary vectors are created. In the input-major
+	 * mode the columns selected by the input are summed up in bit-sliced
+	 * vertical counters and compared against the threshold for a whole cell
+	 * of output neurons at once, otherwise the dendritic sum of every output
+	 * row is the population count of the row masked by the input.
 	 */
-	BiNAM(){};
-	BiNAM(size_t output, size_t input) : BinaryMatrix<T>(output, input){};
-	~BiNAM() = default;
+	BinaryVector<T> recall(const BinaryVector<T> &in, size_t thresh) const
+	{
+		BinaryVector<T> vec(Base::rows());
+		recall_into(in.row(0), thresh, vec.row(0));
+		return vec;
+	};
 
 	/**
-	 * Training of a sample pair with checking of dimensions
+	 * Threshold recall into a caller-provided row, see recall_into()
 	 */
-	BiNAM<T> &train_vec_check(BinaryVector<T> &in, BinaryVector<T> &out)
+	void recall_into(const ConstRowView<T> &in, size_t thresh,
+	                 const RowView<T> &vec) const
 	{
-		if (in.size() != Base::cols() || out.size() != Base::rows()) {
+		check_recall(in, vec);
+		const size_t n_cells_in = in.numberOfCells();
+		if (m_input_major) {
+			recall_columns(m_columns, in, false, thresh, vec);
+			return;
+		}
+		if (m_summaries) {
+			recall_pruned(in, false, thresh, vec);
+			return;
+		}
+		vec.clear();
+		for (size_t i = 0; i < Base::rows(); i++) {
+			if (BitOps::popcount_and(Base::row_ptr(i), in.data(),
+			                         n_cells_in) >= thresh) {
+				vec.set_bit(i);
+			}
+		}
+	}
+
+	/*
+	 * Recall procedure for a matrix of samples, @param thresh is the threshold.
+	 * The samples are recalled in tiles of RECALL_TILE queries against the
+	 * input-major matrix, which is built once per call if the input-major
+	 * mode is not active. Only the columns selected by the queries are read.
+	 */
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in) const
+	{
+		if (in.cols() != Base::cols()) {
 			std::stringstream ss;
-			ss << "[" << in.size() << ", " << out.size()
-			   << "] out of range for matrix of size " << Base::cols() << " x "
-			   << Base::rows() << std::endl;
+			ss << in.size() << " out of range for matrix of size "
+			   << Base::cols() << std::endl;
 			throw std::out_of_range(ss.str());
 		}
-		return train_vec(in, out);
+		if (!m_input_major) {
+			return recall_batched(build_columns(), in, true, 0);
+		}
+		return recall_batched(m_columns, in, true, 0);
 	}
 
-	/**
-	 * Training of whole matrices, should be favoured for using
-	 */
-	BiNAM<T> &train_mat(const BinaryMatrix<T> &in, const BinaryMatrix<T> &out)
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in, size_t thresh) const
 	{
-		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
-		    in.rows() != out.rows()) {
+		if (in.cols() != Base::cols()) {
 			std::stringstream ss;
-			ss << in.size() << " and " << out.size()
-			   << " out of range for matrix of size " << Base::size()
-			   << std::endl;
+			ss << in.size() << " out of range for matrix of size "
+			   << Base::cols() << std::endl;
 			throw std::out_of_range(ss.str());
 		}
-		for (size_t i = 0; i < in.rows(); i++) {
-			train_vec(in.row_vec(i), out.row_vec(i));
+		if (!m_input_major) {
+			return recall_batched(build_columns(), in, false, thresh);
 		}
-		return *this;
+		return recall_batched(m_columns, in, false, thresh);
 	}
 
 	/**
-	 * Sum of all set bits of a BinaryVector. Used for recall
+	 * Reverse recall of the input pattern belonging to the output pattern
+	 * @param out, i.e. a recall with the transposed matrix: an input neuron
+	 * fires if its synapses to all active output neurons are set. This needs
+	 * no second matrix trained in the other direction, as the trained matrix
+	 * itself is the input-major copy of its transpose: the result is the AND
+	 * of the rows of the active output neurons.
 	 */
-	size_t digit_sum(const BinaryVector<T> &vec)
+	BinaryVector<T> recall_reverse(const BinaryVector<T> &out) const
 	{
-		size_t sum = 0;
-		for (size_t i = 0; i < Base::numberOfCells(vec.size()); i++) {
-			sum += population_count<T>(vec.get_cell(i));
-		};
-		return sum;
+		BinaryVector<T> vec(Base::cols());
+		recall_reverse_into(out.row(0), vec.row(0));
+		return vec;
 	}
 
-	/*
-	 * Recall procedure for a single sample
-	 * @param thresh is the threshold
+	/**
+	 * Reverse recall with threshold @param thresh, see recall(in, thresh)
 	 */
-	BinaryVector<T> recall(const BinaryVector<T> &in)
+	BinaryVector<T> recall_reverse(const BinaryVector<T> &out,
+	                               size_t thresh) const
 	{
-		BinaryVector<T> vec(Base::rows());
-		for (size_t i = 0; i < Base::rows(); i++) {
-			bool iden = true;
-			for (size_t j = 0; j < in.numberOfCells(in.size()); j++) {
-				uint64_t v = in.get_cell(j);
-				uint64_t w = Base::get_cell(i, j);
-				if ((v & w) != v) {
-					iden = false;
-					break;
-				}
-			}
-			if (iden) {
-				vec.set_bit(i);
-			}
-		}
+		BinaryVector<T> vec(Base::cols());
+		recall_reverse_into(out.row(0), thresh, vec.row(0));
 		return vec;
-	};
-	BinaryVector<T> recall(const BinaryVector<T> &in, size_t thresh)
+	}
+
+	/**
+	 * Reverse recall into a caller-provided row with one bit per input
+	 * neuron, see recall_into()
+	 */
+	void recall_reverse_into(const ConstRowView<T> &out,
+	                         const RowView<T> &res) const
 	{
-		BinaryVector<T> vec(Base::rows());
-		BinaryVector<T> temp = in;
-		// size_t thresh = digit_sum(in);
+		check_reverse(out, res);
+		recall_columns(*this, out, true, 0, res);
+	}
+
+	void recall_reverse_into(const ConstRowView<T> &out, size_t thresh,
+	                         const RowView<T> &res) const
+	{
+		check_reverse(out, res);
+		recall_columns(*this, out, false, thresh, res);
+	}
+
+	/**
+	 * Reverse recall of a matrix of output patterns, batched like
+	 * recallMat()
+	 */
+	BinaryMatrix<T> recallMat_reverse(const BinaryMatrix<T> &out) const
+	{
+		if (out.cols() != Base::rows()) {
+			std::stringstream ss;
+			ss << out.size() << " out of range for reverse recall with "
+			   << "matrix of size " << Base::rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		return recall_batched(*this, out, true, 0);
+	}
+
+	BinaryMatrix<T> recallMat_reverse(const BinaryMatrix<T> &out,
+	                                  size_t thresh) const
+	{
+		if (out.cols() != Base::rows()) {
+			std::stringstream ss;
+			ss << out.size() << " out of range for reverse recall with "
+			   << "matrix of size " << Base::rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		return recall_batched(*this, out, false, thresh);
+	}
+
+	/**
+	 * k-winners-take-all recall of a single sample: the @param k output
+	 * neurons with the highest dendritic sums fire. In contrast to recall()
+	 * this yields a sensible result for noisy or incomplete inputs, for which
+	 * no fixed threshold fits. See recall_kwta_row() for the handling of ties.
+	 */
+	BinaryVector<T> recall_kwta(const BinaryVector<T> &in, size_t k) const
+	{
+		if (in.size() != Base::cols()) {
+			std::stringstream ss;
+			ss << in.size() << " out of range for matrix of size "
+			   << Base::cols() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		if (m_input_major) {
+			BinaryMatrix<T> res(1, Base::rows());
+			std::vector<uint32_t> idx;
+			std::vector<BitSlicedCounter<T>> counters(
+			    Base::numberOfCells(Base::rows()));
+			in.active_bits(0, idx);
+			recall_kwta_row(m_columns, idx, k, counters, res, 0);
+			return res.row_vec(0);
+		}
+
+		// Dendritic sums of all output rows and their histogram
+		const size_t n_cells_in = Base::numberOfCells(in.size());
+		std::vector<uint32_t> sums(Base::rows());
+		std::vector<size_t> hist(in.size() + 1, 0);
 		for (size_t i = 0; i < Base::rows(); i++) {
-			size_t sum = digit_sum(temp.VectorMult(Base::row_vec(i)));
-			if (sum >= thresh) {
+			sums[i] = BitOps::popcount_and(Base::row_ptr(i), in.row_ptr(0),
+			                               n_cells_in);
+			hist[sums[i]]++;
+		}
+		size_t thresh = in.size(), n = hist[thresh];
+		while (thresh > 1 && n < k) {
+			n += hist[--thresh];
+		}
+		BinaryVector<T> vec(Base::rows());
+		for (size_t i = 0; i < Base::rows() && k > 0; i++) {
+			if (sums[i] >= thresh && sums[i] > 0) {
 				vec.set_bit(i);
 			}
 		}
 		return vec;
-	};
+	}
 
-	/*
-	 * Recall procedure for a matrix of samples, @param thresh is the threshold
+	/**
+	 * k-winners-take-all recall of a matrix of samples, see recall_kwta().
+	 * The dendritic sums are computed on the input-major matrix for a whole
+	 * cell of output neurons at once.
 	 */
-	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in)
+	BinaryMatrix<T> recallMat_kwta(const BinaryMatrix<T> &in, size_t k) const
 	{
 		if (in.cols() != Base::cols()) {
 			std::stringstream ss;
@@ -161,25 +1303,171 @@ public:
 			   << Base::cols() << std::endl;
 			throw std::out_of_range(ss.str());
 		}
-		BinaryMatrix<T> res(in.rows(), Base::rows());
-		for (size_t i = 0; i < res.rows(); i++) {
-			res.write_vec(i, recall(in.row_vec(i)));
+		BinaryMatrix<T> res(in.rows(), Base::rows()), tmp;
+		if (!m_input_major) {
+			tmp = build_columns();
+		}
+		const BinaryMatrix<T> &cols = m_input_major ? m_columns : tmp;
+		auto recall_samples = [&](size_t begin, size_t end) {
+			std::vector<uint32_t> idx;
+			std::vector<BitSlicedCounter<T>> counters(
+			    Base::numberOfCells(Base::rows()));
+			for (size_t i = begin; i < end; i++) {
+				in.active_bits(i, idx);
+				recall_kwta_row(cols, idx, k, counters, res, i);
+			}
 		};
+		parallel_for(m_pool.get(), 0, in.rows(), 1, recall_samples);
 		return res;
 	}
 
-	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in, size_t thresh)
+	/**
+	 * Fused recall and evaluation: recalls the samples of @param in tile by
+	 * tile and compares every tile directly with the expected output
+	 * @param out. Only the number of false positives and negatives and the
+	 * information of @param params are accumulated, so no recall matrix of
+	 * size samples x output neurons is built. @param kwta selects the
+	 * k-winners-take-all recall instead of the exact one (if non-zero). If
+	 * @param errs is given, it receives the errors of every sample, as
+	 * false_bits_mat() would return them.
+	 */
+	ExpResults recall_analysis(const BinaryMatrix<T> &in,
+	                           const BinaryMatrix<T> &out,
+	                           const DataParameters &params,
+	                           std::vector<SampleError> *errs = nullptr,
+	                           size_t kwta = 0) const
 	{
-		if (in.cols() != Base::cols()) {
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() > out.rows()) {
 			std::stringstream ss;
-			ss << in.size() << " out of range for matrix of size "
-			   << Base::cols() << std::endl;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << Base::size()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		if (errs) {
+			errs->assign(in.rows(), SampleError());
+		}
+		BinaryMatrix<T> tmp;
+		if (!m_input_major) {
+			tmp = build_columns();
+		}
+		const BinaryMatrix<T> &cols = m_input_major ? m_columns : tmp;
+		const size_t n_cells = Base::numberOfCells(Base::rows());
+
+		// Partial results per tile, summed up in a fixed order below so the
+		// result does not depend on the number of threads
+		const size_t n_tiles = (in.rows() + RECALL_TILE - 1) / RECALL_TILE;
+		std::vector<SampleError> tile_errs(n_tiles);
+		std::vector<double> tile_info(n_tiles, 0.0);
+		auto evaluate_tiles = [&](size_t begin, size_t end) {
+			BinaryMatrix<T> tile(RECALL_TILE, Base::rows());
+			std::vector<uint32_t> idx;
+			std::vector<size_t> offs;
+			std::vector<BitSlicedCounter<T>> counters(kwta ? n_cells : 0);
+			for (size_t t = begin; t < end; t++) {
+				const size_t q0 = t * RECALL_TILE;
+				const size_t q1 = std::min<size_t>(in.rows(), q0 + RECALL_TILE);
+				if (kwta) {
+					for (size_t q = q0; q < q1; q++) {
+						in.active_bits(q, idx);
+						recall_kwta_row(cols, idx, kwta, counters, tile,
+						                q - q0);
+					}
+				}
+				else {
+					recall_tile(cols, in, q0, q1, true, 0, tile, idx, offs,
+					            -ptrdiff_t(q0));
+				}
+				for (size_t q = q0; q < q1; q++) {
+					SampleError se = false_bits(out.row(q), tile.row(q - q0));
+					tile_errs[t].fp += se.fp;
+					tile_errs[t].fn += se.fn;
+					tile_info[t] += entropy_hetero_sample(params, se);
+					if (errs) {
+						(*errs)[q] = se;
+					}
+				}
+			}
+		};
+		parallel_for(m_pool.get(), 0, n_tiles, 1, evaluate_tiles);
+
+		double info = 0.0;
+		SampleError sum(0, 0);
+		for (size_t t = 0; t < n_tiles; t++) {
+			info += tile_info[t];
+			sum.fp += tile_errs[t].fp;
+			sum.fn += tile_errs[t].fn;
+		}
+		return ExpResults(info, sum);
+	}
+
+	/**
+	 * Recalls all samples of @param in with every threshold in the range
+	 * [thresh_min, thresh_max] and compares the results with the expected
+	 * output @param out. The dendritic sums are computed only once per sample
+	 * in bit-sliced vertical counters, which are then compared against all
+	 * thresholds, so the whole range costs about as much as a single threshold
+	 * recall. Returns for every threshold thresh_min + k at index k the vector
+	 * of SampleError, as false_bits_mat() would for recallMat(in, thresh).
+	 */
+	std::vector<std::vector<SampleError>> false_bits_thresholds(
+	    const BinaryMatrix<T> &in, const BinaryMatrix<T> &out,
+	    size_t thresh_min, size_t thresh_max) const
+	{
+		if (in.cols() != Base::cols() || out.cols() != Base::rows() ||
+		    in.rows() > out.rows() || thresh_min > thresh_max) {
+			std::stringstream ss;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << Base::size()
+			   << " or invalid threshold range [" << thresh_min << ", "
+			   << thresh_max << "]" << std::endl;
 			throw std::out_of_range(ss.str());
 		}
-		BinaryMatrix<T> res(in.rows(), Base::rows());
-		for (size_t i = 0; i < res.rows(); i++) {
-			res.write_vec(i, recall(in.row_vec(i), thresh));
+		const size_t n_thresh = thresh_max - thresh_min + 1;
+		std::vector<std::vector<SampleError>> res(
+		    n_thresh, std::vector<SampleError>(in.rows()));
+
+		BinaryMatrix<T> tmp;
+		if (!m_input_major) {
+			tmp = build_columns();
+		}
+		const BinaryMatrix<T> &cols = m_input_major ? m_columns : tmp;
+		const size_t n_cells = Base::numberOfCells(Base::rows());
+		const T last_mask =
+		    Base::rows() % Base::intWidth
+		        ? T((T(1) << (Base::rows() % Base::intWidth)) - 1)
+		        : Base::intMax;
+
+		auto evaluate_samples = [&](size_t begin, size_t end) {
+			std::vector<uint32_t> idx;
+			std::vector<size_t> fp(n_thresh), tp(n_thresh);
+			BitSlicedCounter<T> counter;
+			for (size_t q = begin; q < end; q++) {
+				in.active_bits(q, idx);
+				std::fill(fp.begin(), fp.end(), 0);
+				std::fill(tp.begin(), tp.end(), 0);
+				const size_t ones = BitOps::popcount(out.row_ptr(q), n_cells);
+				for (size_t c = 0; c < n_cells; c++) {
+					counter.reset();
+					for (auto j : idx) {
+						counter.add(cols.get_cell(j, c));
+					}
+					const T mask = c == n_cells - 1 ? last_mask : Base::intMax;
+					const T o = out.get_cell(q, c);
+					for (size_t k = 0; k < n_thresh; k++) {
+						const T ge =
+						    counter.greater_equal(thresh_min + k) & mask;
+						fp[k] += population_count<T>(T(ge & ~o));
+						tp[k] += population_count<T>(T(ge & o));
+					}
+				}
+				for (size_t k = 0; k < n_thresh; k++) {
+					res[k][q] = SampleError(fp[k], ones - tp[k]);
+				}
+			}
 		};
+		parallel_for(m_pool.get(), 0, in.rows(), 1, evaluate_samples);
 		return res;
 	}
 
@@ -191,28 +1479,76 @@ public:
 	static SampleError false_bits(const BinaryVector<T> &out,
 	                              const BinaryVector<T> &recall)
 	{
-		SampleError error;
-		for (size_t i = 0; i < Base::numberOfCells(out.size()); i++) {
-			T temp = out.get_cell(i) ^ recall.get_cell(i);
-			error.fp += population_count<T>(temp & recall.get_cell(i));
-			error.fn += population_count<T>(temp & out.get_cell(i));
+		return false_bits(out.row(0), recall.row(0));
+	}
+
+	static SampleError false_bits(const ConstRowView<T> &out,
+	                              const ConstRowView<T> &recall)
+	{
+		const size_t n = out.numberOfCells();
+		return SampleError(
+		    BitOps::popcount_andnot(recall.data(), out.data(), n),
+		    BitOps::popcount_andnot(out.data(), recall.data(), n));
+	}
+
+	/**
+	 * Calculation of false positives and negatives for sample @param row of
+	 * the sparse output patterns @param out, costs O(ones) plus a population
+	 * count of @param recall
+	 */
+	static SampleError false_bits(const SparsePatternMatrix &out, size_t row,
+	                              const ConstRowView<T> &recall)
+	{
+		size_t tp = 0;
+		for (const uint32_t *p = out.row_begin(row); p != out.row_end(row);
+		     p++) {
+			tp += recall.get_bit(*p);
 		}
-		return error;
+		const size_t ones =
+		    BitOps::popcount(recall.data(), recall.numberOfCells());
+		return SampleError(ones - tp, out.ones() - tp);
 	}
 
 	/**
 	 * Calculation of false positives and negative for the matrix
 	 * @param out is the original sample matrix
 	 * @param recall the one with errors (the recalled one)
+	 * @param pool optional thread pool the samples are distributed onto
 	 */
 	static std::vector<SampleError> false_bits_mat(const BinaryMatrix<T> &out,
 	                                               const BinaryMatrix<T> &res,
-	                                               size_t n_samples_max = 0.0)
+	                                               size_t n_samples_max = 0.0,
+	                                               ThreadPool *pool = nullptr)
+	{
+		return false_bits_samples(
+		    out.rows(), res, n_samples_max, pool,
+		    [&](size_t i) { return false_bits(out.row(i), res.row(i)); });
+	}
+
+	static std::vector<SampleError> false_bits_mat(
+	    const SparsePatternMatrix &out, const BinaryMatrix<T> &res,
+	    size_t n_samples_max = 0, ThreadPool *pool = nullptr)
+	{
+		return false_bits_samples(
+		    out.rows(), res, n_samples_max, pool,
+		    [&](size_t i) { return false_bits(out, i, res.row(i)); });
+	}
+
+private:
+	/**
+	 * Evaluates @param false_bits_sample(i) for the first @param
+	 * n_samples_max samples of @param res (all if zero), checks the sizes
+	 * for false_bits_mat()
+	 */
+	template <typename F>
+	static std::vector<SampleError> false_bits_samples(
+	    size_t out_rows, const BinaryMatrix<T> &res, size_t n_samples_max,
+	    ThreadPool *pool, F false_bits_sample)
 	{
-		if (res.rows() > out.rows()) {
+		if (res.rows() > out_rows) {
 			std::stringstream ss;
 			ss << res.rows() << " out of range for output matrix of size "
-			   << out.rows() << std::endl;
+			   << out_rows << std::endl;
 			throw std::out_of_range(ss.str());
 		}
 		if (n_samples_max == 0) {
@@ -225,13 +1561,28 @@ public:
 			    " is too large! Max: " + std::to_string(res.rows()));
 		}
 		std::vector<SampleError> error(n_samples_max);
-		for (size_t i = 0; i < n_samples_max; i++) {
-			error[i] = false_bits(out.row_vec(i), res.row_vec(i));
-		}
+		auto evaluate_samples = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				error[i] = false_bits_sample(i);
+			}
+		};
+		parallel_for(pool, 0, n_samples_max, 1, evaluate_samples);
 		return error;
 	}
 };
 
+/**
+ * Expressions for the linker
+ */
+template <typename T>
+constexpr size_t BiNAM<T>::RECALL_TILE;
+
+template <typename T>
+constexpr size_t BiNAM<T>::RECALL_CELL_TILE;
+
+template <typename T>
+constexpr size_t BiNAM<T>::SUMMARY_ROWS;
+
 /**
  * The BiNAM_Container is the general class to evaluate BiNAMs and the easy to
  * use interface.
@@ -248,6 +1599,50 @@ public:
 	BinaryMatrix<T> m_input, m_output, m_recall;
 	std::vector<SampleError> m_SampleError;
 
+	/**
+	 * If non-zero, recall() uses k-winners-take-all with this k instead of the
+	 * exact recall.
+	 */
+	size_t m_kwta = 0;
+
+	/**
+	 * If set, set_up() and recall() use a FixedBiNAM for the geometries
+	 * listed in FixedBiNAMSizes.
+	 */
+	bool m_fixed = true;
+
+	/**
+	 * FixedBiNAM holding the same synapses as m_BiNAM, trained by set_up() or
+	 * copied from m_BiNAM by the first recall(). Null if not available.
+	 */
+	std::shared_ptr<AnyFixedBiNAM<T>> m_fixed_binam;
+
+	/**
+	 * Set once the storage matrix may hold synapses
+	 */
+	bool m_trained = false;
+
+	/**
+	 * Trains the storage matrix with the samples. For a fixed geometry the
+	 * FixedBiNAM is trained and its synapses are OR-ed into m_BiNAM, which
+	 * is much cheaper than training m_BiNAM for the small networks concerned.
+	 */
+	void train()
+	{
+		if (m_fixed && !m_fixed_binam) {
+			m_fixed_binam = make_fixed_binam<T>(
+			    m_BiNAM.rows(), m_BiNAM.cols(), m_trained ? &m_BiNAM : nullptr);
+		}
+		m_trained = true;
+		if (!m_fixed || !m_fixed_binam) {
+			m_fixed_binam = nullptr;
+			m_BiNAM.train_mat(m_input, m_output);
+			return;
+		}
+		m_fixed_binam->train_mat(m_input, m_output);
+		m_BiNAM.merge(BiNAM<T>(m_fixed_binam->toBinaryMatrix()));
+	}
+
 public:
 	/**
 	 * Constructor of the Container. Sets all parameters needed for ongoing
@@ -260,19 +1655,61 @@ public:
 	 * @param random: flag which (de)activates the randomization of data
 	 * @param balanced: activates the algorithm for balanced data generation
 	 * @param unique: Suppresses the multiple generation of the same pattern
+	 * The number of threads used for training, recall and analysis is taken
+	 * from @param datagen, see ThreadPool::default_threads() for the default.
 	 */
 	BiNAM_Container(DataParameters params, DataGenerationParameters datagen)
 	    : m_BiNAM(params.bits_out(), params.bits_in()),
 	      m_params(params),
-	      m_datagen(datagen){};
+	      m_datagen(datagen)
+	{
+		m_BiNAM.pool(ThreadPool::shared(m_datagen.threads()));
+	};
 	BiNAM_Container(DataParameters params)
 	    : m_BiNAM(params.bits_out(), params.bits_in()),
 	      m_params(params),
-	      m_datagen(){};
+	      m_datagen()
+	{
+		m_BiNAM.pool(ThreadPool::shared(m_datagen.threads()));
+	};
 	BiNAM_Container() = default;
 
 	~BiNAM_Container() = default;
 
+	/**
+	 * Switches the storage matrix to the input-major mode, which speeds up
+	 * the recall of sparse input patterns. See BiNAM::input_major().
+	 */
+	BiNAM_Container<T> &input_major(bool input_major = true)
+	{
+		m_BiNAM.input_major(input_major);
+		return *this;
+	};
+
+	/**
+	 * Switches recall() to k-winners-take-all: for every sample the @param k
+	 * output neurons with the highest dendritic sums fire, usually k is
+	 * ones_out. A value of zero switches back to the exact recall.
+	 */
+	BiNAM_Container<T> &kwta(size_t k)
+	{
+		m_kwta = k;
+		return *this;
+	};
+
+	/**
+	 * Enables or disables the FixedBiNAM used by set_up() and recall() for
+	 * small networks of a precompiled geometry, see dispatch_fixed_binam().
+	 * The FixedBiNAM trained by set_up() is kept for the recall, the trained
+	 * matrix is available as usual. Enabled by default, the results are the
+	 * same.
+	 */
+	BiNAM_Container<T> &fixed(bool fixed)
+	{
+		m_fixed = fixed;
+		return *this;
+	};
+
 	/**
 	 * Generates input and output data, trains the storage matrix
 	 */
@@ -298,57 +1735,41 @@ public:
 		input_thread.join();
 		output_thread.join();
 
-		m_BiNAM.train_mat(m_input, m_output);
+		train();
 		return *this;
 	};
 
+	/**
+	 * Reads the samples from the files given in the data generation
+	 * parameters instead of generating them, see MatrixFile::read(). Dense
+	 * files are mapped, sparse pattern files (see PatternFileWriter) are
+	 * decoded and older raw files are read.
+	 */
 	BiNAM_Container<T> &set_up_from_file()
 	{
 		std::cout << "Read in data-file..." << std::endl;
-		size_t height = 0;
-		size_t width = 0;
-		std::fstream ss("../data/data_in", std::fstream::in);
-		if (!ss.good()) {
-			throw;
-		}
-		ss.read((char *)&width, sizeof(width));
-		ss.read((char *)&height, sizeof(height));
-		m_input = BinaryMatrix<T>(height, width);
-		ss.read((char *)m_input.cells().data(),
-		        m_input.cells().size() * sizeof(T));
-		ss.close();
-		if (m_input.cols() != m_params.bits_in() ||
-		    m_input.rows() != m_params.samples()) {
-			std::stringstream s;
-			s << "Input data size " << m_input.cols() << " and "
-			  << m_input.rows() << " differs from given Parameters "
-			  << m_params.bits_in() << " and " << m_params.samples() << " !"
-			  << std::endl;
-			throw std::out_of_range(s.str());
-		}
+		m_input = read_data(m_datagen.file_in(), m_params.bits_in());
+		m_output = read_data(m_datagen.file_out(), m_params.bits_out());
+		std::cout << "\t\t...done" << std::endl;
+		train();
+		return *this;
+	}
 
-		ss.open("../data/data_out", std::fstream::in);
-		if (!ss.good()) {
-			throw;
-		}
-		ss.read((char *)&width, sizeof(width));
-		ss.read((char *)&height, sizeof(height));
-		m_output = BinaryMatrix<T>(height, width);
-		ss.read((char *)m_output.cells().data(),
-		        m_output.cells().size() * sizeof(T));
-		ss.close();
-		if (m_output.cols() != m_params.bits_out() ||
-		    m_output.rows() != m_params.samples()) {
+	/**
+	 * Reads the sample file @param file and checks that it holds the
+	 * configured number of samples of length @param bits.
+	 */
+	BinaryMatrix<T> read_data(const std::string &file, size_t bits) const
+	{
+		BinaryMatrix<T> res = read_pattern_file<T>(file);
+		if (res.cols() != bits || res.rows() != m_params.samples()) {
 			std::stringstream s;
-			s << "Output data size " << m_output.cols() << " and "
-			  << m_output.rows() << " differs from given Parameters "
-			  << m_params.bits_out() << " and " << m_params.samples() << " !"
-			  << std::endl;
+			s << "Data size " << res.cols() << " and " << res.rows()
+			  << " of \"" << file << "\" differs from given Parameters "
+			  << bits << " and " << m_params.samples() << " !" << std::endl;
 			throw std::out_of_range(s.str());
 		}
-		std::cout << "\t\t...done" << std::endl;
-		m_BiNAM.train_mat(m_input, m_output);
-		return *this;
+		return res;
 	}
 
 	/**
@@ -356,11 +1777,39 @@ public:
 	 */
 	BiNAM_Container<T> &recall()
 	{
-		m_recall = m_BiNAM.recallMat(m_input);
-		m_SampleError = m_BiNAM.false_bits_mat(m_output, m_recall);
+		ThreadPool *pool = m_BiNAM.pool().get();
+		if (m_fixed && !m_kwta && !m_fixed_binam) {
+			m_fixed_binam =
+			    make_fixed_binam<T>(m_BiNAM.rows(), m_BiNAM.cols(), &m_BiNAM);
+		}
+		if (m_fixed && !m_kwta && m_fixed_binam) {
+			m_recall = m_fixed_binam->recallMat(m_input, pool);
+			m_SampleError =
+			    m_fixed_binam->false_bits_mat(m_output, m_recall, pool);
+			return *this;
+		}
+		m_recall = m_kwta ? m_BiNAM.recallMat_kwta(m_input, m_kwta)
+		                  : m_BiNAM.recallMat(m_input);
+		m_SampleError = m_BiNAM.false_bits_mat(m_output, m_recall, 0, pool);
 		return *this;
 	};
 
+	/**
+	 * Recalls the patterns with the input matrix and evaluates them in one
+	 * pass, see BiNAM::recall_analysis(). Equivalent to recall() followed by
+	 * analysis(), but the recall matrix is not kept: m_recall is cleared and
+	 * m_SampleError only filled if @param sample_errors is set.
+	 */
+	ExpResults recall_analysis(bool sample_errors = false)
+	{
+		m_recall = BinaryMatrix<T>();
+		m_SampleError.clear();
+		ExpResults res = m_BiNAM.recall_analysis(
+		    m_input, m_output, m_params,
+		    sample_errors ? &m_SampleError : nullptr, m_kwta);
+		return m_BiNAM.fill_statistics().annotate(res);
+	}
+
 	/**
 	 * Returns the vector of SampleError containing the number of false
 	 * positives and negatives per sample which is calculated by the recall
@@ -381,6 +1830,11 @@ public:
 		return sum;
 	};
 
+	/**
+	 * Number of synapses of the trained matrix, see BiNAM::fill_statistics()
+	 */
+	FillStatistics fill_statistics() const { return m_BiNAM.fill_statistics(); }
+
 	/*
 	 * Gives back an approximate number of expected false positives
 	 */
@@ -390,9 +1844,22 @@ public:
 		return se;
 	};
 
+	/**
+	 * Predicts the false positives of every sample from the overlap of the
+	 * data, without training or recalling, see
+	 * PatternOverlap::predict_false_positives(). Unlike
+	 * theoretical_false_bits() this reflects the actual data, e.g. unbalanced
+	 * bit usage or repeated patterns.
+	 */
+	std::vector<SampleError> predicted_false_bits() const
+	{
+		return PatternOverlap::predict_false_positives(
+		    m_input, m_output, m_BiNAM.pool().get());
+	}
+
 	/**
 	 * Calculate the false positives and negatives as well as the stored
-	 * information.
+	 * information, together with the fill statistics of the trained matrix.
 	 * @param recall_matrix: recalled matrix from experiment. If nothing is
 	 * given, it takes the member recall matrix.
 	 */
@@ -401,14 +1868,17 @@ public:
 	{
 		std::vector<SampleError> se;
 		if (recall_matrix.size() == 0) {
-			se = m_BiNAM.false_bits_mat(m_output, m_recall, n_samples_max);
+			se = m_BiNAM.false_bits_mat(m_output, m_recall, n_samples_max,
+			                            m_BiNAM.pool().get());
 		}
 		else {
-			se = m_BiNAM.false_bits_mat(m_output, recall_matrix, n_samples_max);
+			se = m_BiNAM.false_bits_mat(m_output, recall_matrix, n_samples_max,
+			                            m_BiNAM.pool().get());
 		}
 		double info = entropy_hetero(m_params, se);
 		SampleError sum = sum_false_bits(se);
-		return ExpResults(info, sum);
+		ExpResults res(info, sum);
+		return m_BiNAM.fill_statistics().annotate(res);
 	};
 
 	ExpResults analysis(size_t n_samples_max = 0)
@@ -417,6 +1887,26 @@ public:
 		return analysis(tmp, n_samples_max);
 	}
 
+	/**
+	 * Recalls the patterns with every threshold in [thresh_min, thresh_max]
+	 * and calculates the false positives and negatives as well as the stored
+	 * information for each of them. The dendritic sums are only computed once,
+	 * see BiNAM::false_bits_thresholds(). Element k of the result belongs to
+	 * the threshold thresh_min + k.
+	 */
+	std::vector<ExpResults> analysis_thresholds(size_t thresh_min,
+	                                            size_t thresh_max)
+	{
+		const FillStatistics fill = m_BiNAM.fill_statistics();
+		std::vector<ExpResults> res;
+		for (auto &se : m_BiNAM.false_bits_thresholds(m_input, m_output,
+		                                              thresh_min, thresh_max)) {
+			res.emplace_back(entropy_hetero(m_params, se), sum_false_bits(se));
+			fill.annotate(res.back());
+		}
+		return res;
+	}
+
 	/**
 	 * Getter for member matrices
 	 */
@@ -425,7 +1915,15 @@ public:
 	const BinaryMatrix<T> &output_matrix() const { return m_output; };
 	const BinaryMatrix<T> &recall_matrix() const { return m_recall; };
 
-	void trained_matrix(BiNAM<T> mat) { m_BiNAM = mat; };
+	void trained_matrix(BiNAM<T> mat)
+	{
+		if (!mat.pool()) {
+			mat.pool(m_BiNAM.pool());
+		}
+		m_BiNAM = mat;
+		m_fixed_binam = nullptr;
+		m_trained = true;
+	};
 	void input_matrix(BinaryMatrix<T> mat) { m_input = mat; };
 	void output_matrix(BinaryMatrix<T> mat) { m_output = mat; };
 	void recall_matrix(BinaryMatrix<T> mat) { m_recall = mat; };
@@ -0,0 +1,326 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_CORE_CAPACITY_CURVE_HPP
+#define CPPNAM_CORE_CAPACITY_CURVE_HPP
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "core/binam.hpp"
+#include "core/entropy.hpp"
+#include "core/parameters.hpp"
+#include "util/data.hpp"
+
+namespace nam {
+
+/**
+ * Incremental evaluation of the storage capacity of a BiNAM over the number of
+ * stored samples. The data set is generated once for the maximum number of
+ * samples, the samples are then trained one after another. As training only
+ * ever adds synapses, the exact recall of a stored sample can only gain
+ * (false positive) bits. When a sample is added, only the recalls of stored
+ * samples sharing an active input bit with it can change, these are found
+ * with an inverted index from input bits to samples. The number of false
+ * positives of every stored sample is therefore always up to date, and the
+ * information for the first n samples is available at any time without
+ * retraining or recalling everything.
+ */
+template <typename T>
+class CapacityCurve {
+public:
+	/**
+	 * Function called whenever bit @param i of the recall of sample
+	 * @param q switches on, including the bits of a newly added sample.
+	 */
+	using RecallCallback = std::function<void(size_t q, uint32_t i)>;
+
+private:
+	DataParameters m_params;
+	DataGenerationParameters m_datagen;
+	BinaryMatrix<T> m_input, m_output;
+	BiNAM<T> m_BiNAM;
+
+	// Active bits of all samples
+	std::vector<std::vector<uint32_t>> m_in_idx, m_out_idx;
+
+	// For every input neuron the stored samples in which it is active
+	std::vector<std::vector<uint32_t>> m_index;
+
+	// False positives per stored sample and number of samples per count
+	std::vector<size_t> m_fp, m_fp_hist;
+	size_t m_fp_sum = 0;
+
+	// Number of samples trained so far
+	size_t m_samples = 0;
+
+	// Buffers for add_sample()
+	std::vector<size_t> m_stamp;
+	std::vector<std::pair<uint32_t, uint32_t>> m_pending;
+	BinaryVector<T> m_vec;
+	std::vector<uint32_t> m_rec;
+
+	RecallCallback m_on_recall;
+
+	/**
+	 * Returns true if the row of output neuron @param i contains all active
+	 * input bits of sample @param q.
+	 */
+	bool covers(uint32_t i, size_t q) const
+	{
+		for (auto j : m_in_idx[q]) {
+			if (!m_BiNAM.get_bit(i, j)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool contains(const std::vector<uint32_t> &idx, uint32_t i)
+	{
+		return std::binary_search(idx.begin(), idx.end(), i);
+	}
+
+	void false_positive(size_t q)
+	{
+		m_fp_hist[m_fp[q]]--;
+		m_fp[q]++;
+		m_fp_hist[m_fp[q]]++;
+		m_fp_sum++;
+	}
+
+	/**
+	 * Trains the next sample and updates the recalls of all stored samples.
+	 */
+	void add_sample()
+	{
+		const size_t n = m_samples;
+		const auto &in = m_in_idx[n];
+		const auto &out = m_out_idx[n];
+
+		// Collect the output bits of stored samples, which are not recalled
+		// yet, but may be switched on by the new synapses
+		m_pending.clear();
+		for (auto j : in) {
+			for (auto q : m_index[j]) {
+				if (m_stamp[q] == n + 1) {
+					continue;
+				}
+				m_stamp[q] = n + 1;
+				for (auto i : out) {
+					if (!contains(m_out_idx[q], i) && !covers(i, q)) {
+						m_pending.emplace_back(q, i);
+					}
+				}
+			}
+		}
+
+		m_BiNAM.train_idx(in, out);
+		for (auto &p : m_pending) {
+			if (covers(p.second, p.first)) {
+				false_positive(p.first);
+				if (m_on_recall) {
+					m_on_recall(p.first, p.second);
+				}
+			}
+		}
+
+		// Recall of the new sample itself
+		m_fp.push_back(0);
+		m_fp_hist[0]++;
+		m_BiNAM.recall_into(m_input.row(n), m_vec.row(0));
+		m_vec.active_bits(0, m_rec);
+		for (auto i : m_rec) {
+			if (!contains(out, i)) {
+				false_positive(n);
+			}
+			if (m_on_recall) {
+				m_on_recall(n, i);
+			}
+		}
+		for (auto j : in) {
+			m_index[j].push_back(n);
+		}
+		m_samples++;
+	}
+
+public:
+	/**
+	 * Constructor, @param params contains the maximum number of samples
+	 */
+	CapacityCurve(DataParameters params, DataGenerationParameters datagen)
+	    : m_params(params), m_datagen(datagen){};
+	CapacityCurve(DataParameters params) : m_params(params), m_datagen(){};
+
+	/**
+	 * Sets the function called for every bit switching on in a recall, see
+	 * RecallCallback.
+	 */
+	CapacityCurve<T> &on_recall(RecallCallback callback)
+	{
+		m_on_recall = std::move(callback);
+		return *this;
+	}
+
+	/**
+	 * Generates the input and output data for the maximum number of samples
+	 * in the same way as BiNAM_Container::set_up(), nothing is trained yet.
+	 */
+	CapacityCurve<T> &set_up()
+	{
+		size_t seed =
+		    m_datagen.seed() ? m_datagen.seed() : std::random_device()();
+
+		std::thread input_thread([this, seed]() mutable {
+			m_input = DataGenerator(seed, m_datagen.random(),
+			                        m_datagen.balanced(), m_datagen.unique())
+			              .generate<T>(m_params.bits_in(), m_params.ones_in(),
+			                           m_params.samples());
+		});
+		std::thread output_thread([this, seed]() mutable {
+			m_output =
+			    DataGenerator(seed + 5, m_datagen.random(),
+			                  m_datagen.balanced(), m_datagen.unique())
+			        .generate<T>(m_params.bits_out(), m_params.ones_out(),
+			                     m_params.samples());
+		});
+
+		input_thread.join();
+		output_thread.join();
+		return set_up(m_input, m_output);
+	}
+
+	/**
+	 * Uses the given data instead of generating it.
+	 */
+	CapacityCurve<T> &set_up(const BinaryMatrix<T> &input,
+	                         const BinaryMatrix<T> &output)
+	{
+		if (input.rows() != output.rows() ||
+		    input.cols() != m_params.bits_in() ||
+		    output.cols() != m_params.bits_out()) {
+			std::stringstream ss;
+			ss << "Data of size " << input.size() << " and " << output.size()
+			   << " does not fit to the parameters" << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		m_input = input;
+		m_output = output;
+		m_params.samples(input.rows());
+		m_BiNAM = BiNAM<T>(m_params.bits_out(), m_params.bits_in(), true);
+		m_in_idx.resize(input.rows());
+		m_out_idx.resize(input.rows());
+		for (size_t i = 0; i < input.rows(); i++) {
+			input.active_bits(i, m_in_idx[i]);
+			output.active_bits(i, m_out_idx[i]);
+		}
+		m_index.assign(m_params.bits_in(), std::vector<uint32_t>());
+		m_fp.clear();
+		m_fp_hist.assign(m_params.bits_out() + 1, 0);
+		m_fp_sum = 0;
+		m_samples = 0;
+		m_stamp.assign(input.rows(), 0);
+		m_vec = BinaryVector<T>(m_params.bits_out());
+		return *this;
+	}
+
+	/**
+	 * Trains the samples up to (excluding) sample @param n.
+	 */
+	CapacityCurve<T> &train_until(size_t n)
+	{
+		if (n > m_input.rows()) {
+			throw std::out_of_range("Only " + std::to_string(m_input.rows()) +
+			                        " samples available, " +
+			                        std::to_string(n) + " requested");
+		}
+		while (m_samples < n) {
+			add_sample();
+		}
+		return *this;
+	}
+
+	/**
+	 * Information and number of errors of the recall of the samples trained
+	 * so far, as BiNAM_Container::analysis() would return it for a container
+	 * with this number of samples, including the fill of the matrix.
+	 */
+	ExpResults analysis() const
+	{
+		DataParameters params = m_params;
+		params.samples(m_samples);
+		double info = 0.0;
+		for (size_t fp = 0; fp < m_fp_hist.size(); fp++) {
+			if (m_fp_hist[fp]) {
+				info += m_fp_hist[fp] *
+				        entropy_hetero_sample(params, SampleError(fp, 0));
+			}
+		}
+		ExpResults res(info, SampleError(m_fp_sum, 0));
+		return m_BiNAM.fill_statistics().annotate(res);
+	}
+
+	/**
+	 * Evaluates the memory after training the number of samples given in
+	 * @param checkpoints (ascending), returns one result per checkpoint.
+	 */
+	std::vector<ExpResults> run(const std::vector<size_t> &checkpoints)
+	{
+		std::vector<ExpResults> res;
+		for (auto n : checkpoints) {
+			res.emplace_back(train_until(n).analysis());
+		}
+		return res;
+	}
+
+	/**
+	 * Number of samples trained so far
+	 */
+	size_t samples() const { return m_samples; }
+
+	/**
+	 * Active input and output bits of sample @param q
+	 */
+	const std::vector<uint32_t> &input_bits(size_t q) const
+	{
+		return m_in_idx[q];
+	}
+	const std::vector<uint32_t> &output_bits(size_t q) const
+	{
+		return m_out_idx[q];
+	}
+
+	/**
+	 * Getter for member matrices and the false positives of every sample
+	 */
+	const BiNAM<T> &trained_matrix() const { return m_BiNAM; };
+	const BinaryMatrix<T> &input_matrix() const { return m_input; };
+	const BinaryMatrix<T> &output_matrix() const { return m_output; };
+	const std::vector<size_t> &false_positives() const { return m_fp; };
+	const DataParameters &params() const { return m_params; };
+};
+}
+
+#endif /* CPPNAM_CORE_CAPACITY_CURVE_HPP */
@@ -0,0 +1,417 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_CORE_COMPRESSED_BINAM_HPP
+#define CPPNAM_CORE_COMPRESSED_BINAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "core/binam.hpp"
+#include "util/binary_matrix.hpp"
+#include "util/compressed_bitmap.hpp"
+#include "util/sparse_pattern_matrix.hpp"
+#include "util/thread_pool.hpp"
+
+namespace nam {
+
+/**
+ * Trained BiNAM matrix stored compressed, for large memories with only few
+ * trained synapses. The matrix is kept input-major: for every input neuron a
+ * CompressedBitmap holds the output neurons its synapses are set to. Every
+ * chunk of 2^16 output neurons of a column is encoded as list, bitmap or
+ * runs, depending on which is smallest, so the memory grows with the number
+ * of trained synapses and never exceeds the dense size by much. Training,
+ * recall and threshold recall give the same results as BiNAM.
+ */
+template <typename T>
+class CompressedBiNAM {
+private:
+	std::vector<CompressedBitmap> m_columns;
+	size_t m_rows = 0;
+
+	/**
+	 * Pool used to parallelise training and recall of whole matrices, see
+	 * BiNAM::pool()
+	 */
+	std::shared_ptr<ThreadPool> m_pool;
+
+	/**
+	 * Training of a sample pair given as lists of active input and output
+	 * neurons. Only the inputs in [@param begin, @param end) are trained.
+	 */
+	void train_idx(const uint32_t *in, size_t n_in, const uint32_t *out,
+	               size_t n_out, size_t begin, size_t end)
+	{
+		for (size_t j = 0; j < n_in; j++) {
+			if (in[j] < begin || in[j] >= end) {
+				continue;
+			}
+			for (size_t i = 0; i < n_out; i++) {
+				m_columns[in[j]].add(out[i]);
+			}
+		}
+	}
+
+	/**
+	 * Sets all bits of @param res
+	 */
+	void fill(const RowView<T> &res) const
+	{
+		for (size_t i = 0; i < m_rows; i++) {
+			res.set_bit(i);
+		}
+	}
+
+	/**
+	 * Exact recall of the active inputs @param idx: the sparsest selected
+	 * column is iterated and every output neuron is checked in the others.
+	 */
+	void recall_idx(const std::vector<uint32_t> &idx,
+	                const RowView<T> &res) const
+	{
+		res.clear();
+		if (idx.empty()) {
+			fill(res);
+			return;
+		}
+		uint32_t sparsest = idx[0];
+		for (auto j : idx) {
+			if (m_columns[j].count() < m_columns[sparsest].count()) {
+				sparsest = j;
+			}
+		}
+		m_columns[sparsest].for_each([&](size_t i) {
+			for (auto j : idx) {
+				if (j != sparsest && !m_columns[j].contains(i)) {
+					return;
+				}
+			}
+			res.set_bit(i);
+		});
+	}
+
+	/**
+	 * Threshold recall of the active inputs @param idx. The dendritic sums
+	 * are counted in @param counts, which has to be zero and is left zero,
+	 * only the entries of set synapses are touched.
+	 */
+	void recall_idx(const std::vector<uint32_t> &idx, size_t thresh,
+	                const RowView<T> &res, std::vector<uint32_t> &counts) const
+	{
+		res.clear();
+		if (thresh == 0) {
+			fill(res);
+			return;
+		}
+		counts.resize(m_rows);
+		for (auto j : idx) {
+			m_columns[j].for_each([&](size_t i) {
+				if (++counts[i] == thresh) {
+					res.set_bit(i);
+				}
+			});
+		}
+		for (auto j : idx) {
+			m_columns[j].for_each([&](size_t i) { counts[i] = 0; });
+		}
+	}
+
+	void check_recall(const ConstRowView<T> &in, const RowView<T> &res) const
+	{
+		if (in.size() != cols() || res.size() != rows()) {
+			std::stringstream ss;
+			ss << "Input size " << in.size() << " or output size "
+			   << res.size() << " does not fit to matrix of size " << rows()
+			   << "x" << cols() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	template <typename Samples>
+	void check_train(const Samples &in, const Samples &out) const
+	{
+		if (in.cols() != cols() || out.cols() != rows() ||
+		    in.rows() != out.rows()) {
+			std::stringstream ss;
+			ss << in.size() << " and " << out.size()
+			   << " out of range for matrix of size " << size() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	template <typename Recall>
+	BinaryMatrix<T> recall_mat(const BinaryMatrix<T> &in, Recall recall) const
+	{
+		if (in.cols() != cols()) {
+			std::stringstream ss;
+			ss << in.size() << " out of range for matrix of size " << cols()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		BinaryMatrix<T> res(in.rows(), rows());
+		parallel_for(m_pool.get(), 0, in.rows(), 1,
+		             [&](size_t begin, size_t end) {
+			             std::vector<uint32_t> idx, counts;
+			             for (size_t q = begin; q < end; q++) {
+				             in.active_bits(q, idx);
+				             recall(idx, res.row(q), counts);
+			             }
+			         });
+		return res;
+	}
+
+	void optimize_columns()
+	{
+		parallel_for(m_pool.get(), 0, cols(), 1, [&](size_t begin, size_t end) {
+			for (size_t j = begin; j < end; j++) {
+				m_columns[j].optimize();
+			}
+		});
+	}
+
+public:
+	CompressedBiNAM() = default;
+
+	/**
+	 * Creates an untrained matrix with @param output x @param input synapses
+	 */
+	CompressedBiNAM(size_t output, size_t input)
+	    : m_columns(input, CompressedBitmap(output)), m_rows(output)
+	{
+	}
+
+	/**
+	 * Compresses the trained matrix @param mat, e.g. a BiNAM
+	 */
+	explicit CompressedBiNAM(const BinaryMatrix<T> &mat)
+	    : CompressedBiNAM(mat.rows(), mat.cols())
+	{
+		std::vector<uint32_t> idx;
+		for (size_t i = 0; i < mat.rows(); i++) {
+			mat.active_bits(i, idx);
+			for (auto j : idx) {
+				m_columns[j].add(i);
+			}
+		}
+		optimize_columns();
+	}
+
+	/**
+	 * Sets the pool used for training and recall of whole matrices
+	 */
+	CompressedBiNAM<T> &pool(std::shared_ptr<ThreadPool> pool)
+	{
+		m_pool = std::move(pool);
+		return *this;
+	}
+	const std::shared_ptr<ThreadPool> &pool() const { return m_pool; }
+
+	size_t rows() const { return m_rows; }
+	size_t cols() const { return m_columns.size(); }
+	size_t size() const { return rows() * cols(); }
+
+	bool get_bit(size_t row, size_t col) const
+	{
+		return m_columns.at(col).contains(row);
+	}
+
+	/**
+	 * Number of set synapses
+	 */
+	size_t count() const
+	{
+		size_t res = 0;
+		for (auto &col : m_columns) {
+			res += col.count();
+		}
+		return res;
+	}
+
+	/**
+	 * Number of bytes used by the matrix
+	 */
+	size_t memory() const
+	{
+		size_t res = sizeof(*this);
+		for (auto &col : m_columns) {
+			res += col.memory();
+		}
+		return res;
+	}
+
+	/**
+	 * Number of containers with the encoding @param type
+	 */
+	size_t containers(CompressedBitmap::Type type) const
+	{
+		size_t res = 0;
+		for (auto &col : m_columns) {
+			res += col.containers(type);
+		}
+		return res;
+	}
+
+	/**
+	 * Re-encodes all containers with the smallest encoding. Done after every
+	 * train_mat(), single training steps only switch from lists to bitmaps.
+	 */
+	CompressedBiNAM<T> &optimize()
+	{
+		optimize_columns();
+		return *this;
+	}
+
+	/**
+	 * Training of a sample pair, see BiNAM::train_vec_check()
+	 */
+	CompressedBiNAM<T> &train_vec_check(const ConstRowView<T> &in,
+	                                    const ConstRowView<T> &out)
+	{
+		if (in.size() != cols() || out.size() != rows()) {
+			std::stringstream ss;
+			ss << "Input size " << in.size() << " or output size "
+			   << out.size() << " does not fit to matrix of size " << rows()
+			   << "x" << cols() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		std::vector<uint32_t> idx_in, idx_out;
+		in.active_bits(idx_in);
+		out.active_bits(idx_out);
+		train_idx(idx_in.data(), idx_in.size(), idx_out.data(),
+		          idx_out.size(), 0, cols());
+		return *this;
+	}
+
+	/**
+	 * Training of whole matrices. With a thread pool every thread trains a
+	 * block of input neurons.
+	 */
+	CompressedBiNAM<T> &train_mat(const BinaryMatrix<T> &in,
+	                              const BinaryMatrix<T> &out)
+	{
+		check_train(in, out);
+		parallel_for(m_pool.get(), 0, cols(), 1, [&](size_t begin,
+		                                             size_t end) {
+			std::vector<uint32_t> idx_in, idx_out;
+			for (size_t q = 0; q < in.rows(); q++) {
+				in.active_bits(q, begin, end, idx_in);
+				if (idx_in.empty()) {
+					continue;
+				}
+				out.active_bits(q, idx_out);
+				train_idx(idx_in.data(), idx_in.size(), idx_out.data(),
+				          idx_out.size(), begin, end);
+			}
+		});
+		return optimize();
+	}
+
+	CompressedBiNAM<T> &train_mat(const SparsePatternMatrix &in,
+	                              const SparsePatternMatrix &out)
+	{
+		check_train(in, out);
+		parallel_for(m_pool.get(), 0, cols(), 1, [&](size_t begin,
+		                                             size_t end) {
+			for (size_t q = 0; q < in.rows(); q++) {
+				train_idx(in.row_ptr(q), in.ones(), out.row_ptr(q),
+				          out.ones(), begin, end);
+			}
+		});
+		return optimize();
+	}
+
+	/**
+	 * Recall of the sample @param in into @param res, with or without the
+	 * threshold @param thresh, see BiNAM::recall_into()
+	 */
+	void recall_into(const ConstRowView<T> &in, const RowView<T> &res) const
+	{
+		check_recall(in, res);
+		std::vector<uint32_t> idx;
+		in.active_bits(idx);
+		recall_idx(idx, res);
+	}
+
+	void recall_into(const ConstRowView<T> &in, size_t thresh,
+	                 const RowView<T> &res) const
+	{
+		check_recall(in, res);
+		std::vector<uint32_t> idx, counts;
+		in.active_bits(idx);
+		recall_idx(idx, thresh, res, counts);
+	}
+
+	BinaryVector<T> recall(const BinaryVector<T> &in) const
+	{
+		BinaryVector<T> vec(rows());
+		recall_into(in.row(0), vec.row(0));
+		return vec;
+	}
+
+	BinaryVector<T> recall(const BinaryVector<T> &in, size_t thresh) const
+	{
+		BinaryVector<T> vec(rows());
+		recall_into(in.row(0), thresh, vec.row(0));
+		return vec;
+	}
+
+	/**
+	 * Recall of all samples of @param in, distributed onto the pool
+	 */
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in) const
+	{
+		return recall_mat(in, [this](const std::vector<uint32_t> &idx,
+		                             const RowView<T> &res,
+		                             std::vector<uint32_t> &) {
+			recall_idx(idx, res);
+		});
+	}
+
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in, size_t thresh) const
+	{
+		return recall_mat(in, [this, thresh](const std::vector<uint32_t> &idx,
+		                                     const RowView<T> &res,
+		                                     std::vector<uint32_t> &counts) {
+			recall_idx(idx, thresh, res, counts);
+		});
+	}
+
+	/**
+	 * Decompresses the matrix into a BiNAM, which maintains its synapse
+	 * counts, see BiNAM::recount()
+	 */
+	BiNAM<T> toBiNAM() const
+	{
+		BiNAM<T> res(rows(), cols());
+		for (size_t j = 0; j < cols(); j++) {
+			m_columns[j].for_each([&](size_t i) { res.set_bit(i, j); });
+		}
+		res.recount();
+		return res;
+	}
+};
+}
+
+#endif /* CPPNAM_CORE_COMPRESSED_BINAM_HPP */
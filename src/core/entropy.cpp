@@ -48,26 +48,33 @@ double entropy_hetero_uniform(const DataParameters &params,
 	return res * params.samples();
 }
 
+double entropy_hetero_sample(const DataParameters &params,
+                             const SampleError &err)
+{
+	double ent = 0.0;
+	if (err.fn > 0) {
+		ent = (lnncrr(params.bits_out(), params.ones_out()) -
+		       lnncrr(err.fp + params.ones_out() - err.fn,
+		              params.ones_out() - err.fn) -
+		       lnncrr(params.bits_out() - err.fp - params.ones_out() + err.fn,
+		              err.fn)) /
+		      std::log(2.0);
+	}
+	else {
+		for (size_t j = 0; j < params.ones_out(); j++) {
+			ent += std::log2(double(params.bits_out() - j) /
+			                 double(params.ones_out() + err.fp - j));
+		}
+	}
+	return ent;
+}
+
 double entropy_hetero(const DataParameters &params,
                       const std::vector<SampleError> &errs)
 {
 	double ent = 0.0;
 	for (auto &err : errs) {
-		if (err.fn > 0) {
-			ent +=
-			    (lnncrr(params.bits_out(), params.ones_out()) -
-			     lnncrr(err.fp + params.ones_out() - err.fn,
-			            params.ones_out() - err.fn) -
-			     lnncrr(params.bits_out() - err.fp - params.ones_out() + err.fn,
-			            err.fn)) /
-			    std::log(2.0);
-		}
-		else {
-			for (size_t j = 0; j < params.ones_out(); j++) {
-				ent += std::log2(double(params.bits_out() - j) /
-				                 double(params.ones_out() + err.fp - j));
-			}
-		}
+		ent += entropy_hetero_sample(params, err);
 	}
 	return ent;
 }
@@ -64,21 +64,38 @@ struct SampleError {
 	SampleError(double fp = 0.0, double fn = 0.0) : fp(fp), fn(fn) {}
 };
 
+/**
+ * Result of an experiment: stored information, false positives and negatives
+ * and the recall rate. The remaining fields describe the trained matrix: the
+ * fraction of set synapses, their number and the largest number of synapses
+ * of an output neuron (fan-in) and of an input neuron (fan-out), see
+ * FillStatistics. Only contains doubles, as results are written to backup
+ * files as raw memory.
+ */
 struct ExpResults {
-	double Info, fp, fn, rr;
+	double Info = 0, fp = 0, fn = 0, rr = 0;
+	double fill = 0, synapses = 0, max_in = 0, max_out = 0;
 
 	ExpResults(double Info, double fp, double fn, double rr)
 	    : Info(Info), fp(fp), fn(fn), rr(rr){};
 	ExpResults(double Info, SampleError se)
 	    : Info(Info), fp(se.fp), fn(se.fn){};
-	ExpResults() : Info(0), fp(0), fn(0){};
+	ExpResults(){};
 	void print()
 	{
 		std::cout << "Info :" << Info << " pos:" << fp << " neg: " << fn
-		          << std::endl;
+		          << " fill: " << fill << std::endl;
 	}
 };
 
+/**
+ * Information contributed by a single sample with the errors @param err, the
+ * summand of entropy_hetero(). Allows to accumulate the information while
+ * evaluating the samples one after another.
+ */
+double entropy_hetero_sample(const DataParameters &params,
+                             const SampleError &err);
+
 /**
  * Calculates the entropy from an errors-per sample matrix (returned by
  * analyseSampleErrors) and for the given output vector size and the mean
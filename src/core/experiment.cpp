@@ -63,6 +63,14 @@ std::vector<std::string> split(const std::string &s, char delim)
 	return elems;
 }
 
+/**
+ * Header of the sweep backup files "*_bak.dat", which hold the job order, the
+ * results and the finished jobs as raw memory. Files without a matching header,
+ * e.g. written before ExpResults carried the fill statistics, are not resumed.
+ */
+const uint64_t BACKUP_MAGIC = 0x4B41424D414E5043;  // "CPNAMBAK"
+const uint64_t BACKUP_VERSION = 2;
+
 void progress_callback(double p)
 {
 	const int w = 50;
@@ -256,7 +264,9 @@ void run_standard_neat_output(SpNetwBasis &SpBinam, std::ostream &ofs,
 	}
 	else {
 		if (print_params) {
-			ofs << "info, info_th,info_n, fp, fp_th, fn, fn_th" << std::endl;
+			ofs << "info, info_th,info_n, fp, fp_th, fn, fn_th, fill, synapses, "
+			       "max_in, max_out"
+			    << std::endl;
 		}
 		SpBinam.evaluate_csv(ofs);
 		ofs << std::endl;
@@ -376,7 +386,9 @@ void output(const std::vector<std::vector<Real>> &sweep_values,
 		    << results[j].second.Info / results[j].first.Info << ", "
 		    << results[j].second.fp << ", " << results[j].first.fp << ", "
 		    << results[j].second.fn << ", " << results[j].first.fn << ", "
-		    << results[j].second.rr;
+		    << results[j].second.rr << ", " << results[j].first.fill << ", "
+		    << results[j].first.synapses << ", " << results[j].first.max_in
+		    << ", " << results[j].first.max_out;
 		
 		ofs << std::endl;
 	}
@@ -556,7 +568,9 @@ size_t Experiment::run_experiment(size_t exp,
 			ofs << names[j][1] << ", ";
 		}
 	}
-	ofs << "info, info_th,info_n, fp, fp_th, fn, fn_th, rec_rate" << std::endl;
+	ofs << "info, info_th,info_n, fp, fp_th, fn, fn_th, rec_rate, fill, "
+	       "synapses, max_in, max_out"
+	    << std::endl;
 
 	// Shuffle sweep indices for stochastic independence in simulations on
 	// spikey
@@ -589,16 +603,45 @@ size_t Experiment::run_experiment(size_t exp,
 	// Check if last simulation broke down, recover state if backup is there
 	std::fstream ss(experiment_names[exp] + "_" + stripped_backend + "_bak.dat",
 	                std::fstream::in);
+	const uint64_t header[] = {BACKUP_MAGIC, BACKUP_VERSION,
+	                           sizeof(Results::value_type), indices.size(),
+	                           results.size()};
 	bool resume = ss.good();
 	if (resume) {
-		ss.read((char *)indices.data(), indices.size() * sizeof(size_t));
-		ss.read((char *)results.data(),
+		uint64_t file_header[5] = {0};
+		ss.read((char *)file_header, sizeof(file_header));
+		resume = ss.good() &&
+		         std::equal(std::begin(header), std::end(header), file_header);
+	}
+	if (resume) {
+		std::vector<size_t> file_indices(indices.size());
+		Results file_results(results.size());
+		ss.read((char *)file_indices.data(), indices.size() * sizeof(size_t));
+		ss.read((char *)file_results.data(),
 		        results.size() * sizeof(Results::value_type));
 		size_t length = 0;
 		ss.read((char *)&length, sizeof(length));
-		jobs_done.resize(length);
-		ss.read((char *)jobs_done.data(), length * sizeof(size_t));
+		resume = ss.good() && length <= results.size();
+		if (resume) {
+			jobs_done.resize(length);
+			ss.read((char *)jobs_done.data(), length * sizeof(size_t));
+			resume = bool(ss);
+		}
+		if (resume) {
+			indices = std::move(file_indices);
+			results = std::move(file_results);
+		}
+		else {
+			jobs_done.clear();
+		}
+	}
+	if (ss.is_open()) {
 		ss.close();
+		if (!resume) {
+			std::cerr << "Ignoring incompatible backup file "
+			          << experiment_names[exp] << "_" << stripped_backend
+			          << "_bak.dat" << std::endl;
+		}
 	}
 
 	for (size_t i = 0; i < n_threads; i++) {
@@ -727,6 +770,7 @@ size_t Experiment::run_experiment(size_t exp,
 				std::unique_lock<std::shared_timed_mutex> lock3(res_mutex);
 				ss.open(experiment_names[exp] + "_" + stripped_backend + "_bak.dat",
 				        std::fstream::out);
+				ss.write((char *)header, sizeof(header));
 				ss.write((char *)indices.data(),
 				         indices.size() * sizeof(size_t));
 				ss.write((char *)results.data(),
@@ -0,0 +1,413 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_CORE_FIXED_BINAM_HPP
+#define CPPNAM_CORE_FIXED_BINAM_HPP
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "core/entropy.hpp"
+#include "util/aligned_buffer.hpp"
+#include "util/binary_matrix.hpp"
+#include "util/bit_sliced_counter.hpp"
+#include "util/fixed_binary_matrix.hpp"
+#include "util/population_count.hpp"
+#include "util/thread_pool.hpp"
+
+namespace nam {
+
+/**
+ * BiNAM with a geometry fixed at compile time, see FixedBinaryMatrix. Rows
+ * are output neurons and columns input neurons, as in BiNAM. The input-major
+ * copy is always kept, so a recall only reads the columns of the active input
+ * neurons. Results are identical to the ones of BiNAM.
+ */
+template <typename T, size_t Outputs, size_t Inputs>
+class FixedBiNAM : public FixedBinaryMatrix<T, Outputs, Inputs> {
+private:
+	using Base = FixedBinaryMatrix<T, Outputs, Inputs>;
+	using Columns = FixedBinaryMatrix<T, Inputs, Outputs>;
+
+	static constexpr size_t CELLS_IN = Base::CELLS;
+	static constexpr size_t CELLS_OUT = Columns::CELLS;
+
+	/**
+	 * Input-major copy of the storage matrix
+	 */
+	Columns m_columns;
+
+	/**
+	 * Calls @param f with the index of every bit set in the N cells at
+	 * @param cells
+	 */
+	template <size_t N, typename F>
+	static void for_each_bit(const T *cells, F &&f)
+	{
+		unroll<N>([&](size_t c) {
+			T cell = cells[c];
+			while (cell) {
+				f(c * Base::intWidth + trailing_zeros<T>(cell));
+				cell &= cell - 1;
+			}
+		});
+	}
+
+	/**
+	 * Recall of the input cells @param in into the output cells @param res:
+	 * the AND of the selected columns or, with @param thresh, their sum in
+	 * bit-sliced counters. Dimensions are not checked.
+	 */
+	void recall_cells(const T *in, T *res) const
+	{
+		unroll<CELLS_OUT>([&](size_t k) { res[k] = Base::intMax; });
+		for_each_bit<CELLS_IN>(in, [&](size_t j) {
+			const T *col = m_columns.row_ptr(j);
+			unroll<CELLS_OUT>([&](size_t k) { res[k] &= col[k]; });
+		});
+		res[CELLS_OUT - 1] &= Columns::LAST_MASK;
+	}
+
+	void recall_cells(const T *in, size_t thresh, T *res) const
+	{
+		BitSlicedCounter<T> counters[CELLS_OUT];
+		for_each_bit<CELLS_IN>(in, [&](size_t j) {
+			const T *col = m_columns.row_ptr(j);
+			unroll<CELLS_OUT>([&](size_t k) { counters[k].add(col[k]); });
+		});
+		unroll<CELLS_OUT>(
+		    [&](size_t k) { res[k] = counters[k].greater_equal(thresh); });
+		res[CELLS_OUT - 1] &= Columns::LAST_MASK;
+	}
+
+	static void check_size(size_t size, size_t expected)
+	{
+		if (size != expected) {
+			std::stringstream ss;
+			ss << "Size " << size << " does not fit to fixed size "
+			   << expected << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	template <typename Recall>
+	BinaryMatrix<T> recall_mat(const BinaryMatrix<T> &in, ThreadPool *pool,
+	                           Recall recall) const
+	{
+		check_size(in.cols(), Inputs);
+		BinaryMatrix<T> res(in.rows(), Outputs);
+		parallel_for(pool, 0, in.rows(), 1, [&](size_t begin, size_t end) {
+			for (size_t q = begin; q < end; q++) {
+				recall(in.row_ptr(q), res.row_ptr(q));
+			}
+		});
+		return res;
+	}
+
+public:
+	/**
+	 * Initialiser with zeros.
+	 */
+	FixedBiNAM() = default;
+
+	/**
+	 * Copies the trained matrix @param mat, e.g. a BiNAM. Throws
+	 * std::out_of_range if the dimensions differ.
+	 */
+	explicit FixedBiNAM(const BinaryMatrix<T> &mat)
+	    : Base(mat), m_columns(mat.transposed())
+	{
+	}
+
+	/**
+	 * Training of a sample pair, see BiNAM::train_vec_check()
+	 */
+	FixedBiNAM &train_vec(const ConstRowView<T> &in,
+	                      const ConstRowView<T> &out)
+	{
+		check_size(in.size(), Inputs);
+		check_size(out.size(), Outputs);
+		const T *in_cells = in.data();
+		const T *out_cells = out.data();
+		for_each_bit<CELLS_OUT>(out_cells, [&](size_t i) {
+			T *row = Base::row_ptr(i);
+			unroll<CELLS_IN>([&](size_t c) { row[c] |= in_cells[c]; });
+		});
+		for_each_bit<CELLS_IN>(in_cells, [&](size_t j) {
+			T *col = m_columns.row_ptr(j);
+			unroll<CELLS_OUT>([&](size_t k) { col[k] |= out_cells[k]; });
+		});
+		return *this;
+	}
+
+	/**
+	 * Training of all sample pairs of @param in and @param out
+	 */
+	FixedBiNAM &train_mat(const BinaryMatrix<T> &in,
+	                      const BinaryMatrix<T> &out)
+	{
+		check_size(out.rows(), in.rows());
+		for (size_t q = 0; q < in.rows(); q++) {
+			train_vec(in.row(q), out.row(q));
+		}
+		return *this;
+	}
+
+	/**
+	 * Recall of the sample @param in into @param res, with or without the
+	 * threshold @param thresh, see BiNAM::recall_into()
+	 */
+	void recall_into(const ConstRowView<T> &in, const RowView<T> &res) const
+	{
+		check_size(in.size(), Inputs);
+		check_size(res.size(), Outputs);
+		recall_cells(in.data(), res.data());
+	}
+
+	void recall_into(const ConstRowView<T> &in, size_t thresh,
+	                 const RowView<T> &res) const
+	{
+		check_size(in.size(), Inputs);
+		check_size(res.size(), Outputs);
+		recall_cells(in.data(), thresh, res.data());
+	}
+
+	/**
+	 * Recall of all samples of @param in, distributed onto @param pool if
+	 * given, see BiNAM::recallMat()
+	 */
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in,
+	                          ThreadPool *pool = nullptr) const
+	{
+		return recall_mat(in, pool, [this](const T *q, T *res) {
+			recall_cells(q, res);
+		});
+	}
+
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in, size_t thresh,
+	                          ThreadPool *pool = nullptr) const
+	{
+		return recall_mat(in, pool, [this, thresh](const T *q, T *res) {
+			recall_cells(q, thresh, res);
+		});
+	}
+
+	/**
+	 * False positives and negatives of the recalled sample @param recall
+	 * compared to @param out, see BiNAM::false_bits()
+	 */
+	static SampleError false_bits(const ConstRowView<T> &out,
+	                              const ConstRowView<T> &recall)
+	{
+		check_size(out.size(), Outputs);
+		check_size(recall.size(), Outputs);
+		const T *o = out.data();
+		const T *r = recall.data();
+		size_t fp = 0, fn = 0;
+		unroll<CELLS_OUT>([&](size_t k) {
+			fp += population_count<T>(T(r[k] & ~o[k]));
+			fn += population_count<T>(T(o[k] & ~r[k]));
+		});
+		return SampleError(fp, fn);
+	}
+
+	/**
+	 * False positives and negatives of all samples, see
+	 * BiNAM::false_bits_mat()
+	 */
+	static std::vector<SampleError> false_bits_mat(const BinaryMatrix<T> &out,
+	                                               const BinaryMatrix<T> &res,
+	                                               ThreadPool *pool = nullptr)
+	{
+		if (res.rows() > out.rows()) {
+			std::stringstream ss;
+			ss << res.rows() << " out of range for output matrix of size "
+			   << out.rows() << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		std::vector<SampleError> error(res.rows());
+		parallel_for(pool, 0, res.rows(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				error[i] = false_bits(out.row(i), res.row(i));
+			}
+		});
+		return error;
+	}
+};
+
+template <typename T, size_t Outputs, size_t Inputs>
+constexpr size_t FixedBiNAM<T, Outputs, Inputs>::CELLS_IN;
+
+template <typename T, size_t Outputs, size_t Inputs>
+constexpr size_t FixedBiNAM<T, Outputs, Inputs>::CELLS_OUT;
+
+/**
+ * Geometry of a FixedBiNAM, output x input neurons
+ */
+template <size_t Outputs, size_t Inputs>
+struct FixedSize {
+};
+
+/**
+ * Geometries for which dispatch_fixed_binam() selects a FixedBiNAM: the
+ * 100 x 100 test experiment and the 384 x 256 and 96 x 64 Spikey networks.
+ */
+using FixedBiNAMSizes = std::tuple<FixedSize<100, 100>, FixedSize<384, 256>,
+                                   FixedSize<96, 64>>;
+
+/**
+ * Tag passed to the callback of dispatch_fixed_binam(), carries the type of
+ * the selected FixedBiNAM
+ */
+template <typename B>
+struct FixedType {
+	using type = B;
+};
+
+namespace internal {
+template <typename T, typename Sizes>
+struct FixedDispatch;
+
+template <typename T>
+struct FixedDispatch<T, std::tuple<>> {
+	template <typename F>
+	static bool run(size_t, size_t, F &)
+	{
+		return false;
+	}
+};
+
+template <typename T, size_t Outputs, size_t Inputs, typename... Sizes>
+struct FixedDispatch<T, std::tuple<FixedSize<Outputs, Inputs>, Sizes...>> {
+	template <typename F>
+	static bool run(size_t outputs, size_t inputs, F &f)
+	{
+		if (outputs == Outputs && inputs == Inputs) {
+			f(FixedType<FixedBiNAM<T, Outputs, Inputs>>());
+			return true;
+		}
+		return FixedDispatch<T, std::tuple<Sizes...>>::run(outputs, inputs,
+		                                                    f);
+	}
+};
+}
+
+/**
+ * Calls @param f with a FixedType tag of the FixedBiNAM matching the
+ * geometry @param outputs x @param inputs if it is one of @param Sizes (by
+ * default FixedBiNAMSizes). Returns false, without calling f, otherwise.
+ * Usually f is a generic lambda:
+ *
+ *     dispatch_fixed_binam<T>(rows, cols, [&](auto tag) {
+ *         typename decltype(tag)::type binam(mat);
+ *         ...
+ *     });
+ */
+template <typename T, typename Sizes = FixedBiNAMSizes, typename F>
+bool dispatch_fixed_binam(size_t outputs, size_t inputs, F &&f)
+{
+	return internal::FixedDispatch<T, Sizes>::run(outputs, inputs, f);
+}
+
+/**
+ * FixedBiNAM with the geometry only known at runtime, for keeping one in a
+ * BiNAM_Container. See make_fixed_binam().
+ */
+template <typename T>
+class AnyFixedBiNAM {
+public:
+	virtual ~AnyFixedBiNAM(){};
+	virtual AnyFixedBiNAM &train_mat(const BinaryMatrix<T> &in,
+	                                 const BinaryMatrix<T> &out) = 0;
+	virtual BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in,
+	                                  ThreadPool *pool = nullptr) const = 0;
+	virtual std::vector<SampleError> false_bits_mat(
+	    const BinaryMatrix<T> &out, const BinaryMatrix<T> &res,
+	    ThreadPool *pool = nullptr) const = 0;
+	virtual BinaryMatrix<T> toBinaryMatrix() const = 0;
+};
+
+template <typename B, typename T>
+class AnyFixedBiNAMImpl : public AnyFixedBiNAM<T> {
+private:
+	static_assert(alignof(B) <= AlignedMemory::ALIGNMENT,
+	              "FixedBiNAM over-aligned");
+	B m_binam;
+
+public:
+	AnyFixedBiNAMImpl() = default;
+	explicit AnyFixedBiNAMImpl(const BinaryMatrix<T> &mat) : m_binam(mat) {}
+
+	/**
+	 * The cells of a FixedBiNAM are aligned to a cache line, which the
+	 * default operator new does not guarantee before C++17
+	 */
+	static void *operator new(size_t bytes)
+	{
+		return AlignedMemory::allocate(bytes);
+	}
+	static void operator delete(void *ptr) { AlignedMemory::free(ptr); }
+
+	AnyFixedBiNAM<T> &train_mat(const BinaryMatrix<T> &in,
+	                            const BinaryMatrix<T> &out) override
+	{
+		m_binam.train_mat(in, out);
+		return *this;
+	}
+	BinaryMatrix<T> recallMat(const BinaryMatrix<T> &in,
+	                          ThreadPool *pool) const override
+	{
+		return m_binam.recallMat(in, pool);
+	}
+	std::vector<SampleError> false_bits_mat(const BinaryMatrix<T> &out,
+	                                        const BinaryMatrix<T> &res,
+	                                        ThreadPool *pool) const override
+	{
+		return B::false_bits_mat(out, res, pool);
+	}
+	BinaryMatrix<T> toBinaryMatrix() const override
+	{
+		return m_binam.toBinaryMatrix();
+	}
+};
+
+/**
+ * Creates a FixedBiNAM for the geometry @param outputs x @param inputs if it
+ * is one of @param Sizes, returns nullptr otherwise. The matrix is zero, or a
+ * copy of @param mat if given.
+ */
+template <typename T, typename Sizes = FixedBiNAMSizes>
+std::unique_ptr<AnyFixedBiNAM<T>> make_fixed_binam(
+    size_t outputs, size_t inputs, const BinaryMatrix<T> *mat = nullptr)
+{
+	std::unique_ptr<AnyFixedBiNAM<T>> res;
+	dispatch_fixed_binam<T, Sizes>(outputs, inputs, [&](auto tag) {
+		using Impl = AnyFixedBiNAMImpl<typename decltype(tag)::type, T>;
+		res.reset(mat ? new Impl(*mat) : new Impl());
+	});
+	return res;
+}
+}
+
+#endif /* CPPNAM_CORE_FIXED_BINAM_HPP */
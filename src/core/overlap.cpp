@@ -0,0 +1,280 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "overlap.hpp"
+
+namespace nam {
+
+constexpr size_t PatternOverlap::TILE;
+constexpr size_t PatternOverlap::MAX_EXACT_ONES;
+
+size_t PatternOverlap::Statistics::pairs() const
+{
+	return std::accumulate(histogram.begin(), histogram.end(), size_t(0));
+}
+
+double PatternOverlap::Statistics::mean() const
+{
+	double sum = 0;
+	for (size_t k = 1; k < histogram.size(); k++) {
+		sum += double(k) * histogram[k];
+	}
+	return pairs() ? sum / pairs() : 0.0;
+}
+
+void PatternOverlap::Index::build_columns(size_t cols)
+{
+	col_offs.assign(cols + 1, 0);
+	for (auto j : row_idx) {
+		col_offs[j + 1]++;
+	}
+	std::partial_sum(col_offs.begin(), col_offs.end(), col_offs.begin());
+	col_idx.resize(row_idx.size());
+	std::vector<size_t> pos(col_offs.begin(), col_offs.end() - 1);
+	for (size_t i = 0; i < rows(); i++) {
+		for (size_t k = row_offs[i]; k < row_offs[i + 1]; k++) {
+			col_idx[pos[row_idx[k]]++] = i;
+		}
+	}
+}
+
+void PatternOverlap::Counter::count(const Index &index, size_t q)
+{
+	const size_t stamp = q + 1;
+	m_touched.clear();
+	for (size_t t = 0; t < index.ones(q); t++) {
+		const uint32_t j = index.row_idx[index.row_offs[q] + t];
+		const uint32_t bit = t < 32 ? uint32_t(1) << t : 0;
+		for (size_t k = index.col_offs[j]; k < index.col_offs[j + 1]; k++) {
+			const uint32_t s = index.col_idx[k];
+			if (s == q) {
+				continue;
+			}
+			if (m_stamp[s] != stamp) {
+				m_stamp[s] = stamp;
+				m_count[s] = 0;
+				m_mask[s] = 0;
+				m_touched.push_back(s);
+			}
+			m_count[s]++;
+			m_mask[s] |= bit;
+		}
+	}
+}
+
+void PatternOverlap::check_cols(size_t a, size_t b)
+{
+	if (a != b) {
+		std::stringstream ss;
+		ss << "Patterns of length " << a << " and " << b
+		   << " cannot be compared" << std::endl;
+		throw std::out_of_range(ss.str());
+	}
+}
+
+bool PatternOverlap::sparse_cheaper(const Index &index, size_t words)
+{
+	// One index entry is visited per pair sharing a bit, the dense kernel
+	// reads one word per pair and word
+	double visits = 0;
+	for (size_t j = 0; j < index.cols(); j++) {
+		visits += double(index.usage(j)) * index.usage(j);
+	}
+	const double rows = index.rows();
+	return visits <= rows * rows * std::max<size_t>(words, 1);
+}
+
+void PatternOverlap::merge(Statistics &res, std::vector<size_t> &hist,
+                           size_t duplicates, std::mutex &mutex)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t k = 1; k < hist.size(); k++) {
+		res.histogram[k] += hist[k];
+	}
+	res.duplicates += duplicates;
+
+	// Pairs without common bits are never visited
+	const size_t n = res.max_overlap.size();
+	const size_t pairs = n * (n - 1) / 2;
+	res.histogram[0] = 0;
+	res.histogram[0] = pairs - res.pairs();
+}
+
+void PatternOverlap::statistics_sparse(const Index &index, size_t begin,
+                                       size_t end, Statistics &res,
+                                       std::mutex &mutex)
+{
+	std::vector<size_t> hist(res.histogram.size(), 0);
+	size_t duplicates = 0;
+	Counter counter(index.rows());
+	for (size_t q = begin; q < end; q++) {
+		counter.count(index, q);
+		for (auto s : counter.touched()) {
+			const uint32_t c = counter.count(s);
+			res.max_overlap[q] = std::max(res.max_overlap[q], c);
+			if (s > q) {
+				hist[c]++;
+				duplicates += c == index.ones(q) && c == index.ones(s);
+			}
+		}
+	}
+	merge(res, hist, duplicates, mutex);
+}
+
+double PatternOverlap::miss(size_t n, size_t k, size_t u)
+{
+	// C(n - k, u) / C(n, u)
+	if (k + u > n) {
+		return 0.0;
+	}
+	return std::exp(std::lgamma(n - k + 1.0) - std::lgamma(n - k - u + 1.0) -
+	                std::lgamma(n + 1.0) + std::lgamma(n - u + 1.0));
+}
+
+void PatternOverlap::compact(std::vector<std::pair<uint32_t, double>> &weights)
+{
+	std::sort(weights.begin(), weights.end());
+	size_t n = 0;
+	for (size_t w = 0; w < weights.size(); w++) {
+		if (n > 0 && weights[n - 1].first == weights[w].first) {
+			weights[n - 1].second += weights[w].second;
+		}
+		else {
+			weights[n++] = weights[w];
+		}
+	}
+	weights.resize(n);
+}
+
+void PatternOverlap::predict(const Index &in, const Index &out, size_t begin,
+                             size_t end, std::vector<SampleError> &res)
+{
+	const size_t n = in.rows();
+	if (n < 2) {
+		std::fill(res.begin() + begin, res.begin() + end, SampleError());
+		return;
+	}
+
+	// Output bits grouped by the number of samples activating them, the
+	// outputs of the predicted sample are no candidates
+	std::vector<size_t> group(n + 1, 0);
+	for (size_t i = 0; i < out.cols(); i++) {
+		group[out.usage(i)]++;
+	}
+	std::vector<uint32_t> values;
+	for (size_t u = 0; u <= n; u++) {
+		if (group[u] > 0) {
+			values.push_back(u);
+		}
+	}
+
+	Counter counter(n);
+	std::vector<uint32_t> subsets, exact, independent;
+	std::vector<std::pair<uint32_t, double>> weights;
+	for (size_t q = begin; q < end; q++) {
+		const size_t k = in.ones(q);
+		for (size_t t = out.row_offs[q]; t < out.row_offs[q + 1]; t++) {
+			group[out.usage(out.row_idx[t])]--;
+		}
+
+		// An output bit used by u samples is activated by a random subset of
+		// u of the other n - 1 samples. Inclusion-exclusion over the subsets
+		// A of the input bits gives the probability that all input bits of q
+		// are covered as
+		//     sum_A (-1)^|A| miss(n_A, u),
+		// where n_A is the number of samples sharing a bit of A with q and
+		// miss() the probability that none of them is in the subset. The
+		// terms are collected as weights per n_A. For many input bits, this
+		// is only done for the rarest ones, the others are treated as
+		// independent.
+		exact.clear();
+		for (size_t t = 0; t < std::min<size_t>(k, 32); t++) {
+			exact.push_back(t);
+		}
+		std::sort(exact.begin(), exact.end(), [&](uint32_t a, uint32_t b) {
+			return in.usage(in.row_idx[in.row_offs[q] + a]) <
+			       in.usage(in.row_idx[in.row_offs[q] + b]);
+		});
+		exact.resize(std::min<size_t>(exact.size(), MAX_EXACT_ONES));
+		independent.clear();
+		for (size_t t = 0; t < k; t++) {
+			if (std::find(exact.begin(), exact.end(), t) == exact.end()) {
+				independent.push_back(in.usage(in.row_idx[in.row_offs[q] + t]) -
+				                      1);
+			}
+		}
+
+		counter.count(in, q);
+		const uint32_t full = (uint32_t(1) << exact.size()) - 1;
+		subsets.assign(size_t(full) + 1, 0);
+		for (auto s : counter.touched()) {
+			uint32_t mask = 0;
+			for (size_t e = 0; e < exact.size(); e++) {
+				mask |= ((counter.mask(s) >> exact[e]) & 1) << e;
+			}
+			subsets[mask]++;
+		}
+		// Samples whose mask is a subset of B, for every B
+		for (size_t b = 0; b < exact.size(); b++) {
+			for (uint32_t m = 0; m <= full; m++) {
+				if (m & (uint32_t(1) << b)) {
+					subsets[m] += subsets[m ^ (uint32_t(1) << b)];
+				}
+			}
+		}
+		const uint32_t touched = counter.touched().size();
+		weights.clear();
+		for (uint32_t a = 0; a <= full; a++) {
+			weights.emplace_back(touched - subsets[full & ~a],
+			                     __builtin_popcount(a) % 2 ? -1.0 : 1.0);
+		}
+		compact(weights);
+
+		double fp = 0;
+		for (auto u : values) {
+			if (group[u] == 0 || u == 0) {
+				continue;
+			}
+			double p = 0.0;
+			for (const auto &w : weights) {
+				p += w.second * miss(n - 1, w.first, u);
+			}
+			for (auto c : independent) {
+				p *= 1.0 - miss(n - 1, c, u);
+			}
+			fp += group[u] * std::min(1.0, std::max(0.0, p));
+		}
+		if (k == 0) {
+			// An empty input recalls every output
+			fp = out.cols() - out.ones(q);
+		}
+		res[q] = SampleError(fp, 0);
+
+		for (size_t t = out.row_offs[q]; t < out.row_offs[q + 1]; t++) {
+			group[out.usage(out.row_idx[t])]++;
+		}
+	}
+}
+}
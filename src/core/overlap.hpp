@@ -0,0 +1,349 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_CORE_OVERLAP_HPP
+#define CPPNAM_CORE_OVERLAP_HPP
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core/entropy.hpp"
+#include "util/binary_matrix.hpp"
+#include "util/bitops.hpp"
+#include "util/thread_pool.hpp"
+
+namespace nam {
+
+/**
+ * Analysis of the overlap between the patterns of a data set. The false
+ * positives of a BiNAM are caused by stored samples sharing input bits with
+ * the recalled one, so the pairwise intersections and the usage of every bit
+ * describe the quality of a data set without training and recalling it, see
+ * predict_false_positives(). Useful to compare the settings of the
+ * DataGenerator on large data sets.
+ */
+class PatternOverlap {
+public:
+	/**
+	 * Number of rows of both matrices processed together by the dense
+	 * kernel, see for_each_tile()
+	 */
+	static constexpr size_t TILE = 64;
+
+	/**
+	 * Number of input bits of a sample for which the exact overlap structure
+	 * is evaluated, see predict_false_positives()
+	 */
+	static constexpr size_t MAX_EXACT_ONES = 12;
+
+	/**
+	 * Overlap statistics of the rows of a matrix
+	 */
+	struct Statistics {
+		/**
+		 * Element k is the number of pairs of different rows sharing k bits
+		 */
+		std::vector<size_t> histogram;
+
+		/**
+		 * Largest number of bits every row shares with any other row
+		 */
+		std::vector<uint32_t> max_overlap;
+
+		/**
+		 * Number of pairs of identical rows
+		 */
+		size_t duplicates = 0;
+
+		/**
+		 * Number of pairs and mean number of shared bits per pair
+		 */
+		size_t pairs() const;
+		double mean() const;
+	};
+
+private:
+	/**
+	 * Active bits of every row and the rows using every bit, both in
+	 * compressed row format
+	 */
+	struct Index {
+		std::vector<size_t> row_offs, col_offs;
+		std::vector<uint32_t> row_idx, col_idx;
+
+		template <typename T>
+		explicit Index(const BinaryMatrix<T> &mat)
+		{
+			std::vector<uint32_t> idx;
+			row_offs.push_back(0);
+			for (size_t i = 0; i < mat.rows(); i++) {
+				mat.active_bits(i, idx);
+				row_idx.insert(row_idx.end(), idx.begin(), idx.end());
+				row_offs.push_back(row_idx.size());
+			}
+			build_columns(mat.cols());
+		}
+
+		void build_columns(size_t cols);
+
+		size_t rows() const { return row_offs.size() - 1; }
+		size_t cols() const { return col_offs.size() - 1; }
+		size_t ones(size_t i) const { return row_offs[i + 1] - row_offs[i]; }
+		size_t usage(size_t j) const { return col_offs[j + 1] - col_offs[j]; }
+	};
+
+	/**
+	 * Intersections of one row with all other rows, found with the column
+	 * index. Only rows sharing at least one bit are visited, so the cost is
+	 * the number of such pairs instead of the number of all pairs.
+	 */
+	class Counter {
+	private:
+		std::vector<uint32_t> m_count, m_mask, m_touched;
+		std::vector<size_t> m_stamp;
+
+	public:
+		explicit Counter(size_t rows)
+		    : m_count(rows), m_mask(rows), m_stamp(rows, 0)
+		{
+		}
+
+		/**
+		 * Counts the bits every row of @param index shares with row
+		 * @param q. Bit t of the mask of a row is set if it contains the t-th
+		 * bit of row q, only the first 32 bits of row q are recorded.
+		 */
+		void count(const Index &index, size_t q);
+
+		/**
+		 * Rows sharing at least one bit with row q, except q itself
+		 */
+		const std::vector<uint32_t> &touched() const { return m_touched; }
+		uint32_t count(size_t s) const { return m_count[s]; }
+		uint32_t mask(size_t s) const { return m_mask[s]; }
+	};
+
+	static void check_cols(size_t a, size_t b);
+
+	/**
+	 * Returns true if counting the intersections with the column index is
+	 * cheaper than the dense kernel, given the number of rows using every bit
+	 */
+	static bool sparse_cheaper(const Index &index, size_t words);
+
+	/**
+	 * Processes the rows [@param begin, @param end) of @param a, see
+	 * for_each_tile()
+	 */
+	template <typename T, typename F>
+	static void tiles(const BinaryMatrix<T> &a, const BinaryMatrix<T> &b,
+	                  size_t begin, size_t end, F &f)
+	{
+		const size_t n_cells = BinaryMatrix<T>::numberOfCells(a.cols());
+		std::vector<uint32_t> counts(TILE * TILE);
+		for (size_t i0 = begin; i0 < end; i0 += TILE) {
+			const size_t i1 = std::min(end, i0 + TILE);
+			for (size_t j0 = 0; j0 < b.rows(); j0 += TILE) {
+				const size_t j1 = std::min(b.rows(), j0 + TILE);
+				uint32_t *c = counts.data();
+				for (size_t i = i0; i < i1; i++) {
+					const T *row = a.row_ptr(i);
+					for (size_t j = j0; j < j1; j++) {
+						*c++ = BitOps::popcount_and(row, b.row_ptr(j), n_cells);
+					}
+				}
+				f(i0, i1, j0, j1, counts.data());
+			}
+		}
+	}
+
+	static void merge(Statistics &res, std::vector<size_t> &hist,
+	                  size_t duplicates, std::mutex &mutex);
+
+	static void statistics_sparse(const Index &index, size_t begin,
+	                              size_t end, Statistics &res,
+	                              std::mutex &mutex);
+
+	/**
+	 * Probability that a random subset of @param u of @param n samples
+	 * misses @param k given samples
+	 */
+	static double miss(size_t n, size_t k, size_t u);
+
+	/**
+	 * Sorts @param weights by their first element and sums up the weights of
+	 * equal elements
+	 */
+	static void compact(std::vector<std::pair<uint32_t, double>> &weights);
+
+	static void predict(const Index &in, const Index &out, size_t begin,
+	                    size_t end, std::vector<SampleError> &res);
+
+public:
+	/**
+	 * Number of rows of @param mat in which every bit is set
+	 */
+	template <typename T>
+	static std::vector<uint32_t> usage(const BinaryMatrix<T> &mat)
+	{
+		std::vector<uint32_t> res(mat.cols(), 0), idx;
+		for (size_t i = 0; i < mat.rows(); i++) {
+			mat.active_bits(i, idx);
+			for (auto j : idx) {
+				res[j]++;
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Dense all-pairs kernel: calls @param f(i0, i1, j0, j1, counts) for
+	 * tiles of rows [i0, i1) of @param a and [j0, j1) of @param b, where
+	 * counts[(i - i0) * (j1 - j0) + j - j0] is the number of bits shared by
+	 * row i of a and row j of b. Both tiles stay in the cache while their
+	 * intersections are counted with the SIMD kernels of BitOps. The rows of
+	 * a are split between the threads of @param pool, all tiles of a row are
+	 * passed by the same thread, so @param f may update per-row state without
+	 * locking. Throws std::out_of_range if the matrices have different widths.
+	 */
+	template <typename T, typename F>
+	static void for_each_tile(const BinaryMatrix<T> &a,
+	                          const BinaryMatrix<T> &b, ThreadPool *pool, F f)
+	{
+		check_cols(a.cols(), b.cols());
+		parallel_for(pool, 0, a.rows(), TILE, [&](size_t begin, size_t end) {
+			tiles(a, b, begin, end, f);
+		});
+	}
+
+	/**
+	 * Number of bits shared by all pairs of rows of @param a and @param b,
+	 * element i * b.rows() + j belongs to row i of a and row j of b.
+	 */
+	template <typename T>
+	static std::vector<uint32_t> intersections(const BinaryMatrix<T> &a,
+	                                           const BinaryMatrix<T> &b,
+	                                           ThreadPool *pool = nullptr)
+	{
+		std::vector<uint32_t> res(a.rows() * b.rows());
+		for_each_tile(a, b, pool, [&](size_t i0, size_t i1, size_t j0,
+		                              size_t j1, const uint32_t *counts) {
+			for (size_t i = i0; i < i1; i++) {
+				std::copy(counts + (i - i0) * (j1 - j0),
+				          counts + (i - i0 + 1) * (j1 - j0),
+				          res.begin() + i * b.rows() + j0);
+			}
+		});
+		return res;
+	}
+
+	/**
+	 * Overlap statistics of the rows of @param mat. Sparse patterns are
+	 * compared with an index of the rows using every bit, which only visits
+	 * pairs sharing a bit, dense ones with the kernel of for_each_tile().
+	 */
+	template <typename T>
+	static Statistics statistics(const BinaryMatrix<T> &mat,
+	                             ThreadPool *pool = nullptr)
+	{
+		const Index index(mat);
+		Statistics res;
+		res.histogram.assign(mat.cols() + 1, 0);
+		res.max_overlap.assign(mat.rows(), 0);
+		std::mutex mutex;
+		if (sparse_cheaper(index, (mat.cols() + 63) / 64)) {
+			parallel_for(pool, 0, mat.rows(), 1,
+			             [&](size_t begin, size_t end) {
+				             statistics_sparse(index, begin, end, res, mutex);
+				         });
+		}
+		else {
+			parallel_for(pool, 0, mat.rows(), TILE, [&](size_t begin,
+			                                            size_t end) {
+				std::vector<size_t> hist(mat.cols() + 1, 0);
+				size_t duplicates = 0;
+				auto f = [&](size_t i0, size_t i1, size_t j0, size_t j1,
+				             const uint32_t *counts) {
+					for (size_t i = i0; i < i1; i++) {
+						uint32_t &max_overlap = res.max_overlap[i];
+						for (size_t j = j0; j < j1; j++) {
+							const uint32_t c = *counts++;
+							if (j == i) {
+								continue;
+							}
+							max_overlap = std::max(max_overlap, c);
+							if (j > i && c > 0) {
+								hist[c]++;
+								duplicates += c == index.ones(i) &&
+								              c == index.ones(j);
+							}
+						}
+					}
+				};
+				tiles(mat, mat, begin, end, f);
+				merge(res, hist, duplicates, mutex);
+			});
+		}
+		return res;
+	}
+
+	/**
+	 * Predicts the number of false positives of the exact recall of every
+	 * sample of a BiNAM trained with the inputs @param in and outputs
+	 * @param out. Output bit i of sample q is a false positive if every input
+	 * bit of q is also set in a sample which activates i. The samples sharing
+	 * input bits with q and the input bits they share are taken from the data,
+	 * the samples activating i are assumed to be a random subset of the
+	 * other samples, of the size given by the usage of i. For samples with
+	 * more than MAX_EXACT_ONES input bits the overlap is only evaluated for
+	 * the rarest input bits, the others are treated as independent. The
+	 * false negatives are zero. Throws std::out_of_range if
+	 * the numbers of samples differ.
+	 */
+	template <typename T>
+	static std::vector<SampleError> predict_false_positives(
+	    const BinaryMatrix<T> &in, const BinaryMatrix<T> &out,
+	    ThreadPool *pool = nullptr)
+	{
+		if (in.rows() != out.rows()) {
+			std::stringstream ss;
+			ss << "Number of input samples " << in.rows()
+			   << " differs from the number of output samples " << out.rows()
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		const Index idx_in(in), idx_out(out);
+		std::vector<SampleError> res(in.rows());
+		parallel_for(pool, 0, in.rows(), 1, [&](size_t begin, size_t end) {
+			predict(idx_in, idx_out, begin, end, res);
+		});
+		return res;
+	}
+};
+}
+
+#endif /* CPPNAM_CORE_OVERLAP_HPP */
@@ -28,6 +28,14 @@ DataGenerationParameters::DataGenerationParameters(const cypress::Json &obj,
                                                    bool warn)
 {
 	std::map<std::string, size_t> input = json_to_map<size_t>(obj);
+
+	// Optional, the default is chosen at runtime, so there is no warning
+	auto threads = input.find("threads");
+	if (threads != input.end()) {
+		m_threads = threads->second;
+		input.erase(threads);
+	}
+
 	std::vector<std::string> names = {"seed", "random", "balanced", "unique"};
 	std::vector<size_t> default_vals({0, 1, 1, 1});
 	auto res = read_check<size_t>(input, names, default_vals, warn);
@@ -44,6 +52,14 @@ DataGenerationParameters::DataGenerationParameters(const cypress::Json &obj,
 	if (res[3]) {
 		m_unique = true;
 	}
+
+	// Strings are not part of the numeric parameters above
+	if (obj.find("file_in") != obj.end()) {
+		m_file_in = obj["file_in"].get<std::string>();
+	}
+	if (obj.find("file_out") != obj.end()) {
+		m_file_out = obj["file_out"].get<std::string>();
+	}
 }
 
 DataParameters::DataParameters(const cypress::Json &obj, bool warn)
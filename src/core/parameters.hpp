@@ -33,13 +33,23 @@ private:
 	size_t m_seed;
 	bool m_random, m_balanced, m_unique;
 
+	// Number of threads for training and recall, zero selects the default of
+	// ThreadPool::default_threads()
+	size_t m_threads = 0;
+
+	// Sample files used instead of generated data, see
+	// BiNAM_Container::set_up_from_file()
+	std::string m_file_in = "../data/data_in";
+	std::string m_file_out = "../data/data_out";
+
 public:
 	DataGenerationParameters(size_t seed, bool random, bool balanced,
-	                         bool unique)
+	                         bool unique, size_t threads = 0)
 	    : m_seed(seed),
 	      m_random(random),
 	      m_balanced(balanced),
-	      m_unique(unique){};
+	      m_unique(unique),
+	      m_threads(threads){};
 	DataGenerationParameters(const cypress::Json &obj, bool warn = true);
 	DataGenerationParameters()
 	    : m_seed(0), m_random(true), m_balanced(true), m_unique(true){};
@@ -48,11 +58,17 @@ public:
 	bool random() const { return m_random; }
 	bool balanced() const { return m_balanced; }
 	bool unique() const { return m_unique; }
+	size_t threads() const { return m_threads; }
+	const std::string &file_in() const { return m_file_in; }
+	const std::string &file_out() const { return m_file_out; }
 
 	void seed(size_t seed) { m_seed = seed; }
 	void random(size_t random) { m_random = random; }
 	void balanced(size_t balanced) { m_balanced = balanced; }
 	void unique(size_t unique) { m_unique = unique; }
+	void threads(size_t threads) { m_threads = threads; }
+	void file_in(const std::string &file) { m_file_in = file; }
+	void file_out(const std::string &file) { m_file_out = file; }
 
 	void print(std::ostream &out = std::cout)
 	{
@@ -60,7 +76,10 @@ public:
 		out << "Seed: " << m_seed << std::endl
 		    << "Random: " << m_random << std::endl
 		    << "Balanced: " << m_balanced << std::endl
-		    << "Unique: " << m_unique << std::endl;
+		    << "Unique: " << m_unique << std::endl
+		    << "Threads: " << m_threads << std::endl
+		    << "Input file: " << m_file_in << std::endl
+		    << "Output file: " << m_file_out << std::endl;
 	}
 
 	DataGenerationParameters &set(const std::string name, const size_t value)
@@ -77,6 +96,9 @@ public:
 		else if (name == "unique") {
 			m_unique = value;
 		}
+		else if (name == "threads") {
+			m_threads = value;
+		}
 		else {
 			throw std::invalid_argument("Unknown parameter \"" + name + "\"");
 		}
@@ -195,7 +195,9 @@ void SpikingBinam::evaluate_csv(std::ostream &out)
 	    m_BiNAM_Container->analysis(tmp, m_networkParams.n_samples_recall());
 	out << res_spike.Info << "," << res_theo.Info << ","
 	    << res_spike.Info / res_theo.Info << "," << res_spike.fp << ","
-	    << res_theo.fp << "," << res_spike.fn << "," << res_theo.fn;
+	    << res_theo.fp << "," << res_spike.fn << "," << res_theo.fn << ","
+	    << res_theo.fill << "," << res_theo.synapses << "," << res_theo.max_in
+	    << "," << res_theo.max_out;
 }
 std::pair<ExpResults, ExpResults> SpikingBinam::evaluate_res()
 {
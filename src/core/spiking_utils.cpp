@@ -46,9 +46,14 @@ const NeuronType &SpikingUtils::detect_type(std::string neuron_type_str)
 	throw CypressException("Invalid neuron type \"" + neuron_type_str + "\"");
 }
 
-std::vector<std::vector<Real>> SpikingUtils::build_spike_times(
-    const BinaryMatrix<uint64_t> &input_mat, NetworkParameters &netwParams,
-    int seed)
+namespace {
+/**
+ * Implementation of SpikingUtils::build_spike_times() for dense and sparse
+ * input matrices, both provide get_bit(sample, neuron)
+ */
+template <typename M>
+std::vector<std::vector<Real>> build_spike_times_impl(
+    const M &input_mat, NetworkParameters &netwParams, int seed)
 {
 	// BinaryMatrix<uint64_t> mat = m_BiNAM_Container->input_matrix();
 	size_t n_samples = 0;
@@ -67,7 +72,7 @@ std::vector<std::vector<Real>> SpikingUtils::build_spike_times(
 		for (size_t k = 0; k < netwParams.multiplicity(); k++) {
 			std::vector<Real> vec;
 			for (size_t j = 0; j < n_samples; j++) {  // over all samples
-				auto vec2 = build_spike_train(
+				auto vec2 = SpikingUtils::build_spike_train(
 				    netwParams, input_mat.get_bit(j, i),
 				    netwParams.general_offset() + j * netwParams.time_window(),
 				    seed++);
@@ -78,6 +83,21 @@ std::vector<std::vector<Real>> SpikingUtils::build_spike_times(
 	}
 	return res;
 }
+}
+
+std::vector<std::vector<Real>> SpikingUtils::build_spike_times(
+    const BinaryMatrix<uint64_t> &input_mat, NetworkParameters &netwParams,
+    int seed)
+{
+	return build_spike_times_impl(input_mat, netwParams, seed);
+}
+
+std::vector<std::vector<Real>> SpikingUtils::build_spike_times(
+    const SparsePatternMatrix &input_mat, NetworkParameters &netwParams,
+    int seed)
+{
+	return build_spike_times_impl(input_mat, netwParams, seed);
+}
 
 template <typename T>
 PopulationBase SpikingUtils::add_typed_population(
@@ -117,9 +137,13 @@ BinaryMatrix<uint64_t> SpikingUtils::spikes_to_matrix(
     PopulationBase &popOutput, DataParameters &dataParams,
     NetworkParameters &netwParams)
 {
-	BinaryMatrix<uint64_t> res(dataParams.samples(), dataParams.bits_out());
+	// Collect the output of each neuron as a row and transpose the result
+	// at the end, rows are packed from the spike counts a word at a time
+	BinaryMatrix<uint64_t> res(dataParams.bits_out(), dataParams.samples());
 	size_t multi = netwParams.multiplicity();
-	for (size_t i = 0; i < dataParams.bits_out(); i++) {
+	size_t thresh = netwParams.output_burst_size() * multi;
+	// Spike counts are bytes, a higher threshold is never reached
+	for (size_t i = 0; i < dataParams.bits_out() && thresh <= 255; i++) {
 		Vector<uint8_t> spike_vec(dataParams.samples(), MatrixFlags::ZEROS);
 		for (size_t j = 0; j < multi; j++) {
 			auto spikes = popOutput[i * multi + j].signals().data(0);
@@ -129,12 +153,9 @@ BinaryMatrix<uint64_t> SpikingUtils::spikes_to_matrix(
 				spike_vec[k] += temp_vec[k];
 			}
 		}
-		for (size_t k = 0; k < spike_vec.size(); k++) {
-			if (spike_vec[k] >= netwParams.output_burst_size() * multi) {
-				res.set_bit(k, i);
-			}
-		}
+		res.pack_row(i, spike_vec.begin(), thresh);
 	}
+	res.transpose();
 	return res;
 }
 
@@ -25,6 +25,7 @@
 #include "core/parameters.hpp"
 #include "core/spiking_parameters.hpp"
 #include "util/binary_matrix.hpp"
+#include "util/sparse_pattern_matrix.hpp"
 
 namespace nam {
 
@@ -54,6 +55,9 @@ public:
 	static std::vector<std::vector<cypress::Real>> build_spike_times(
 	    const BinaryMatrix<uint64_t> &input_mat, NetworkParameters &netwParams,
 	    int seed = -1);
+	static std::vector<std::vector<cypress::Real>> build_spike_times(
+	    const SparsePatternMatrix &input_mat, NetworkParameters &netwParams,
+	    int seed = -1);
 
 	/**
 	 * Converts the spike times to an output matrix which can be compared to the
@@ -20,6 +20,8 @@
 
 #include "core/binam.hpp"
 #include "util/data.hpp"
+#include "util/matrix_file.hpp"
+#include "util/pattern_file.hpp"
 
 #include <iomanip>
 
@@ -72,23 +74,17 @@ ExpResults RecBinam::analysis(const BinaryMatrix<uint64_t> &recall_matrix)
 	if (recall_matrix.size() == 0) {
 		recall_mat = &m_recall_rec;
 	}
-	std::vector<SampleError> se = m_binam.false_bits_mat(m_output, *recall_mat);
+	std::vector<SampleError> se = m_binam.false_bits_mat(
+	    m_output, *recall_mat, 0, m_binam.pool().get());
 	double info = entropy_hetero(m_params, se);
 	SampleError sum = BiNAM_Container<uint64_t>::sum_false_bits(se);
-	return ExpResults(info, sum);
+	ExpResults res(info, sum);
+	return m_binam_rec.fill_statistics().annotate(res);
 }
 
 RecBinam &RecBinam::set_up_from_file(bool train_res)
 {
-	size_t height;
-	size_t width;
-	std::fstream ss("../data/data_in", std::fstream::in);
-	ss.read((char *)&width, sizeof(width));
-	ss.read((char *)&height, sizeof(height));
-	m_input = BinaryMatrix<uint64_t>(height, width);
-	ss.read((char *)m_input.cells().data(),
-	        m_input.cells().size() * sizeof(uint64_t));
-	ss.close();
+	m_input = read_pattern_file<uint64_t>(m_datagen.file_in());
 	if (m_input.cols() != m_params.bits_in() ||
 	    m_input.rows() != m_params.samples()) {
 		std::stringstream s;
@@ -98,13 +94,7 @@ RecBinam &RecBinam::set_up_from_file(bool train_res)
 		throw std::out_of_range(s.str());
 	}
 
-	ss.open("../data/data_out", std::fstream::in);
-	ss.read((char *)&width, sizeof(width));
-	ss.read((char *)&height, sizeof(height));
-	m_output = BinaryMatrix<uint64_t>(height, width);
-	ss.read((char *)m_output.cells().data(),
-	        m_output.cells().size() * sizeof(uint64_t));
-	ss.close();
+	m_output = read_pattern_file<uint64_t>(m_datagen.file_out());
 	if (m_output.cols() != m_params.bits_out() ||
 	    m_output.rows() != m_params.samples()) {
 		std::stringstream s;
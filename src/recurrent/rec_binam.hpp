@@ -43,18 +43,27 @@ public:
 	 * corresponds exactly to one realisation of associative memory.
 	 * @param params contains the BiNAM parameters like network size, number of
 	 * samples,...
-	 * @param datagen for the data generation
+	 * @param datagen for the data generation and the number of threads used
+	 * by both BiNAMs
 	 */
 	RecBinam(DataParameters params, DataGenerationParameters datagen)
 	    : m_binam(params.bits_out(), params.bits_in()),
 	      m_binam_rec(params.bits_out(), params.bits_out()),
 	      m_params(params),
-	      m_datagen(datagen){};
+	      m_datagen(datagen)
+	{
+		m_binam.pool(ThreadPool::shared(m_datagen.threads()));
+		m_binam_rec.pool(m_binam.pool());
+	};
 	RecBinam(DataParameters params)
 	    : m_binam(params.bits_out(), params.bits_in()),
 	      m_binam_rec(params.bits_out(), params.bits_out()),
 	      m_params(params),
-	      m_datagen(){};
+	      m_datagen()
+	{
+		m_binam.pool(ThreadPool::shared(m_datagen.threads()));
+		m_binam_rec.pool(m_binam.pool());
+	};
 	RecBinam(){};
 
 	RecBinam &set_up(bool train_res = true, bool recall = true);
@@ -68,7 +77,8 @@ public:
 
 	/**
 	 * Calculate the false positives and negatives as well as the stored
-	 * information.
+	 * information. The fill statistics are those of the recurrent (second
+	 * stage) matrix.
 	 * @param recall_matrix: recalled matrix from experiment. If nothing is
 	 * given, it takes the member recall matrix.
 	 */
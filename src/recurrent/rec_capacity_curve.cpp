@@ -0,0 +1,89 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rec_capacity_curve.hpp"
+
+#include "core/entropy.hpp"
+#include "util/thread_pool.hpp"
+
+namespace nam {
+RecCapacityCurve::RecCapacityCurve(DataParameters params,
+                                   DataGenerationParameters datagen,
+                                   bool train_res)
+    : m_curve(params, datagen), m_train_res(train_res)
+{
+	m_curve.on_recall([this](size_t q, uint32_t i) { recall_bit(q, i); });
+}
+
+void RecCapacityCurve::recall_bit(size_t q, uint32_t i)
+{
+	m_recall.set_bit(q, i);
+	if (m_train_res) {
+		m_bit[0] = i;
+		m_binam_rec.train_idx(m_bit, m_curve.output_bits(q));
+	}
+}
+
+RecCapacityCurve &RecCapacityCurve::set_up()
+{
+	m_curve.set_up();
+	const auto &params = m_curve.params();
+	m_binam_rec = BiNAM<uint64_t>(params.bits_out(), params.bits_out(), true);
+	m_binam_rec.pool(ThreadPool::shared());
+	m_recall = BinaryMatrix<uint64_t>(params.samples(), params.bits_out());
+	return *this;
+}
+
+RecCapacityCurve &RecCapacityCurve::train_until(size_t n)
+{
+	while (m_curve.samples() < n) {
+		const size_t q = m_curve.samples();
+		m_curve.train_until(q + 1);
+		if (!m_train_res) {
+			m_binam_rec.train_idx(m_curve.output_bits(q),
+			                      m_curve.output_bits(q));
+		}
+	}
+	return *this;
+}
+
+ExpResults RecCapacityCurve::analysis_rec() const
+{
+	DataParameters params = m_curve.params();
+	params.samples(samples());
+	auto recall_rec = m_binam_rec.recallMat(m_recall.row_range(0, samples()),
+	                                        params.ones_out());
+	auto se = BiNAM<uint64_t>::false_bits_mat(m_curve.output_matrix(),
+	                                          recall_rec, 0,
+	                                          m_binam_rec.pool().get());
+	ExpResults res(entropy_hetero(params, se),
+	               BiNAM_Container<uint64_t>::sum_false_bits(se));
+	return m_binam_rec.fill_statistics().annotate(res);
+}
+
+std::vector<std::pair<ExpResults, ExpResults>> RecCapacityCurve::run(
+    const std::vector<size_t> &checkpoints)
+{
+	std::vector<std::pair<ExpResults, ExpResults>> res;
+	for (auto n : checkpoints) {
+		train_until(n);
+		res.emplace_back(analysis(), analysis_rec());
+	}
+	return res;
+}
+}
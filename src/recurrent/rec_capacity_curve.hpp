@@ -0,0 +1,102 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_RECURRENT_REC_CAPACITY_CURVE_HPP
+#define CPPNAM_RECURRENT_REC_CAPACITY_CURVE_HPP
+
+#include <vector>
+
+#include "core/binam.hpp"
+#include "core/capacity_curve.hpp"
+#include "core/parameters.hpp"
+
+namespace nam {
+
+/**
+ * Incremental capacity curve of the recurrent BiNAM as set up by
+ * RecBinam::set_up(train_res, true). The first stage is evaluated with
+ * CapacityCurve, its recall matrix is kept up to date through the recall
+ * callback. If @param train_res is set, the second BiNAM is trained with the
+ * recall of the first stage, so every bit switching on in that recall adds
+ * the corresponding synapses. Otherwise it is trained with the output
+ * samples. Both ways only ever add synapses, so nothing is retrained. The
+ * threshold recall of the second stage is evaluated at the checkpoints only.
+ */
+class RecCapacityCurve {
+private:
+	CapacityCurve<uint64_t> m_curve;
+	BiNAM<uint64_t> m_binam_rec;
+	BinaryMatrix<uint64_t> m_recall;
+	bool m_train_res;
+
+	// Single input index passed to train_idx() by recall_bit()
+	std::vector<uint32_t> m_bit = std::vector<uint32_t>(1);
+
+	void recall_bit(size_t q, uint32_t i);
+
+public:
+	RecCapacityCurve(DataParameters params, DataGenerationParameters datagen,
+	                 bool train_res = true);
+	RecCapacityCurve(DataParameters params, bool train_res = true)
+	    : RecCapacityCurve(params, DataGenerationParameters(), train_res){};
+
+	// The recall callback refers to this instance
+	RecCapacityCurve(const RecCapacityCurve &) = delete;
+	RecCapacityCurve &operator=(const RecCapacityCurve &) = delete;
+
+	/**
+	 * Generates the data for the maximum number of samples, see
+	 * CapacityCurve::set_up().
+	 */
+	RecCapacityCurve &set_up();
+
+	/**
+	 * Trains both stages with the samples up to (excluding) sample @param n.
+	 */
+	RecCapacityCurve &train_until(size_t n);
+
+	/**
+	 * Results of the first (non-recurrent) stage for the samples trained so
+	 * far, see CapacityCurve::analysis().
+	 */
+	ExpResults analysis() const { return m_curve.analysis(); }
+
+	/**
+	 * Results of the second stage for the samples trained so far, as
+	 * RecBinam::analysis() would return them, including the fill of the
+	 * recurrent matrix.
+	 */
+	ExpResults analysis_rec() const;
+
+	/**
+	 * Evaluates both stages after training the number of samples given in
+	 * @param checkpoints (ascending), returns a pair of results per
+	 * checkpoint.
+	 */
+	std::vector<std::pair<ExpResults, ExpResults>> run(
+	    const std::vector<size_t> &checkpoints);
+
+	size_t samples() const { return m_curve.samples(); }
+	const CapacityCurve<uint64_t> &curve() const { return m_curve; }
+	const BiNAM<uint64_t> &trained_matrix_rec() const { return m_binam_rec; }
+	const BinaryMatrix<uint64_t> &recall_matrix() const { return m_recall; }
+};
+}
+#endif /* CPPNAM_RECURRENT_REC_CAPACITY_CURVE_HPP */
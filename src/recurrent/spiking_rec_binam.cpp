@@ -249,7 +249,9 @@ void SpikingRecBinam::evaluate_csv(std::ostream &out)
 	ExpResults res_theo = m_recBinam->analysis();
 	out << res_spike.Info << "," << res_theo.Info << ","
 	    << res_spike.Info / res_theo.Info << "," << res_spike.fp << ","
-	    << res_theo.fp << "," << res_spike.fn << "," << res_theo.fn;
+	    << res_theo.fp << "," << res_spike.fn << "," << res_theo.fn << ","
+	    << res_theo.fill << "," << res_theo.synapses << "," << res_theo.max_in
+	    << "," << res_theo.max_out;
 }
 std::pair<ExpResults, ExpResults> SpikingRecBinam::evaluate_res()
 {
@@ -0,0 +1,226 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "aligned_buffer.hpp"
+
+namespace nam {
+
+constexpr size_t AlignedMemory::ALIGNMENT;
+constexpr size_t AlignedMemory::HUGE_PAGE_SIZE;
+constexpr const char *AlignedMemory::ENV_HUGE_PAGES;
+constexpr const char *AlignedMemory::ENV_MAP_DIR;
+
+static size_t env_huge_page_threshold()
+{
+	const char *env = std::getenv(AlignedMemory::ENV_HUGE_PAGES);
+	if (!env || !*env) {
+		return 0;
+	}
+	size_t pos = 0;
+	unsigned long long bytes = 0;
+	try {
+		bytes = std::stoull(env, &pos);
+	}
+	catch (...) {
+		pos = 0;
+	}
+	if (pos == 0 || env[pos] != '\0') {
+		throw std::invalid_argument(std::string("Invalid value \"") + env +
+		                            "\" for " + AlignedMemory::ENV_HUGE_PAGES);
+	}
+	return bytes;
+}
+
+static std::atomic<size_t> &threshold()
+{
+	static std::atomic<size_t> bytes(env_huge_page_threshold());
+	return bytes;
+}
+
+size_t AlignedMemory::huge_page_threshold() { return threshold(); }
+
+void AlignedMemory::huge_page_threshold(size_t bytes) { threshold() = bytes; }
+
+void *AlignedMemory::allocate(size_t bytes)
+{
+	if (bytes == 0) {
+		return nullptr;
+	}
+
+	// Huge page allocations are rounded up to whole huge pages, so the
+	// kernel does not have to fall back to small pages for the tail
+	const size_t huge = huge_page_threshold();
+	const bool use_huge = huge > 0 && bytes >= huge;
+	const size_t align = use_huge ? HUGE_PAGE_SIZE : ALIGNMENT;
+	bytes = ((bytes + align - 1) / align) * align;
+
+	void *ptr = nullptr;
+	if (posix_memalign(&ptr, align, bytes) != 0) {
+		throw std::bad_alloc();
+	}
+#ifdef MADV_HUGEPAGE
+	if (use_huge) {
+		// Only a hint, the memory is usable even if this fails
+		madvise(ptr, bytes, MADV_HUGEPAGE);
+	}
+#endif
+
+	// Zero the memory after madvise(), so the first touch already faults in
+	// huge pages
+	std::memset(ptr, 0, bytes);
+	return ptr;
+}
+
+void AlignedMemory::free(void *ptr) { ::free(ptr); }
+
+static std::runtime_error map_error(const std::string &what,
+                                    const std::string &path)
+{
+	return std::runtime_error(what + " \"" + path +
+	                          "\": " + std::strerror(errno));
+}
+
+/**
+ * Creates and unlinks a temporary file, returns its descriptor
+ */
+static int temp_file()
+{
+	const char *dir = std::getenv(AlignedMemory::ENV_MAP_DIR);
+	if (!dir || !*dir) {
+		dir = std::getenv("TMPDIR");
+	}
+	if (!dir || !*dir) {
+		dir = "/tmp";
+	}
+	std::string name = std::string(dir) + "/cppnam_XXXXXX";
+	std::vector<char> buf(name.begin(), name.end());
+	buf.push_back('\0');
+	const int fd = mkstemp(buf.data());
+	if (fd < 0) {
+		throw map_error("Cannot create temporary file", name);
+	}
+	unlink(buf.data());
+	return fd;
+}
+
+static size_t page_size()
+{
+	static const size_t page = sysconf(_SC_PAGESIZE);
+	return page;
+}
+
+void *AlignedMemory::map(const std::string &path, size_t bytes, size_t offset,
+                         bool shared)
+{
+	if (bytes == 0) {
+		return nullptr;
+	}
+	const int fd =
+	    path.empty()
+	        ? temp_file()
+	        : open(path.c_str(), shared ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+	if (fd < 0) {
+		throw map_error("Cannot open", path);
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw map_error("Cannot stat", path);
+	}
+	const size_t total = offset + bytes;
+	if (st.st_size == 0 && shared) {
+		if (ftruncate(fd, total) != 0) {
+			close(fd);
+			throw map_error("Cannot resize", path);
+		}
+	}
+	else if (size_t(st.st_size) != total) {
+		close(fd);
+		throw std::runtime_error("File \"" + path + "\" has " +
+		                         std::to_string(st.st_size) +
+		                         " bytes, expected " + std::to_string(total));
+	}
+
+	// mmap() only accepts offsets at page boundaries
+	const size_t skip = offset % page_size();
+	void *ptr = mmap(nullptr, bytes + skip, PROT_READ | PROT_WRITE,
+	                 shared ? MAP_SHARED : MAP_PRIVATE, fd, offset - skip);
+	close(fd);  // The mapping keeps the file open
+	if (ptr == MAP_FAILED) {
+		throw map_error("Cannot map", path);
+	}
+	return static_cast<char *>(ptr) + skip;
+}
+
+void AlignedMemory::unmap(void *ptr, size_t bytes)
+{
+	if (ptr) {
+		const size_t skip = uintptr_t(ptr) % page_size();
+		munmap(static_cast<char *>(ptr) - skip, bytes + skip);
+	}
+}
+
+void AlignedMemory::advise(const void *ptr, size_t bytes, Advice advice)
+{
+	const size_t page = page_size();
+	const uintptr_t begin = uintptr_t(ptr) / page * page;
+	const uintptr_t end = uintptr_t(ptr) + bytes;
+	int flag = MADV_NORMAL;
+	switch (advice) {
+		case Advice::NORMAL:
+			flag = MADV_NORMAL;
+			break;
+		case Advice::SEQUENTIAL:
+			flag = MADV_SEQUENTIAL;
+			break;
+		case Advice::RANDOM:
+			flag = MADV_RANDOM;
+			break;
+		case Advice::WILLNEED:
+			flag = MADV_WILLNEED;
+			break;
+		case Advice::DONTNEED:
+			flag = MADV_DONTNEED;
+			break;
+	}
+	madvise(reinterpret_cast<void *>(begin), end - begin, flag);
+}
+
+void AlignedMemory::sync(void *ptr, size_t bytes)
+{
+	if (ptr) {
+		const size_t skip = uintptr_t(ptr) % page_size();
+		msync(static_cast<char *>(ptr) - skip, bytes + skip, MS_SYNC);
+	}
+}
+}
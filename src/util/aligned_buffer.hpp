@@ -0,0 +1,258 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_ALIGNED_BUFFER_HPP
+#define CPPNAM_UTIL_ALIGNED_BUFFER_HPP
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace nam {
+
+/**
+ * Allocation of zero-initialised memory aligned to cache lines. Large blocks
+ * can be backed by transparent huge pages, see huge_page_threshold().
+ */
+struct AlignedMemory {
+	/**
+	 * Alignment of every allocation in bytes (one cache line).
+	 */
+	static constexpr size_t ALIGNMENT = 64;
+
+	/**
+	 * Alignment of allocations backed by huge pages.
+	 */
+	static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+	/**
+	 * Name of the environment variable setting the initial value of
+	 * huge_page_threshold() in bytes.
+	 */
+	static constexpr const char *ENV_HUGE_PAGES = "CPPNAM_HUGE_PAGES";
+
+	/**
+	 * Allocates @param bytes zeroed bytes. Throws std::bad_alloc on failure,
+	 * returns nullptr for zero bytes.
+	 */
+	static void *allocate(size_t bytes);
+
+	/**
+	 * Frees memory returned by allocate().
+	 */
+	static void free(void *ptr);
+
+	/**
+	 * Allocations of at least this many bytes are aligned to huge pages and
+	 * marked with madvise(MADV_HUGEPAGE), so the kernel may back them with
+	 * transparent huge pages. Zero (default) disables huge pages. The default
+	 * may be set with the environment variable CPPNAM_HUGE_PAGES.
+	 */
+	static size_t huge_page_threshold();
+	static void huge_page_threshold(size_t bytes);
+
+	/**
+	 * Name of the environment variable with the directory of the temporary
+	 * files used by map() without a path. Defaults to TMPDIR or /tmp.
+	 */
+	static constexpr const char *ENV_MAP_DIR = "CPPNAM_MAP_DIR";
+
+	/**
+	 * Maps the @param bytes at @param offset of the file @param path into
+	 * memory. Shared mappings (@param shared) write all changes to the file,
+	 * a new or empty file is resized and reads as zeros. Private mappings
+	 * never change the file, pages are only copied once they are written.
+	 * An existing file must have exactly offset + bytes bytes. An empty path
+	 * maps a temporary file, which is deleted right away and only lives as
+	 * long as the mapping. Returns nullptr for zero bytes, throws
+	 * std::runtime_error on failure. The memory is page aligned if the
+	 * offset is.
+	 */
+	static void *map(const std::string &path, size_t bytes, size_t offset = 0,
+	                 bool shared = true);
+
+	/**
+	 * Unmaps memory returned by map().
+	 */
+	static void unmap(void *ptr, size_t bytes);
+
+	/**
+	 * Access hints for mapped memory, see madvise()
+	 */
+	enum class Advice { NORMAL, SEQUENTIAL, RANDOM, WILLNEED, DONTNEED };
+
+	/**
+	 * Passes @param advice for the @param bytes at @param ptr to the kernel.
+	 * The range is extended to whole pages. Only a hint, errors are ignored.
+	 */
+	static void advise(const void *ptr, size_t bytes, Advice advice);
+
+	/**
+	 * Writes the changes of mapped memory back to the file.
+	 */
+	static void sync(void *ptr, size_t bytes);
+};
+
+/**
+ * Owning array of @param T with 64 byte alignment, used as storage of the
+ * BinaryMatrix. All elements are zero after construction. The array either
+ * lives in main memory or is mapped from a file, see map(). Copies are deep
+ * and always live in main memory.
+ */
+template <typename T>
+class AlignedBuffer {
+	static_assert(std::is_trivially_copyable<T>::value,
+	              "AlignedBuffer only supports trivially copyable types");
+
+private:
+	T *m_data = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+	bool m_shared = false;
+
+	void release()
+	{
+		if (m_mapped) {
+			AlignedMemory::unmap(m_data, m_size * sizeof(T));
+		}
+		else {
+			AlignedMemory::free(m_data);
+		}
+	}
+
+public:
+	AlignedBuffer() = default;
+
+	/**
+	 * Allocates @param size zeroed elements.
+	 */
+	explicit AlignedBuffer(size_t size)
+	    : m_data(static_cast<T *>(AlignedMemory::allocate(size * sizeof(T)))),
+	      m_size(size)
+	{
+	}
+
+	AlignedBuffer(const AlignedBuffer<T> &o) : AlignedBuffer(o.m_size)
+	{
+		if (m_size > 0) {
+			std::memcpy(m_data, o.m_data, m_size * sizeof(T));
+		}
+	}
+
+	AlignedBuffer(AlignedBuffer<T> &&o) noexcept
+	    : m_data(o.m_data),
+	      m_size(o.m_size),
+	      m_mapped(o.m_mapped),
+	      m_shared(o.m_shared)
+	{
+		o.m_data = nullptr;
+		o.m_size = 0;
+		o.m_mapped = false;
+		o.m_shared = false;
+	}
+
+	/**
+	 * Maps @param size elements at byte @param offset of the file
+	 * @param path, or of a temporary file if the path is empty, see
+	 * AlignedMemory::map(). The offset should be a multiple of the alignment.
+	 */
+	static AlignedBuffer<T> map(const std::string &path, size_t size,
+	                            size_t offset = 0, bool shared = true)
+	{
+		AlignedBuffer<T> res;
+		res.m_data = static_cast<T *>(
+		    AlignedMemory::map(path, size * sizeof(T), offset, shared));
+		res.m_size = size;
+		res.m_mapped = res.m_data != nullptr;
+		res.m_shared = res.m_mapped && shared;
+		return res;
+	}
+
+	AlignedBuffer<T> &operator=(const AlignedBuffer<T> &o)
+	{
+		if (this != &o) {
+			*this = AlignedBuffer<T>(o);
+		}
+		return *this;
+	}
+
+	AlignedBuffer<T> &operator=(AlignedBuffer<T> &&o) noexcept
+	{
+		std::swap(m_data, o.m_data);
+		std::swap(m_size, o.m_size);
+		std::swap(m_mapped, o.m_mapped);
+		std::swap(m_shared, o.m_shared);
+		return *this;
+	}
+
+	~AlignedBuffer() { release(); }
+
+	/**
+	 * Pointer to the first element, nullptr if the buffer is empty
+	 */
+	T *data() { return m_data; }
+	const T *data() const { return m_data; }
+
+	/**
+	 * Number of elements
+	 */
+	size_t size() const { return m_size; }
+
+	T &operator[](size_t i) { return m_data[i]; }
+	const T &operator[](size_t i) const { return m_data[i]; }
+
+	/**
+	 * Returns true if the buffer is mapped from a file
+	 */
+	bool mapped() const { return m_mapped; }
+
+	/**
+	 * Passes an access hint for the elements [@param first, first +
+	 * @param count) to the kernel, only done for mapped buffers. DONTNEED is
+	 * ignored for private mappings, the kernel would drop changed pages.
+	 */
+	void advise(size_t first, size_t count,
+	            AlignedMemory::Advice advice) const
+	{
+		if (!m_shared && advice == AlignedMemory::Advice::DONTNEED) {
+			return;
+		}
+		if (m_mapped && count > 0) {
+			AlignedMemory::advise(m_data + first, count * sizeof(T), advice);
+		}
+	}
+
+	/**
+	 * Writes a mapped buffer back to its file
+	 */
+	void sync()
+	{
+		if (m_mapped) {
+			AlignedMemory::sync(m_data, m_size * sizeof(T));
+		}
+	}
+};
+}
+
+#endif /* CPPNAM_UTIL_ALIGNED_BUFFER_HPP */
@@ -21,8 +21,10 @@
 #ifndef CPPNAM_UTIL_BINARY_MATRIX_HPP
 #define CPPNAM_UTIL_BINARY_MATRIX_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <string>
 #include <vector>
 
 #ifndef NDBUG
@@ -32,6 +34,12 @@
 
 #include <cypress/util/matrix.hpp>
 
+#include "util/aligned_buffer.hpp"
+#include "util/bit_pack.hpp"
+#include "util/bitops.hpp"
+#include "util/population_count.hpp"
+#include "util/thread_pool.hpp"
+
 namespace nam {
 
 using cypress::Matrix;
@@ -44,6 +52,101 @@ class BinaryMatrix;
 template <typename T>
 class BinaryVector;
 
+/**
+ * Non-owning read-only view onto a row of @param T cells holding a given
+ * number of bits, e.g. a row of a BinaryMatrix. Creating a view does not
+ * allocate or copy anything, the view is only valid as long as the viewed
+ * matrix is neither resized nor destroyed.
+ */
+template <typename T>
+class ConstRowView {
+protected:
+	const T *m_cells;
+	size_t m_size;
+
+public:
+	static constexpr uint32_t intWidth = std::numeric_limits<T>::digits;
+
+	ConstRowView(const T *cells, size_t size) : m_cells(cells), m_size(size)
+	{
+	}
+
+	/**
+	 * Number of bits and of cells of the row
+	 */
+	size_t size() const { return m_size; }
+	size_t numberOfCells() const { return (m_size + intWidth - 1) / intWidth; }
+
+	/**
+	 * Pointer to the first cell
+	 */
+	const T *data() const { return m_cells; }
+
+	T get_cell(size_t i) const { return m_cells[i]; }
+	bool get_bit(size_t i) const
+	{
+		return m_cells[i / intWidth] & (T(1) << (i % intWidth));
+	}
+
+	/**
+	 * Writes the indices of all set bits to @param res in ascending order,
+	 * see BinaryMatrix::active_bits().
+	 */
+	void active_bits(std::vector<uint32_t> &res) const
+	{
+		res.clear();
+		for (size_t j = 0; j < numberOfCells(); j++) {
+			T cell = m_cells[j];
+			while (cell) {
+				res.push_back(j * intWidth + trailing_zeros<T>(cell));
+				cell &= cell - 1;
+			}
+		}
+	}
+};
+
+/**
+ * Non-owning writable view onto a row, see ConstRowView.
+ */
+template <typename T>
+class RowView : public ConstRowView<T> {
+private:
+	using Base = ConstRowView<T>;
+
+public:
+	RowView(T *cells, size_t size) : ConstRowView<T>(cells, size) {}
+
+	T *data() const { return const_cast<T *>(Base::m_cells); }
+
+	void set_cell(size_t i, T value) const { data()[i] = value; }
+	void set_bit(size_t i, bool val = true) const
+	{
+		const T mask = T(1) << (i % Base::intWidth);
+		if (val) {
+			data()[i / Base::intWidth] |= mask;
+		}
+		else {
+			data()[i / Base::intWidth] &= ~mask;
+		}
+	}
+
+	/**
+	 * Sets all bits to zero
+	 */
+	void clear() const
+	{
+		std::fill(data(), data() + Base::numberOfCells(), T(0));
+	}
+
+	/**
+	 * Copies the content of @param other, which must have the same size
+	 */
+	void assign(const ConstRowView<T> &other) const
+	{
+		std::copy(other.data(), other.data() + Base::numberOfCells(), data());
+	}
+};
+
 /**
  * Matrix class which is used for the BiNAM and storage of patterns.
  * Rows are stored in integer types, which are given as template type.
@@ -65,6 +168,14 @@ public:
 	 */
 	static constexpr T intMax = std::numeric_limits<T>::max();
 
+	/**
+	 * Number of cells in a cache line
+	 */
+	static constexpr size_t cellsPerLine =
+	    sizeof(T) < AlignedMemory::ALIGNMENT
+	        ? AlignedMemory::ALIGNMENT / sizeof(T)
+	        : 1;
+
 	/**
 	 * Calculates the number of IntType instances needed to represent n bits.
 	 *
@@ -83,32 +194,190 @@ public:
 		return int(n / intWidth);
 	};
 
+	/**
+	 * Number of cells between the beginning of two rows for @param n bits.
+	 * Rows are padded to whole cache lines, so every row starts at a 64 byte
+	 * boundary and can be processed with aligned SIMD loads. The padding is
+	 * always zero.
+	 */
+	static constexpr size_t rowStride(uint32_t n)
+	{
+		return ((numberOfCells(n) + cellsPerLine - 1) / cellsPerLine) *
+		       cellsPerLine;
+	};
+
 private:
 	/**
-	* Shared pointer referencing the memory, used for the copy on write
-	* behaviour.
-	*/
-	Matrix<T> m_mat;
+	 * Cells of all rows, every row starts at a multiple of m_stride.
+	 */
+	AlignedBuffer<T> m_mat;
 
 	/**
 	 * Number of rows and number of columns.
 	 */
 	size_t m_rows, m_cols;
 
+	/**
+	 * Number of cells per row including the padding
+	 */
+	size_t m_stride;
+
+	/**
+	 * Number of cells in a 64 bit word and of 64 bit words in a cell
+	 */
+	static constexpr size_t cellsPerWord = intWidth < 64 ? 64 / intWidth : 1;
+	static constexpr size_t wordsPerCell = intWidth > 64 ? intWidth / 64 : 1;
+
+	/**
+	 * Reads and writes the bits [64 * w, 64 * w + 64) of row @param row. As
+	 * rows are padded to whole cache lines, the words never exceed the row.
+	 */
+	uint64_t load_word(size_t row, size_t w) const
+	{
+		const T *p = row_ptr(row);
+		if (intWidth >= 64) {
+			return uint64_t(p[w / wordsPerCell] >>
+			                (64 * (w % wordsPerCell) % intWidth));
+		}
+		uint64_t res = 0;
+		for (size_t i = 0; i < cellsPerWord; i++) {
+			res |= uint64_t(p[w * cellsPerWord + i]) << (i * intWidth % 64);
+		}
+		return res;
+	}
+
+	void store_word(size_t row, size_t w, uint64_t v)
+	{
+		T *p = row_ptr(row);
+		if (intWidth >= 64) {
+			const size_t shift = 64 * (w % wordsPerCell) % intWidth;
+			T &c = p[w / wordsPerCell];
+			c = T(c & ~(T(~uint64_t(0)) << shift)) | T(T(v) << shift);
+			return;
+		}
+		for (size_t i = 0; i < cellsPerWord; i++) {
+			p[w * cellsPerWord + i] = T(v >> (i * intWidth % 64));
+		}
+	}
+
+	/**
+	 * Loads the 64 x 64 bit block starting at row 64 * @param rb and column
+	 * 64 * @param cb, rows outside of the matrix are zero.
+	 */
+	void load_block(size_t rb, size_t cb, uint64_t block[64]) const
+	{
+		for (size_t r = 0; r < 64; r++) {
+			block[r] = rb * 64 + r < m_rows ? load_word(rb * 64 + r, cb) : 0;
+		}
+	}
+
+	void store_block(size_t rb, size_t cb, const uint64_t block[64])
+	{
+		for (size_t r = 0; r < 64 && rb * 64 + r < m_rows; r++) {
+			store_word(rb * 64 + r, cb, block[r]);
+		}
+	}
+
+	T &cell(size_t row, size_t col) { return m_mat[row * m_stride + col]; }
+	const T &cell(size_t row, size_t col) const
+	{
+		return m_mat[row * m_stride + col];
+	}
+
+	BinaryMatrix(AlignedBuffer<T> &&mat, uint32_t rows, uint32_t cols)
+	    : m_mat(std::move(mat)),
+	      m_rows(rows),
+	      m_cols(cols),
+	      m_stride(rowStride(cols))
+	{
+	}
+
 public:
+	/**
+	 * Approximate number of bytes of source rows transposed() processes at
+	 * once. Mapped matrices release each band before reading the next one.
+	 */
+	static constexpr size_t TRANSPOSE_BAND_BYTES = size_t(64) << 20;
+
 	/**
 	 * Default constructor. Creates an empty matrix.
 	 */
-	BinaryMatrix() : m_rows(0), m_cols(0){};
+	BinaryMatrix() : m_rows(0), m_cols(0), m_stride(0){};
 
 	/**
 	 * Initialiser with zeros.
 	 */
-	BinaryMatrix(uint32_t rows, uint32_t cols) : m_rows(rows), m_cols(cols)
-	{
-		m_mat = Matrix<T>(rows, numberOfCells(cols), MatrixFlags::ZEROS);
-	};
+	BinaryMatrix(uint32_t rows, uint32_t cols)
+	    : m_mat(size_t(rows) * rowStride(cols)),
+	      m_rows(rows),
+	      m_cols(cols),
+	      m_stride(rowStride(cols)){};
+	BinaryMatrix(const BinaryMatrix<T> &) = default;
+	BinaryMatrix(BinaryMatrix<T> &&) = default;
+	BinaryMatrix<T> &operator=(const BinaryMatrix<T> &) = default;
+	BinaryMatrix<T> &operator=(BinaryMatrix<T> &&) = default;
     ~BinaryMatrix() = default;
+
+	/**
+	 * Creates a matrix whose storage is mapped from the file @param path, so
+	 * it may be larger than main memory and persists after the matrix is
+	 * destroyed. A new or empty file yields a zero matrix, an existing file
+	 * must have the size of a rows x cols matrix. Throws std::runtime_error
+	 * otherwise. The file holds the raw rows including their padding, it is
+	 * not portable between machines, see MatrixFile for a checked format.
+	 * The rows may start at byte @param offset of the file, which should be a
+	 * multiple of 64. If @param shared is false, the file is only read and
+	 * changes of the matrix stay in memory.
+	 */
+	static BinaryMatrix<T> mapped(const std::string &path, uint32_t rows,
+	                              uint32_t cols, size_t offset = 0,
+	                              bool shared = true)
+	{
+		return BinaryMatrix<T>(
+		    AlignedBuffer<T>::map(path, size_t(rows) * rowStride(cols), offset,
+		                          shared),
+		    rows, cols);
+	}
+
+	/**
+	 * Creates a zero matrix mapped from a temporary file, see
+	 * AlignedMemory::ENV_MAP_DIR.
+	 */
+	static BinaryMatrix<T> mapped(uint32_t rows, uint32_t cols)
+	{
+		return mapped(std::string(), rows, cols);
+	}
+
+	/**
+	 * Returns true if the storage is mapped from a file
+	 */
+	bool mapped() const { return m_mat.mapped(); }
+
+	/**
+	 * Creates a zero matrix of the given size with the same kind of storage,
+	 * i.e. mapped from a temporary file if this matrix is mapped.
+	 */
+	BinaryMatrix<T> similar(uint32_t rows, uint32_t cols) const
+	{
+		return mapped() ? mapped(rows, cols) : BinaryMatrix<T>(rows, cols);
+	}
+
+	/**
+	 * Passes an access hint for the rows [@param begin, @param end) to the
+	 * kernel. Does nothing if the matrix is not mapped.
+	 */
+	void advise_rows(size_t begin, size_t end,
+	                 AlignedMemory::Advice advice) const
+	{
+		if (end > begin) {
+			m_mat.advise(begin * m_stride, (end - begin) * m_stride, advice);
+		}
+	}
+
+	/**
+	 * Writes the content of a mapped matrix back to its file
+	 */
+	void sync() { m_mat.sync(); }
 #ifndef NDEBUG
 	/**
 	 * Check if bit-numbers are in range of matrix to avoid overflows
@@ -136,11 +405,27 @@ public:
 			throw std::out_of_range(ss.str());
 		}
 	}
+	/**
+	 * Check if a row number is in range of the matrix
+	 */
+	void check_row(size_t row) const
+	{
+		if (row >= m_rows) {
+			std::stringstream ss;
+			ss << "Row " << row << " out of range for matrix with " << m_rows
+			   << " rows" << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
 #else
 	/**
 	 * Check if bit-numbers are in range of matrix to avoid overflows
 	 */
 	void check_range(uint32_t, uint32_t) const {}
+	/**
+	 * Check if a row number is in range of the matrix
+	 */
+	void check_row(size_t) const {}
 	/**
 	 * Check if cell-numbers are in range of matrix to avoid overflows
 	 */
@@ -154,7 +439,7 @@ public:
 	{
 		check_range(row, col);
 		uint32_t m = col % intWidth;
-		return m_mat(row, cellNumber(col)) & (T(1) << m);
+		return cell(row, cellNumber(col)) & (T(1) << m);
 	}
 
 	/**
@@ -165,10 +450,10 @@ public:
 		check_range(row, col);
 		uint32_t m = col % intWidth;
 		if (val) {
-			m_mat(row, cellNumber(col)) |= (T(1) << m);
+			cell(row, cellNumber(col)) |= (T(1) << m);
 		}
 		else {
-			m_mat(row, cellNumber(col)) &= ~(T(1) << m);
+			cell(row, cellNumber(col)) &= ~(T(1) << m);
 		}
 		return *this;
 	}
@@ -179,7 +464,7 @@ public:
 	T get_cell(uint32_t row, uint32_t col) const
 	{
 		check_range_cells(row, col);
-		return m_mat(row, col);
+		return cell(row, col);
 	}
 
 	/**
@@ -188,14 +473,25 @@ public:
 	BinaryMatrix<T> &set_cell(uint32_t row, uint32_t col, T value)
 	{
 		check_range_cells(row, col);
-		m_mat(row, col) = value;
+		cell(row, col) = value;
 		return *this;
 	}
 
 	/**
-	 * Return data matrix
+	 * Pointer to the cells of row @param row. The row is aligned to 64 bytes
+	 * and followed by stride() - numberOfCells(cols()) zero cells, which must
+	 * stay zero.
 	 */
-	Matrix<T> &cells() { return m_mat; }
+	T *row_ptr(size_t row) { return m_mat.data() + row * m_stride; }
+	const T *row_ptr(size_t row) const
+	{
+		return m_mat.data() + row * m_stride;
+	}
+
+	/**
+	 * Number of cells between the beginning of two rows
+	 */
+	size_t stride() const { return m_stride; }
 
 	/**
 	 * Give out matrix sizes
@@ -210,18 +506,173 @@ public:
 	BinaryVector<T> row_vec(size_t i) const
 	{
 		BinaryVector<T> vec(m_cols);
+		row_vec_into(i, vec);
+		return vec;
+	}
+
+	/**
+	 * Copies row @param i into @param vec, which is only reallocated if its
+	 * size does not match the number of columns.
+	 */
+	void row_vec_into(size_t i, BinaryVector<T> &vec) const
+	{
+		check_row(i);
+		if (vec.size() != m_cols) {
+			vec = BinaryVector<T>(m_cols);
+		}
+		vec.row(0).assign(row(i));
+	}
+
+	/**
+	 * Views onto row @param i without copying, see RowView
+	 */
+	ConstRowView<T> row(size_t i) const
+	{
+		check_row(i);
+		return ConstRowView<T>(row_ptr(i), m_cols);
+	}
+	RowView<T> row(size_t i)
+	{
+		check_row(i);
+		return RowView<T>(row_ptr(i), m_cols);
+	}
+
+	/**
+	 * Copies the rows [@param begin, @param end) into a new matrix, e.g. to
+	 * partition a matrix of samples.
+	 */
+	BinaryMatrix<T> row_range(size_t begin, size_t end) const
+	{
+		if (begin > end || end > m_rows) {
+			std::stringstream ss;
+			ss << "Rows [" << begin << ", " << end
+			   << ") out of range for matrix with " << m_rows << " rows"
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		BinaryMatrix<T> res(end - begin, m_cols);
+		if (res.m_mat.size() > 0) {
+			std::copy(row_ptr(begin), row_ptr(end), res.m_mat.data());
+		}
+		return res;
+	}
+
+	/**
+	 * Bit-wise OR of the rows [@param begin, @param end) of @param other into
+	 * the same rows of this matrix. Both matrices must have the same size.
+	 */
+	BinaryMatrix<T> &or_rows(const BinaryMatrix<T> &other, size_t begin,
+	                         size_t end)
+	{
+		if (other.m_rows != m_rows || other.m_cols != m_cols ||
+		    end > m_rows) {
+			std::stringstream ss;
+			ss << "Cannot merge matrix of size " << other.m_rows << " x "
+			   << other.m_cols << " into matrix of size " << m_rows << " x "
+			   << m_cols << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		const size_t n_cells = numberOfCells(m_cols);
+		for (size_t i = begin; i < end && n_cells > 0; i++) {
+			BitOps::bit_or(row_ptr(i), row_ptr(i), other.row_ptr(i), n_cells);
+		}
+		return *this;
+	}
+
+	/**
+	 * Bit-wise OR of a whole matrix of the same size
+	 */
+	BinaryMatrix<T> &operator|=(const BinaryMatrix<T> &other)
+	{
+		return or_rows(other, 0, m_rows);
+	}
+
+	/**
+	 * Writes the matrix to @param os in the raw format of the data files: the
+	 * number of columns and rows as size_t, followed by the cells row-wise.
+	 * The padding of the rows is not written.
+	 */
+	void write(std::ostream &os) const
+	{
+		size_t width = m_cols, height = m_rows;
+		os.write((const char *)&width, sizeof(width));
+		os.write((const char *)&height, sizeof(height));
+		for (size_t i = 0; i < m_rows; i++) {
+			os.write((const char *)row_ptr(i),
+			         numberOfCells(m_cols) * sizeof(T));
+		}
+	}
+
+	/**
+	 * Reads a matrix in the format of write() from @param is. Throws if the
+	 * stream ends early.
+	 */
+	static BinaryMatrix<T> read(std::istream &is)
+	{
+		size_t width = 0, height = 0;
+		is.read((char *)&width, sizeof(width));
+		is.read((char *)&height, sizeof(height));
+		BinaryMatrix<T> res(height, width);
+		for (size_t i = 0; i < height && is; i++) {
+			is.read((char *)res.row_ptr(i), numberOfCells(width) * sizeof(T));
+		}
+		if (!is) {
+			throw std::runtime_error("Unexpected end of binary matrix data");
+		}
+		return res;
+	}
+
+	/**
+	 * Writes the column indices of all bits set in row @param row to
+	 * @param res in ascending order. The vector is cleared first, its
+	 * capacity is reused, so no allocation takes place once it is large
+	 * enough.
+	 */
+	void active_bits(size_t row, std::vector<uint32_t> &res) const
+	{
+		res.clear();
 		for (size_t j = 0; j < numberOfCells(m_cols); j++) {
+			T cell = get_cell(row, j);
+			while (cell) {
+				res.push_back(j * intWidth + trailing_zeros<T>(cell));
+				cell &= cell - 1;
+			}
+		}
+	}
 
-			vec.set_cell(j, get_cell(i, j));
+	/**
+	 * Like active_bits(), but only collects the bits set in the columns
+	 * [@param begin, @param end) of row @param row.
+	 */
+	void active_bits(size_t row, size_t begin, size_t end,
+	                 std::vector<uint32_t> &res) const
+	{
+		res.clear();
+		if (end > m_cols) {
+			end = m_cols;
+		}
+		for (size_t j = begin / intWidth; begin < end && j < numberOfCells(end);
+		     j++) {
+			T cell = get_cell(row, j);
+			if (j == begin / intWidth) {
+				cell &= T(intMax << (begin % intWidth));
+			}
+			while (cell) {
+				size_t idx = j * intWidth + trailing_zeros<T>(cell);
+				if (idx >= end) {
+					break;
+				}
+				res.push_back(idx);
+				cell &= cell - 1;
+			}
 		}
-		return vec;
 	}
 
 	/**
 	 * Write a whole row from @param vector.
 	 * Checks if dimension of vector and matrix are the same.
 	 */
-	void write_vec(size_t row, BinaryVector<T> vec)
+	void write_vec(size_t row, const BinaryVector<T> &vec)
 	{
 		if (row >= m_rows || m_cols != vec.size()) {
 			std::stringstream ss;
@@ -233,11 +684,81 @@ public:
 		check_range(m_rows - 1, vec.size() - 1);
 		vec.check_range(0, m_cols - 1);
 		for (size_t i = 0; i < numberOfCells(vec.size()); i++) {
-			m_mat(row, i) = vec.get_cell(i);
+			cell(row, i) = vec.get_cell(i);
+		}
+	}
+
+	/**
+	 * Returns the transposed matrix with the same kind of storage. The matrix
+	 * is processed in blocks of 64 x 64 bits, which are transposed in
+	 * registers, see BitOps::transpose64(). Blocks are visited in bands of
+	 * rows of about TRANSPOSE_BAND_BYTES, so mapped matrices only need one
+	 * band of the source in memory. The columns of blocks of a band are
+	 * distributed onto @param pool if given.
+	 */
+	BinaryMatrix<T> transposed(ThreadPool *pool = nullptr) const
+	{
+		using Advice = AlignedMemory::Advice;
+		BinaryMatrix<T> res = similar(m_cols, m_rows);
+		const size_t n_row_blocks = (m_rows + 63) / 64;
+		const size_t band = std::max<size_t>(
+		    1, TRANSPOSE_BAND_BYTES / (64 * std::max<size_t>(1, m_stride) *
+		                               sizeof(T)));
+		for (size_t rb0 = 0; rb0 < n_row_blocks; rb0 += band) {
+			const size_t rb1 = std::min(n_row_blocks, rb0 + band);
+			const size_t row0 = rb0 * 64, row1 = std::min(m_rows, rb1 * 64);
+			advise_rows(row0, row1, Advice::WILLNEED);
+			auto transpose_blocks = [&](size_t begin, size_t end) {
+				uint64_t block[64];
+				for (size_t cb = begin; cb < end; cb++) {
+					for (size_t rb = rb0; rb < rb1; rb++) {
+						load_block(rb, cb, block);
+						BitOps::transpose64(block);
+						res.store_block(cb, rb, block);
+					}
+				}
+			};
+			parallel_for(pool, 0, (m_cols + 63) / 64, 1, transpose_blocks);
+			advise_rows(row0, row1, Advice::DONTNEED);
+		}
+		return res;
+	}
+
+	/**
+	 * Transposes the matrix. Square matrices are transposed in place by
+	 * swapping mirrored blocks, otherwise the storage changes its shape and
+	 * transposed() is used.
+	 */
+	BinaryMatrix<T> &transpose(ThreadPool *pool = nullptr)
+	{
+		if (m_rows != m_cols) {
+			*this = transposed(pool);
+			return *this;
 		}
+		const size_t n_blocks = (m_rows + 63) / 64;
+		uint64_t a[64], b[64];
+		for (size_t rb = 0; rb < n_blocks; rb++) {
+			for (size_t cb = rb; cb < n_blocks; cb++) {
+				load_block(rb, cb, a);
+				BitOps::transpose64(a);
+				if (cb == rb) {
+					store_block(rb, cb, a);
+					continue;
+				}
+				load_block(cb, rb, b);
+				BitOps::transpose64(b);
+				store_block(cb, rb, a);
+				store_block(rb, cb, b);
+			}
+		}
+		return *this;
 	}
 
-	void write_col_vec(size_t col, Vector<uint8_t> vec)
+	/**
+	 * Sets the bits of column @param col in all rows where @param vec is
+	 * non-zero. Bits not set in vec are left untouched.
+	 */
+	void write_col_vec(size_t col, const Vector<uint8_t> &vec)
 	{
 		if (col >= m_cols || m_rows != vec.size()) {
 			std::stringstream ss;
@@ -246,24 +767,80 @@ public:
 			   << std::endl;
 			throw std::out_of_range(ss.str());
 		}
-		check_range(vec.size() - 1, col);
-		for (size_t i = 0; i < vec.size(); i++) {
-			if (vec(i) > 0) {
-				set_bit(i, col);
+		const size_t c = col / intWidth;
+		const T mask = T(1) << (col % intWidth);
+		for (size_t i = 0; i < m_rows; i++) {
+			cell(i, c) |= vec(i) > 0 ? mask : T(0);
+		}
+	}
+
+	/**
+	 * Sets the bits of row @param row listed in @param idx, e.g. the result
+	 * of active_bits(). Bits not listed are left untouched.
+	 */
+	void write_idx(size_t row, const std::vector<uint32_t> &idx)
+	{
+		check_row(row);
+		T *p = row_ptr(row);
+		for (uint32_t i : idx) {
+			if (i >= m_cols) {
+				std::stringstream ss;
+				ss << "Index " << i << " out of bounds of " << m_cols
+				   << std::endl;
+				throw std::out_of_range(ss.str());
 			}
+			p[i / intWidth] |= T(1) << (i % intWidth);
+		}
+	}
+
+	/**
+	 * Overwrites row @param row with the cols() bytes at @param src, a bit is
+	 * set if the byte is at least @param thresh. See BitPack::pack64().
+	 */
+	void pack_row(size_t row, const uint8_t *src, uint8_t thresh = 1)
+	{
+		check_row(row);
+		for (size_t w = 0; w * 64 < m_cols; w++) {
+			const size_t n = std::min<size_t>(64, m_cols - w * 64);
+			store_word(row, w, BitPack::pack64(src + w * 64, n, thresh));
+		}
+	}
+
+	/**
+	 * Writes row @param row to the cols() bytes at @param dst, one byte (0 or
+	 * 1) per bit.
+	 */
+	void unpack_row(size_t row, uint8_t *dst) const
+	{
+		check_row(row);
+		for (size_t w = 0; w * 64 < m_cols; w++) {
+			const size_t n = std::min<size_t>(64, m_cols - w * 64);
+			BitPack::unpack64(load_word(row, w), n, dst + w * 64);
 		}
 	}
 
+	/**
+	 * Builds a BinaryMatrix from a 'normal' matrix, entries of at least
+	 * @param thresh are set.
+	 */
+	static BinaryMatrix<T> fromMatrix(const Matrix<uint8_t> &mat,
+	                                  uint8_t thresh = 1)
+	{
+		BinaryMatrix<T> res(mat.rows(), mat.cols());
+		for (size_t i = 0; i < res.m_rows; i++) {
+			res.pack_row(i, mat.begin() + i * res.m_cols, thresh);
+		}
+		return res;
+	}
+
 	/**
 	 * Gives back a 'normal' matrix
 	 */
-	Matrix<uint8_t> convertToMatrix()
+	Matrix<uint8_t> convertToMatrix() const
 	{
 		Matrix<uint8_t> mat(m_rows, m_cols);
 		for (size_t i = 0; i < m_rows; i++) {
-			for (size_t j = 0; j < m_cols; j++) {
-				mat(i, j) = int(get_bit(i, j));
-			}
+			unpack_row(i, mat.begin() + i * m_cols);
 		}
 		return mat;
 	}
@@ -273,10 +850,13 @@ public:
 	 */
 	void print(std::ostream& ofs = std::cout) const
 	{
+		std::vector<uint8_t> line(m_cols);
 		for (size_t i = 0; i < m_rows; i++) {
-			for (size_t j = 0; j < m_cols; j++) {
-				ofs << int(get_bit(i, j));
+			unpack_row(i, line.data());
+			for (uint8_t &c : line) {
+				c += '0';
 			}
+			ofs.write(reinterpret_cast<const char *>(line.data()), m_cols);
 			ofs << "\n";
 		}
 		ofs << std::endl;
@@ -313,7 +893,7 @@ public:
 	/**
 	 * Component-wise multiplication of two vectors. NOT a scalar-product
 	 */
-	BinaryVector<T> VectorMult(BinaryVector<T> b)
+	BinaryVector<T> VectorMult(const BinaryVector<T> &b) const
 	{
 		if (Base::size() != b.size()) {
 			std::stringstream ss;
@@ -322,11 +902,26 @@ public:
 			throw std::out_of_range(ss.str());
 		}
 		BinaryVector<T> vec(Base::size());
-		for (size_t i = 0; i < Base::numberOfCells(Base::size()); i++) {
-			vec.set_cell(i, Base::get_cell(0, i) & b.get_cell(i));
-		}
+		VectorMult_into(b, vec);
 		return vec;
 	}
+
+	/**
+	 * Component-wise multiplication written to @param res, which must have
+	 * the same size as both vectors
+	 */
+	void VectorMult_into(const BinaryVector<T> &b, BinaryVector<T> &res) const
+	{
+		if (Base::size() != b.size() || Base::size() != res.size()) {
+			std::stringstream ss;
+			ss << "Vector-multiplication with dimensions:" << Base::size()
+			   << ", " << b.size() << " and " << res.size()
+			   << "not possible!" << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		BitOps::bit_and(res.row_ptr(0), Base::row_ptr(0), b.row_ptr(0),
+		                Base::numberOfCells(Base::size()));
+	}
 };
 
 /**
@@ -337,6 +932,18 @@ constexpr T BinaryMatrix<T>::intMax;
 
 template <typename T>
 constexpr uint32_t BinaryMatrix<T>::intWidth;
+
+template <typename T>
+constexpr size_t BinaryMatrix<T>::cellsPerLine;
+
+template <typename T>
+constexpr size_t BinaryMatrix<T>::cellsPerWord;
+
+template <typename T>
+constexpr size_t BinaryMatrix<T>::wordsPerCell;
+
+template <typename T>
+constexpr uint32_t ConstRowView<T>::intWidth;
 }
 
 #endif /* CPPNAM_UTIL_BINARY_MATRIX_HPP */
@@ -0,0 +1,96 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_BIT_PACK_HPP
+#define CPPNAM_UTIL_BIT_PACK_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace nam {
+
+/**
+ * Conversion between packed bits (64 bit words, least significant bit
+ * first) and one byte per bit, as used by dense matrices and spike counts.
+ * Packing compares 16 bytes at once with SSE2, which every x86-64 CPU has,
+ * unpacking spreads the bits of a byte onto 8 bytes with a multiplication.
+ */
+struct BitPack {
+	/**
+	 * Packs the @param n <= 64 bytes at @param src into a word, bit i is set
+	 * if src[i] >= @param thresh (default: if it is non-zero).
+	 */
+	static uint64_t pack64(const uint8_t *src, size_t n, uint8_t thresh = 1)
+	{
+		uint64_t res = 0;
+		size_t i = 0;
+#ifdef __SSE2__
+		const __m128i t = _mm_set1_epi8(char(thresh));
+		for (; i + 16 <= n; i += 16) {
+			const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			const __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(v, t), v);
+			res |= uint64_t(uint16_t(_mm_movemask_epi8(ge))) << i;
+		}
+#endif
+		for (; i < n; i++) {
+			res |= uint64_t(src[i] >= thresh) << i;
+		}
+		return res;
+	}
+
+	/**
+	 * Writes the lowest @param n <= 64 bits of @param word to @param dst, one
+	 * byte (0 or 1) per bit.
+	 */
+	static void unpack64(uint64_t word, size_t n, uint8_t *dst)
+	{
+		size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		for (; i + 8 <= n; i += 8) {
+			const uint64_t v = spread8(uint8_t(word >> i));
+			std::memcpy(dst + i, &v, sizeof(v));
+		}
+#endif
+		for (; i < n; i++) {
+			dst[i] = (word >> i) & 1;
+		}
+	}
+
+	/**
+	 * Spreads the bits of @param b onto the bytes of a word: byte k is bit k
+	 * of b. Every byte of the product holds b masked to bit k, adding 0x7F
+	 * moves any set bit into the top bit of the byte without carry.
+	 */
+	static uint64_t spread8(uint8_t b)
+	{
+		const uint64_t x =
+		    (b * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+		return ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+	}
+};
+}
+
+#endif /* CPPNAM_UTIL_BIT_PACK_HPP */
@@ -0,0 +1,126 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_BIT_SLICED_COUNTER_HPP
+#define CPPNAM_UTIL_BIT_SLICED_COUNTER_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace nam {
+
+/**
+ * Vertical counter which counts for every bit ("lane") of the integer type W
+ * how often it was set in the words added to the counter. The counts are
+ * stored bit-sliced: plane k holds bit k of the counts of all lanes, so a
+ * single add() updates all lanes at once with a ripple-carry addition over the
+ * planes and the comparison against a threshold is a bit-sliced comparison.
+ * The counter does not allocate any memory.
+ */
+template <typename W>
+class BitSlicedCounter {
+public:
+	/**
+	 * Maximum number of planes, limits the count per lane to 2^MAX_PLANES - 1
+	 */
+	static constexpr size_t MAX_PLANES = 32;
+
+private:
+	W m_planes[MAX_PLANES];
+	size_t m_n_planes = 0;
+
+public:
+	BitSlicedCounter() = default;
+
+	/**
+	 * Resets all counts to zero.
+	 */
+	void reset() { m_n_planes = 0; }
+
+	/**
+	 * Number of planes currently in use.
+	 */
+	size_t planes() const { return m_n_planes; }
+
+	/**
+	 * Returns plane @param k, i.e. the k-th bit of the counts of all lanes.
+	 */
+	W plane(size_t k) const { return k < m_n_planes ? m_planes[k] : W(0); }
+
+	/**
+	 * Increments the count of all lanes set in @param x by one.
+	 */
+	void add(W x)
+	{
+		for (size_t k = 0; k < m_n_planes && x; k++) {
+			W carry = m_planes[k] & x;
+			m_planes[k] ^= x;
+			x = carry;
+		}
+		if (x) {
+			if (m_n_planes == MAX_PLANES) {
+				throw std::overflow_error("BitSlicedCounter overflow");
+			}
+			m_planes[m_n_planes++] = x;
+		}
+	}
+
+	/**
+	 * Returns the count of a single lane @param lane.
+	 */
+	size_t count(size_t lane) const
+	{
+		size_t res = 0;
+		for (size_t k = 0; k < m_n_planes; k++) {
+			res |= size_t((m_planes[k] >> lane) & W(1)) << k;
+		}
+		return res;
+	}
+
+	/**
+	 * Returns a word with all lanes set whose count is larger than or equal
+	 * to @param thresh.
+	 */
+	W greater_equal(size_t thresh) const
+	{
+		size_t n = m_n_planes;
+		while (n < std::numeric_limits<size_t>::digits && (thresh >> n)) {
+			n++;
+		}
+		W gt = 0, eq = std::numeric_limits<W>::max();
+		for (size_t k = n; k-- > 0;) {
+			const W p = plane(k);
+			if ((thresh >> k) & 1) {
+				eq &= p;
+			}
+			else {
+				gt |= eq & p;
+				eq &= ~p;
+			}
+		}
+		return gt | eq;
+	}
+};
+}
+
+#endif /* CPPNAM_UTIL_BIT_SLICED_COUNTER_HPP */
@@ -0,0 +1,668 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "bitops.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPPNAM_BITOPS_X86
+#include <immintrin.h>
+#define CPPNAM_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace nam {
+
+constexpr const char *BitOps::ENV_SIMD;
+
+namespace {
+
+enum class Op { AND, OR, XOR, ANDNOT };
+
+/*
+ * Scalar kernels, working on 64 bit words and single bytes for the tail.
+ * Every kernel starts at byte @param i, so the vectorised kernels can use
+ * them for the remainder.
+ */
+
+inline uint64_t load64(const uint8_t *p)
+{
+	uint64_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline void store64(uint8_t *p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+template <Op op, typename W>
+inline W apply(W a, W b)
+{
+	switch (op) {
+		case Op::AND:
+			return a & b;
+		case Op::OR:
+			return a | b;
+		case Op::XOR:
+			return a ^ b;
+		case Op::ANDNOT:
+			return a & ~b;
+	}
+	return a;
+}
+
+template <Op op>
+inline void scalar_binary(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+                          size_t n, size_t i = 0)
+{
+	for (; i + 8 <= n; i += 8) {
+		store64(dst + i, apply<op>(load64(a + i), load64(b + i)));
+	}
+	for (; i < n; i++) {
+		dst[i] = apply<op>(a[i], b[i]);
+	}
+}
+
+/*
+ * Population count of op(a, b), with op(a, b) = a if b is nullptr
+ */
+template <Op op>
+inline size_t scalar_popcount(const uint8_t *a, const uint8_t *b, size_t n,
+                              size_t i = 0)
+{
+	size_t res = 0;
+	for (; i + 8 <= n; i += 8) {
+		uint64_t v = b ? apply<op>(load64(a + i), load64(b + i)) : load64(a + i);
+		res += __builtin_popcountll(v);
+	}
+	for (; i < n; i++) {
+		res += __builtin_popcount(b ? apply<op>(a[i], b[i]) : a[i]);
+	}
+	return res;
+}
+
+inline bool scalar_is_subset(const uint8_t *a, const uint8_t *b, size_t n,
+                             size_t i = 0)
+{
+	for (; i + 8 <= n; i += 8) {
+		if (load64(a + i) & ~load64(b + i)) {
+			return false;
+		}
+	}
+	for (; i < n; i++) {
+		if (a[i] & ~b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool scalar_any(const uint8_t *a, size_t n, size_t i = 0)
+{
+	for (; i + 8 <= n; i += 8) {
+		if (load64(a + i)) {
+			return true;
+		}
+	}
+	for (; i < n; i++) {
+		if (a[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+namespace scalar {
+template <Op op>
+void binary(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n)
+{
+	scalar_binary<op>(dst, a, b, n);
+}
+
+size_t popcount(const uint8_t *a, size_t n)
+{
+	return scalar_popcount<Op::AND>(a, nullptr, n);
+}
+
+template <Op op>
+size_t popcount_op(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	return scalar_popcount<op>(a, b, n);
+}
+
+bool is_subset(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	return scalar_is_subset(a, b, n);
+}
+
+bool any(const uint8_t *a, size_t n) { return scalar_any(a, n); }
+
+const BitOps::Kernels kernels = {
+    SimdLevel::SCALAR,       binary<Op::AND>,         binary<Op::OR>,
+    binary<Op::XOR>,         binary<Op::ANDNOT>,      popcount,
+    popcount_op<Op::AND>,    popcount_op<Op::ANDNOT>, is_subset,
+    any};
+}
+
+#ifdef CPPNAM_BITOPS_X86
+
+/*
+ * SSE4.2: 128 bit vectors for the bit-wise operations, the POPCNT
+ * instruction on 64 bit words for the population counts.
+ */
+namespace sse42 {
+template <Op op>
+CPPNAM_TARGET("sse4.2") inline __m128i apply128(__m128i a, __m128i b)
+{
+	switch (op) {
+		case Op::AND:
+			return _mm_and_si128(a, b);
+		case Op::OR:
+			return _mm_or_si128(a, b);
+		case Op::XOR:
+			return _mm_xor_si128(a, b);
+		case Op::ANDNOT:
+			return _mm_andnot_si128(b, a);
+	}
+	return a;
+}
+
+template <Op op>
+CPPNAM_TARGET("sse4.2")
+void binary(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		_mm_storeu_si128(
+		    (__m128i *)(dst + i),
+		    apply128<op>(_mm_loadu_si128((const __m128i *)(a + i)),
+		                 _mm_loadu_si128((const __m128i *)(b + i))));
+	}
+	scalar_binary<op>(dst, a, b, n, i);
+}
+
+template <Op op>
+CPPNAM_TARGET("sse4.2,popcnt")
+size_t popcount_impl(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	// Four independent accumulators hide the latency of POPCNT
+	uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		uint64_t v0 = load64(a + i), v1 = load64(a + i + 8),
+		         v2 = load64(a + i + 16), v3 = load64(a + i + 24);
+		if (b) {
+			v0 = apply<op>(v0, load64(b + i));
+			v1 = apply<op>(v1, load64(b + i + 8));
+			v2 = apply<op>(v2, load64(b + i + 16));
+			v3 = apply<op>(v3, load64(b + i + 24));
+		}
+		c0 += _mm_popcnt_u64(v0);
+		c1 += _mm_popcnt_u64(v1);
+		c2 += _mm_popcnt_u64(v2);
+		c3 += _mm_popcnt_u64(v3);
+	}
+	for (; i + 8 <= n; i += 8) {
+		uint64_t v = load64(a + i);
+		c0 += _mm_popcnt_u64(b ? apply<op>(v, load64(b + i)) : v);
+	}
+	return c0 + c1 + c2 + c3 + scalar_popcount<op>(a, b, n, i);
+}
+
+size_t popcount(const uint8_t *a, size_t n)
+{
+	return popcount_impl<Op::AND>(a, nullptr, n);
+}
+
+template <Op op>
+size_t popcount_op(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	return popcount_impl<op>(a, b, n);
+}
+
+CPPNAM_TARGET("sse4.2")
+bool is_subset(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		if (!_mm_testc_si128(_mm_loadu_si128((const __m128i *)(b + i)),
+		                     _mm_loadu_si128((const __m128i *)(a + i)))) {
+			return false;
+		}
+	}
+	return scalar_is_subset(a, b, n, i);
+}
+
+CPPNAM_TARGET("sse4.2")
+bool any(const uint8_t *a, size_t n)
+{
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(a + i));
+		if (!_mm_testz_si128(v, v)) {
+			return true;
+		}
+	}
+	return scalar_any(a, n, i);
+}
+
+const BitOps::Kernels kernels = {
+    SimdLevel::SSE42,        binary<Op::AND>,         binary<Op::OR>,
+    binary<Op::XOR>,         binary<Op::ANDNOT>,      popcount,
+    popcount_op<Op::AND>,    popcount_op<Op::ANDNOT>, is_subset,
+    any};
+}
+
+/*
+ * AVX2: 256 bit vectors, population counts with the Harley-Seal carry-save
+ * adder network over blocks of 16 vectors, the vectors left over are counted
+ * with the nibble lookup table (see Muła, Kurz, Lemire: "Faster Population
+ * Counts Using AVX2 Instructions").
+ */
+namespace avx2 {
+template <Op op>
+CPPNAM_TARGET("avx2") inline __m256i apply256(__m256i a, __m256i b)
+{
+	switch (op) {
+		case Op::AND:
+			return _mm256_and_si256(a, b);
+		case Op::OR:
+			return _mm256_or_si256(a, b);
+		case Op::XOR:
+			return _mm256_xor_si256(a, b);
+		case Op::ANDNOT:
+			return _mm256_andnot_si256(b, a);
+	}
+	return a;
+}
+
+template <Op op>
+CPPNAM_TARGET("avx2")
+void binary(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		_mm256_storeu_si256(
+		    (__m256i *)(dst + i),
+		    apply256<op>(_mm256_loadu_si256((const __m256i *)(a + i)),
+		                 _mm256_loadu_si256((const __m256i *)(b + i))));
+	}
+	scalar_binary<op>(dst, a, b, n, i);
+}
+
+/*
+ * Population counts of the four 64 bit lanes of @param v
+ */
+CPPNAM_TARGET("avx2") inline __m256i popcount256(__m256i v)
+{
+	const __m256i lookup =
+	    _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+	                     1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_mask = _mm256_set1_epi8(0x0f);
+	const __m256i lo = _mm256_and_si256(v, low_mask);
+	const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+	const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+	                                    _mm256_shuffle_epi8(lookup, hi));
+	return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+/*
+ * Carry-save adder: h:l = a + b + c
+ */
+CPPNAM_TARGET("avx2")
+inline void csa(__m256i &h, __m256i &l, __m256i a, __m256i b, __m256i c)
+{
+	const __m256i u = _mm256_xor_si256(a, b);
+	h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+	l = _mm256_xor_si256(u, c);
+}
+
+template <Op op>
+CPPNAM_TARGET("avx2")
+inline __m256i load256(const uint8_t *a, const uint8_t *b, size_t i)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i *)(a + i));
+	return b ? apply256<op>(v, _mm256_loadu_si256((const __m256i *)(b + i)))
+	         : v;
+}
+
+template <Op op>
+CPPNAM_TARGET("avx2,popcnt")
+size_t popcount_impl(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	__m256i total = _mm256_setzero_si256();
+	__m256i ones = _mm256_setzero_si256(), twos = _mm256_setzero_si256(),
+	        fours = _mm256_setzero_si256(), eights = _mm256_setzero_si256();
+	__m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+	size_t i = 0;
+	for (; i + 16 * 32 <= n; i += 16 * 32) {
+#define v(k) load256<op>(a, b, i + (k)*32)
+		csa(twos_a, ones, ones, v(0), v(1));
+		csa(twos_b, ones, ones, v(2), v(3));
+		csa(fours_a, twos, twos, twos_a, twos_b);
+		csa(twos_a, ones, ones, v(4), v(5));
+		csa(twos_b, ones, ones, v(6), v(7));
+		csa(fours_b, twos, twos, twos_a, twos_b);
+		csa(eights_a, fours, fours, fours_a, fours_b);
+		csa(twos_a, ones, ones, v(8), v(9));
+		csa(twos_b, ones, ones, v(10), v(11));
+		csa(fours_a, twos, twos, twos_a, twos_b);
+		csa(twos_a, ones, ones, v(12), v(13));
+		csa(twos_b, ones, ones, v(14), v(15));
+		csa(fours_b, twos, twos, twos_a, twos_b);
+		csa(eights_b, fours, fours, fours_a, fours_b);
+		csa(sixteens, eights, eights, eights_a, eights_b);
+		total = _mm256_add_epi64(total, popcount256(sixteens));
+#undef v
+	}
+	total = _mm256_slli_epi64(total, 4);
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+	total = _mm256_add_epi64(total, popcount256(ones));
+	for (; i + 32 <= n; i += 32) {
+		total = _mm256_add_epi64(total, popcount256(load256<op>(a, b, i)));
+	}
+	size_t res = _mm256_extract_epi64(total, 0) +
+	             _mm256_extract_epi64(total, 1) +
+	             _mm256_extract_epi64(total, 2) +
+	             _mm256_extract_epi64(total, 3);
+	for (; i + 8 <= n; i += 8) {
+		uint64_t v = load64(a + i);
+		res += _mm_popcnt_u64(b ? apply<op>(v, load64(b + i)) : v);
+	}
+	return res + scalar_popcount<op>(a, b, n, i);
+}
+
+size_t popcount(const uint8_t *a, size_t n)
+{
+	return popcount_impl<Op::AND>(a, nullptr, n);
+}
+
+template <Op op>
+size_t popcount_op(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	return popcount_impl<op>(a, b, n);
+}
+
+CPPNAM_TARGET("avx2")
+bool is_subset(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		if (!_mm256_testc_si256(
+		        _mm256_loadu_si256((const __m256i *)(b + i)),
+		        _mm256_loadu_si256((const __m256i *)(a + i)))) {
+			return false;
+		}
+	}
+	return scalar_is_subset(a, b, n, i);
+}
+
+CPPNAM_TARGET("avx2")
+bool any(const uint8_t *a, size_t n)
+{
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(a + i));
+		if (!_mm256_testz_si256(v, v)) {
+			return true;
+		}
+	}
+	return scalar_any(a, n, i);
+}
+
+const BitOps::Kernels kernels = {
+    SimdLevel::AVX2,         binary<Op::AND>,         binary<Op::OR>,
+    binary<Op::XOR>,         binary<Op::ANDNOT>,      popcount,
+    popcount_op<Op::AND>,    popcount_op<Op::ANDNOT>, is_subset,
+    any};
+}
+
+/*
+ * AVX-512: 512 bit vectors and the VPOPCNTQ instruction
+ */
+namespace avx512 {
+#define CPPNAM_AVX512 "avx512f,avx512vpopcntdq,popcnt"
+
+template <Op op>
+CPPNAM_TARGET(CPPNAM_AVX512) inline __m512i apply512(__m512i a, __m512i b)
+{
+	switch (op) {
+		case Op::AND:
+			return _mm512_and_si512(a, b);
+		case Op::OR:
+			return _mm512_or_si512(a, b);
+		case Op::XOR:
+			return _mm512_xor_si512(a, b);
+		case Op::ANDNOT:
+			// a ^ (a & b), _mm512_andnot_si512() triggers bogus warnings
+			return _mm512_xor_si512(a, _mm512_and_si512(a, b));
+	}
+	return a;
+}
+
+template <Op op>
+CPPNAM_TARGET(CPPNAM_AVX512)
+void binary(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64) {
+		_mm512_storeu_si512(dst + i,
+		                    apply512<op>(_mm512_loadu_si512(a + i),
+		                                 _mm512_loadu_si512(b + i)));
+	}
+	scalar_binary<op>(dst, a, b, n, i);
+}
+
+template <Op op>
+CPPNAM_TARGET(CPPNAM_AVX512)
+size_t popcount_impl(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	__m512i c0 = _mm512_setzero_si512(), c1 = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 128 <= n; i += 128) {
+		__m512i v0 = _mm512_loadu_si512(a + i),
+		        v1 = _mm512_loadu_si512(a + i + 64);
+		if (b) {
+			v0 = apply512<op>(v0, _mm512_loadu_si512(b + i));
+			v1 = apply512<op>(v1, _mm512_loadu_si512(b + i + 64));
+		}
+		c0 = _mm512_add_epi64(c0, _mm512_popcnt_epi64(v0));
+		c1 = _mm512_add_epi64(c1, _mm512_popcnt_epi64(v1));
+	}
+	for (; i + 64 <= n; i += 64) {
+		__m512i v = _mm512_loadu_si512(a + i);
+		if (b) {
+			v = apply512<op>(v, _mm512_loadu_si512(b + i));
+		}
+		c0 = _mm512_add_epi64(c0, _mm512_popcnt_epi64(v));
+	}
+	uint64_t lanes[8];
+	_mm512_storeu_si512(lanes, _mm512_add_epi64(c0, c1));
+	size_t res = 0;
+	for (auto lane : lanes) {
+		res += lane;
+	}
+	for (; i + 8 <= n; i += 8) {
+		uint64_t v = load64(a + i);
+		res += _mm_popcnt_u64(b ? apply<op>(v, load64(b + i)) : v);
+	}
+	return res + scalar_popcount<op>(a, b, n, i);
+}
+
+size_t popcount(const uint8_t *a, size_t n)
+{
+	return popcount_impl<Op::AND>(a, nullptr, n);
+}
+
+template <Op op>
+size_t popcount_op(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	return popcount_impl<op>(a, b, n);
+}
+
+CPPNAM_TARGET(CPPNAM_AVX512)
+bool is_subset(const uint8_t *a, const uint8_t *b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64) {
+		const __m512i v = _mm512_loadu_si512(a + i);
+		if (_mm512_cmpneq_epi64_mask(
+		        _mm512_and_si512(v, _mm512_loadu_si512(b + i)), v)) {
+			return false;
+		}
+	}
+	return scalar_is_subset(a, b, n, i);
+}
+
+CPPNAM_TARGET(CPPNAM_AVX512)
+bool any(const uint8_t *a, size_t n)
+{
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64) {
+		const __m512i v = _mm512_loadu_si512(a + i);
+		if (_mm512_test_epi64_mask(v, v)) {
+			return true;
+		}
+	}
+	return scalar_any(a, n, i);
+}
+
+#undef CPPNAM_AVX512
+
+const BitOps::Kernels kernels = {
+    SimdLevel::AVX512,       binary<Op::AND>,         binary<Op::OR>,
+    binary<Op::XOR>,         binary<Op::ANDNOT>,      popcount,
+    popcount_op<Op::AND>,    popcount_op<Op::ANDNOT>, is_subset,
+    any};
+}
+#endif /* CPPNAM_BITOPS_X86 */
+
+SimdLevel env_level()
+{
+	const char *env = std::getenv(BitOps::ENV_SIMD);
+	if (!env || !*env) {
+		return BitOps::detect();
+	}
+	for (auto level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2,
+	                   SimdLevel::AVX512}) {
+		if (std::string(env) == BitOps::name(level)) {
+			if (!BitOps::supported(level)) {
+				throw std::invalid_argument(
+				    std::string(BitOps::ENV_SIMD) + "=" + env +
+				    " is not supported by this CPU");
+			}
+			return level;
+		}
+	}
+	throw std::invalid_argument(std::string("Invalid value \"") + env +
+	                            "\" for " + BitOps::ENV_SIMD);
+}
+
+std::atomic<const BitOps::Kernels *> &current()
+{
+	static std::atomic<const BitOps::Kernels *> kernels(
+	    &BitOps::kernels(env_level()));
+	return kernels;
+}
+}
+
+bool BitOps::supported(SimdLevel level)
+{
+#ifdef CPPNAM_BITOPS_X86
+	__builtin_cpu_init();
+	const bool sse42 =
+	    __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+	switch (level) {
+		case SimdLevel::SCALAR:
+			return true;
+		case SimdLevel::SSE42:
+			return sse42;
+		case SimdLevel::AVX2:
+			return sse42 && __builtin_cpu_supports("avx2");
+		case SimdLevel::AVX512:
+			return sse42 && __builtin_cpu_supports("avx512f") &&
+			       __builtin_cpu_supports("avx512vpopcntdq");
+	}
+	return false;
+#else
+	return level == SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel BitOps::detect()
+{
+	for (auto level : {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE42}) {
+		if (supported(level)) {
+			return level;
+		}
+	}
+	return SimdLevel::SCALAR;
+}
+
+const char *BitOps::name(SimdLevel level)
+{
+	switch (level) {
+		case SimdLevel::SCALAR:
+			return "scalar";
+		case SimdLevel::SSE42:
+			return "sse4.2";
+		case SimdLevel::AVX2:
+			return "avx2";
+		case SimdLevel::AVX512:
+			return "avx512";
+	}
+	return "unknown";
+}
+
+SimdLevel BitOps::level() { return kernels().level; }
+
+void BitOps::level(SimdLevel level)
+{
+	if (!supported(level)) {
+		throw std::invalid_argument(std::string("SIMD level ") + name(level) +
+		                            " is not supported by this CPU");
+	}
+	current() = &kernels(level);
+}
+
+const BitOps::Kernels &BitOps::kernels() { return *current(); }
+
+const BitOps::Kernels &BitOps::kernels(SimdLevel level)
+{
+#ifdef CPPNAM_BITOPS_X86
+	switch (level) {
+		case SimdLevel::SCALAR:
+			return scalar::kernels;
+		case SimdLevel::SSE42:
+			return sse42::kernels;
+		case SimdLevel::AVX2:
+			return avx2::kernels;
+		case SimdLevel::AVX512:
+			return avx512::kernels;
+	}
+#else
+	(void)level;
+#endif
+	return scalar::kernels;
+}
+}
@@ -0,0 +1,204 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_BITOPS_HPP
+#define CPPNAM_UTIL_BITOPS_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+
+namespace nam {
+
+/**
+ * Instruction set extensions used by the BitOps kernels, in ascending order.
+ */
+enum class SimdLevel {
+	SCALAR = 0,  // Plain 64 bit words
+	SSE42 = 1,   // 128 bit vectors and the POPCNT instruction
+	AVX2 = 2,    // 256 bit vectors, Harley-Seal population count
+	AVX512 = 3   // 512 bit vectors and VPOPCNTDQ
+};
+
+/**
+ * Bulk bit operations on spans of cells, e.g. the rows of a BinaryMatrix.
+ * There is an implementation for every SimdLevel, the best one supported by
+ * the CPU is selected when the library is used first, so the same binary
+ * runs on every machine. The selection can be overridden with the
+ * environment variable CPPNAM_SIMD or with level().
+ *
+ * All functions work on @param n cells of an integer type T. Destination and
+ * source spans may be identical, but must not overlap otherwise.
+ */
+class BitOps {
+public:
+	/**
+	 * Table of the kernels of one SimdLevel, all sizes in bytes.
+	 */
+	struct Kernels {
+		SimdLevel level;
+		void (*bit_and)(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+		                size_t n);
+		void (*bit_or)(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+		               size_t n);
+		void (*bit_xor)(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+		                size_t n);
+		void (*bit_andnot)(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+		                   size_t n);
+		size_t (*popcount)(const uint8_t *a, size_t n);
+		size_t (*popcount_and)(const uint8_t *a, const uint8_t *b, size_t n);
+		size_t (*popcount_andnot)(const uint8_t *a, const uint8_t *b,
+		                          size_t n);
+		bool (*is_subset)(const uint8_t *a, const uint8_t *b, size_t n);
+		bool (*any)(const uint8_t *a, size_t n);
+	};
+
+	/**
+	 * Name of the environment variable selecting the SimdLevel, one of
+	 * "scalar", "sse4.2", "avx2" or "avx512".
+	 */
+	static constexpr const char *ENV_SIMD = "CPPNAM_SIMD";
+
+	/**
+	 * Returns true if the CPU supports the kernels of @param level.
+	 */
+	static bool supported(SimdLevel level);
+
+	/**
+	 * Best SimdLevel supported by the CPU
+	 */
+	static SimdLevel detect();
+
+	/**
+	 * Name of @param level as used in CPPNAM_SIMD
+	 */
+	static const char *name(SimdLevel level);
+
+	/**
+	 * Currently used SimdLevel. The setter throws std::invalid_argument if
+	 * the level is not supported by the CPU.
+	 */
+	static SimdLevel level();
+	static void level(SimdLevel level);
+
+	/**
+	 * Kernels of the current level and of a given level
+	 */
+	static const Kernels &kernels();
+	static const Kernels &kernels(SimdLevel level);
+
+	/**
+	 * dst = a & b, dst = a | b, dst = a ^ b and dst = a & ~b
+	 */
+	template <typename T>
+	static void bit_and(T *dst, const T *a, const T *b, size_t n)
+	{
+		kernels().bit_and(bytes(dst), bytes(a), bytes(b), n * sizeof(T));
+	}
+	template <typename T>
+	static void bit_or(T *dst, const T *a, const T *b, size_t n)
+	{
+		kernels().bit_or(bytes(dst), bytes(a), bytes(b), n * sizeof(T));
+	}
+	template <typename T>
+	static void bit_xor(T *dst, const T *a, const T *b, size_t n)
+	{
+		kernels().bit_xor(bytes(dst), bytes(a), bytes(b), n * sizeof(T));
+	}
+	template <typename T>
+	static void bit_andnot(T *dst, const T *a, const T *b, size_t n)
+	{
+		kernels().bit_andnot(bytes(dst), bytes(a), bytes(b), n * sizeof(T));
+	}
+
+	/**
+	 * Number of set bits in a, in a & b and in a & ~b
+	 */
+	template <typename T>
+	static size_t popcount(const T *a, size_t n)
+	{
+		return kernels().popcount(bytes(a), n * sizeof(T));
+	}
+	template <typename T>
+	static size_t popcount_and(const T *a, const T *b, size_t n)
+	{
+		return kernels().popcount_and(bytes(a), bytes(b), n * sizeof(T));
+	}
+	template <typename T>
+	static size_t popcount_andnot(const T *a, const T *b, size_t n)
+	{
+		return kernels().popcount_andnot(bytes(a), bytes(b), n * sizeof(T));
+	}
+
+	/**
+	 * Returns true if every bit set in a is also set in b
+	 */
+	template <typename T>
+	static bool is_subset(const T *a, const T *b, size_t n)
+	{
+		return kernels().is_subset(bytes(a), bytes(b), n * sizeof(T));
+	}
+
+	/**
+	 * Returns true if any bit or no bit of a is set
+	 */
+	template <typename T>
+	static bool any(const T *a, size_t n)
+	{
+		return kernels().any(bytes(a), n * sizeof(T));
+	}
+	template <typename T>
+	static bool none(const T *a, size_t n)
+	{
+		return !any(a, n);
+	}
+
+	/**
+	 * Transposes the 64 x 64 bit block @param block in place: bit c of
+	 * block[r] is swapped with bit r of block[c]. The quadrants are swapped
+	 * recursively with masks and shifts, 6 x 32 word operations in total.
+	 */
+	static void transpose64(uint64_t block[64])
+	{
+		uint64_t m = 0x00000000FFFFFFFFULL;
+		for (size_t j = 32; j != 0; j >>= 1, m ^= m << j) {
+			for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+				const uint64_t t = ((block[k] >> j) ^ block[k | j]) & m;
+				block[k] ^= t << j;
+				block[k | j] ^= t;
+			}
+		}
+	}
+
+private:
+	template <typename T>
+	static uint8_t *bytes(T *p)
+	{
+		return reinterpret_cast<uint8_t *>(p);
+	}
+	template <typename T>
+	static const uint8_t *bytes(const T *p)
+	{
+		return reinterpret_cast<const uint8_t *>(p);
+	}
+};
+}
+
+#endif /* CPPNAM_UTIL_BITOPS_HPP */
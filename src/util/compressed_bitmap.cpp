@@ -0,0 +1,236 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "compressed_bitmap.hpp"
+
+namespace nam {
+
+constexpr size_t CompressedBitmap::CHUNK_BITS;
+
+namespace {
+size_t bitmap_words(size_t chunk_bits) { return (chunk_bits + 15) / 16; }
+
+/**
+ * Number of bytes needed by the encodings of a container
+ */
+size_t array_bytes(size_t count) { return count * sizeof(uint16_t); }
+size_t bitmap_bytes(size_t chunk_bits)
+{
+	return bitmap_words(chunk_bits) * sizeof(uint16_t);
+}
+size_t run_bytes(size_t runs) { return runs * 2 * sizeof(uint16_t); }
+}
+
+size_t CompressedBitmap::chunk_bits(uint32_t key) const
+{
+	return std::min(CHUNK_BITS, m_size - size_t(key) * CHUNK_BITS);
+}
+
+const CompressedBitmap::Container *CompressedBitmap::find(uint32_t key) const
+{
+	auto it = std::lower_bound(
+	    m_containers.begin(), m_containers.end(), key,
+	    [](const Container &c, uint32_t key) { return c.key < key; });
+	return it != m_containers.end() && it->key == key ? &*it : nullptr;
+}
+
+bool CompressedBitmap::contains(const Container &c, uint16_t v)
+{
+	switch (c.type) {
+		case Type::ARRAY:
+			return std::binary_search(c.values.begin(), c.values.end(), v);
+		case Type::BITMAP:
+			return (c.values[v / 16] >> (v % 16)) & 1;
+		case Type::RUN: {
+			// Find the last run starting at or before v
+			size_t lo = 0, hi = c.values.size() / 2;
+			while (lo < hi) {
+				const size_t mid = (lo + hi) / 2;
+				if (c.values[2 * mid] <= v) {
+					lo = mid + 1;
+				}
+				else {
+					hi = mid;
+				}
+			}
+			return lo > 0 && v <= c.values[2 * lo - 1];
+		}
+	}
+	return false;
+}
+
+void CompressedBitmap::encode(Container &c, Type type, size_t chunk_bits,
+                              const std::vector<uint16_t> &bits)
+{
+	c.type = type;
+	c.count = bits.size();
+	c.values.clear();
+	switch (type) {
+		case Type::ARRAY:
+			c.values = bits;
+			break;
+		case Type::BITMAP:
+			c.values.assign(bitmap_words(chunk_bits), 0);
+			for (uint16_t b : bits) {
+				c.values[b / 16] |= 1 << (b % 16);
+			}
+			break;
+		case Type::RUN:
+			for (uint16_t b : bits) {
+				if (!c.values.empty() && c.values.back() + 1 == b) {
+					c.values.back() = b;
+				}
+				else {
+					c.values.push_back(b);
+					c.values.push_back(b);
+				}
+			}
+			break;
+	}
+	c.values.shrink_to_fit();
+}
+
+size_t CompressedBitmap::count() const
+{
+	size_t res = 0;
+	for (const Container &c : m_containers) {
+		res += c.count;
+	}
+	return res;
+}
+
+bool CompressedBitmap::add(size_t i)
+{
+	if (i >= m_size) {
+		std::stringstream ss;
+		ss << "Bit " << i << " out of range for bitmap of size " << m_size
+		   << std::endl;
+		throw std::out_of_range(ss.str());
+	}
+	const uint32_t key = i / CHUNK_BITS;
+	const uint16_t v = i % CHUNK_BITS;
+	auto it = std::lower_bound(
+	    m_containers.begin(), m_containers.end(), key,
+	    [](const Container &c, uint32_t key) { return c.key < key; });
+	if (it == m_containers.end() || it->key != key) {
+		it = m_containers.insert(it, Container());
+		it->key = key;
+	}
+	Container &c = *it;
+	const size_t cb = chunk_bits(key);
+	switch (c.type) {
+		case Type::ARRAY: {
+			auto pos = std::lower_bound(c.values.begin(), c.values.end(), v);
+			if (pos != c.values.end() && *pos == v) {
+				return false;
+			}
+			c.values.insert(pos, v);
+			c.count++;
+			if (array_bytes(c.count) > bitmap_bytes(cb)) {
+				std::vector<uint16_t> bits;
+				bits.swap(c.values);
+				encode(c, Type::BITMAP, cb, bits);
+			}
+			return true;
+		}
+		case Type::BITMAP: {
+			uint16_t &word = c.values[v / 16];
+			const uint16_t mask = 1 << (v % 16);
+			if (word & mask) {
+				return false;
+			}
+			word |= mask;
+			c.count++;
+			return true;
+		}
+		case Type::RUN: {
+			if (contains(c, v)) {
+				return false;
+			}
+			// Runs are only built by optimize(), decode them before the
+			// container is modified
+			std::vector<uint16_t> bits;
+			bits.reserve(c.count + 1);
+			for_each(c, [&](uint16_t b) { bits.push_back(b); });
+			bits.insert(std::lower_bound(bits.begin(), bits.end(), v), v);
+			encode(c,
+			       array_bytes(bits.size()) > bitmap_bytes(cb) ? Type::BITMAP
+			                                                   : Type::ARRAY,
+			       cb, bits);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CompressedBitmap::contains(size_t i) const
+{
+	if (i >= m_size) {
+		return false;
+	}
+	const Container *c = find(i / CHUNK_BITS);
+	return c && contains(*c, i % CHUNK_BITS);
+}
+
+void CompressedBitmap::optimize()
+{
+	std::vector<uint16_t> bits;
+	for (Container &c : m_containers) {
+		bits.clear();
+		for_each(c, [&](uint16_t b) { bits.push_back(b); });
+		size_t runs = 0;
+		for (size_t k = 0; k < bits.size(); k++) {
+			runs += k == 0 || bits[k - 1] + 1 != bits[k];
+		}
+
+		// Smallest encoding, ARRAY and BITMAP are preferred on ties as they
+		// can be modified in place
+		const size_t cb = chunk_bits(c.key);
+		Type type = Type::ARRAY;
+		size_t bytes = array_bytes(bits.size());
+		if (bitmap_bytes(cb) < bytes) {
+			type = Type::BITMAP;
+			bytes = bitmap_bytes(cb);
+		}
+		if (run_bytes(runs) < bytes) {
+			type = Type::RUN;
+		}
+		encode(c, type, cb, bits);
+	}
+	m_containers.shrink_to_fit();
+}
+
+size_t CompressedBitmap::memory() const
+{
+	size_t res = sizeof(*this) + m_containers.capacity() * sizeof(Container);
+	for (const Container &c : m_containers) {
+		res += c.values.capacity() * sizeof(uint16_t);
+	}
+	return res;
+}
+
+size_t CompressedBitmap::containers(Type type) const
+{
+	return std::count_if(m_containers.begin(), m_containers.end(),
+	                     [type](const Container &c) { return c.type == type; });
+}
+}
@@ -0,0 +1,153 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_COMPRESSED_BITMAP_HPP
+#define CPPNAM_UTIL_COMPRESSED_BITMAP_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace nam {
+
+/**
+ * Compressed set of bits in the range [0, size()), similar to a roaring
+ * bitmap. The range is split into chunks of 2^16 bits, every chunk with at
+ * least one set bit is stored in a container with one of three encodings:
+ *
+ *  - ARRAY: sorted list of the set bits, 2 bytes per bit
+ *  - BITMAP: plain bit vector of the chunk
+ *  - RUN: sorted list of runs of set bits, 4 bytes per run
+ *
+ * add() switches a container from ARRAY to BITMAP as soon as the bitmap gets
+ * smaller, optimize() selects the smallest encoding for all containers.
+ */
+class CompressedBitmap {
+public:
+	enum class Type : uint8_t { ARRAY = 0, BITMAP = 1, RUN = 2 };
+
+	/**
+	 * Number of bits covered by a container
+	 */
+	static constexpr size_t CHUNK_BITS = size_t(1) << 16;
+
+private:
+	struct Container {
+		uint32_t key = 0;    // Index of the chunk
+		uint32_t count = 0;  // Number of set bits
+		Type type = Type::ARRAY;
+
+		// ARRAY: sorted bits, BITMAP: 16 bit words with the bits of the
+		// chunk, RUN: pairs of first and last bit of a run
+		std::vector<uint16_t> values;
+	};
+
+	std::vector<Container> m_containers;  // Sorted by key
+	size_t m_size = 0;
+
+	size_t chunk_bits(uint32_t key) const;
+	const Container *find(uint32_t key) const;
+	static bool contains(const Container &c, uint16_t v);
+	static void encode(Container &c, Type type, size_t chunk_bits,
+	                   const std::vector<uint16_t> &bits);
+
+	template <typename F>
+	static void for_each(const Container &c, F &&f)
+	{
+		switch (c.type) {
+			case Type::ARRAY:
+				for (uint16_t v : c.values) {
+					f(v);
+				}
+				break;
+			case Type::BITMAP:
+				for (size_t w = 0; w < c.values.size(); w++) {
+					uint32_t word = c.values[w];
+					while (word) {
+						f(w * 16 + __builtin_ctz(word));
+						word &= word - 1;
+					}
+				}
+				break;
+			case Type::RUN:
+				for (size_t r = 0; r < c.values.size(); r += 2) {
+					for (size_t v = c.values[r]; v <= c.values[r + 1]; v++) {
+						f(v);
+					}
+				}
+				break;
+		}
+	}
+
+public:
+	/**
+	 * Creates an empty set for the bits [0, @param size)
+	 */
+	CompressedBitmap() = default;
+	explicit CompressedBitmap(size_t size) : m_size(size) {}
+
+	/**
+	 * Number of bits in the range and number of set bits
+	 */
+	size_t size() const { return m_size; }
+	size_t count() const;
+
+	/**
+	 * Sets bit @param i, returns false if it was set already. Throws
+	 * std::out_of_range if i >= size().
+	 */
+	bool add(size_t i);
+
+	/**
+	 * Returns true if bit @param i is set
+	 */
+	bool contains(size_t i) const;
+
+	/**
+	 * Calls @param f(i) for every set bit i in ascending order
+	 */
+	template <typename F>
+	void for_each(F &&f) const
+	{
+		for (const Container &c : m_containers) {
+			const size_t base = size_t(c.key) * CHUNK_BITS;
+			for_each(c, [&](size_t v) { f(base + v); });
+		}
+	}
+
+	/**
+	 * Re-encodes every container with the encoding needing the least memory
+	 */
+	void optimize();
+
+	/**
+	 * Number of bytes used by the set
+	 */
+	size_t memory() const;
+
+	/**
+	 * Number of containers with the encoding @param type
+	 */
+	size_t containers(Type type) const;
+};
+}
+
+#endif /* CPPNAM_UTIL_COMPRESSED_BITMAP_HPP */
@@ -29,6 +29,7 @@
 #include <random>
 
 #include "binary_matrix.hpp"
+#include "sparse_pattern_matrix.hpp"
 
 namespace nam {
 namespace {
@@ -148,6 +149,19 @@ private:
 	bool m_balance;
 	bool m_unique;
 
+	/**
+	 * Sink for the generators setting the bits in the rows of @param res
+	 */
+	template <typename T>
+	static auto dense_sink(BinaryMatrix<T> &res)
+	{
+		return [&res](size_t i, const std::vector<uint32_t> &idx) {
+			for (auto j : idx) {
+				res.set_bit(i, j);
+			}
+		};
+	}
+
 public:
 	using ProgressCallback = std::function<bool(float)>;
 
@@ -204,22 +218,93 @@ public:
 		}
 	}
 
+	/**
+	 * Like generate(), but returns the data as SparsePatternMatrix without
+	 * building the dense matrix. For the same seed and flags the patterns are
+	 * the same as the ones of generate(). If @param progress aborts the
+	 * generation, only the samples generated so far are returned.
+	 */
+	SparsePatternMatrix generate_sparse(
+	    uint32_t n_bits, uint32_t n_ones, uint32_t n_samples,
+	    const ProgressCallback &progress = [](float) { return true; })
+	{
+		SparsePatternMatrix res(n_samples, n_bits, n_ones);
+		auto sink = [&res](size_t i, const std::vector<uint32_t> &idx) {
+			res.set_row(i, idx);
+		};
+		res.truncate(generate_idx(n_bits, n_ones, n_samples, sink, progress));
+		return res;
+	}
+
+	/**
+	 * Like generate(), but passes the indices of the bits set in sample i to
+	 * @param sink(i, idx) instead of storing them, e.g. to write them to a
+	 * PatternFileWriter. The indices are not sorted. Returns the number of
+	 * generated samples.
+	 */
+	template <typename Sink>
+	size_t generate_idx(
+	    uint32_t n_bits, uint32_t n_ones, uint32_t n_samples, Sink sink,
+	    const ProgressCallback &progress = [](float) { return true; })
+	{
+		std::default_random_engine re(m_seed);
+		if (m_random && !m_balance && !m_unique) {
+			return generate_random_idx(re, n_bits, n_ones, n_samples, progress,
+			                           sink);
+		}
+		return generate_balanced_idx(re, n_bits, n_ones, n_samples, m_random,
+		                             m_balance, m_unique, progress, sink);
+	}
+
 	template <typename RandomEngine, typename T>
 	BinaryMatrix<T> generate_random(RandomEngine &re, size_t n_bits,
 	                                size_t n_ones, size_t n_samples,
 	                                const ProgressCallback &progress)
 	{
 		BinaryMatrix<T> res(n_samples, n_bits);
+		generate_random_idx(re, n_bits, n_ones, n_samples, progress,
+		                    dense_sink(res));
+		return res;
+	}
+
+	template <typename RandomEngine, typename T>
+	BinaryMatrix<T> generate_balanced(RandomEngine &re, uint32_t n_bits,
+	                                  uint32_t n_ones, uint32_t n_samples,
+	                                  bool random, bool balance, bool unique,
+	                                  const ProgressCallback &progress)
+	{
+		BinaryMatrix<T> res(n_samples, n_bits);
+		generate_balanced_idx(re, n_bits, n_ones, n_samples, random, balance,
+		                      unique, progress, dense_sink(res));
+		return res;
+	}
+
+	/**
+	 * The generators behind generate_random() and generate_balanced(). The
+	 * indices of the bits set in sample i are passed to @param sink(i, idx)
+	 * in the order they were drawn. Returns the number of generated samples,
+	 * which is smaller than n_samples if @param progress aborted.
+	 */
+	template <typename RandomEngine, typename Sink>
+	size_t generate_random_idx(RandomEngine &re, size_t n_bits, size_t n_ones,
+	                           size_t n_samples,
+	                           const ProgressCallback &progress, Sink sink)
+	{
+		std::vector<uint32_t> row;
+		size_t n = 0;
 		for (size_t i = 0; i < n_samples; i++) {
+			row.clear();
 			for (size_t j = n_bits - n_ones; j < n_bits; j++) {
 				size_t idx = std::uniform_int_distribution<size_t>(0, j)(re);
-				if (res.get_bit(i, idx)) {
-					res.set_bit(i, j);
+				if (std::find(row.begin(), row.end(), idx) != row.end()) {
+					row.push_back(j);
 				}
 				else {
-					res.set_bit(i, idx);
+					row.push_back(idx);
 				}
 			}
+			sink(i, row);
+			n = i + 1;
 
 			// Regularly call the progress function
 			if ((i == 0) || (i == n_samples - 1) || (i % 100 == 0)) {
@@ -228,14 +313,14 @@ public:
 				}
 			}
 		}
-		return res;
+		return n;
 	}
 
-	template <typename RandomEngine, typename T>
-	BinaryMatrix<T> generate_balanced(RandomEngine &re, uint32_t n_bits,
-	                                  uint32_t n_ones, uint32_t n_samples,
-	                                  bool random, bool balance, bool unique,
-	                                  const ProgressCallback &progress)
+	template <typename RandomEngine, typename Sink>
+	size_t generate_balanced_idx(RandomEngine &re, uint32_t n_bits,
+	                             uint32_t n_ones, uint32_t n_samples,
+	                             bool random, bool balance, bool unique,
+	                             const ProgressCallback &progress, Sink sink)
 	{
 		auto approximate_weight = [](uint32_t k, uint32_t r_ones,
 		                             uint32_t r_bits) -> double {
@@ -251,7 +336,8 @@ public:
 			return res;
 		};
 
-		BinaryMatrix<T> res(n_samples, n_bits);  // Result matrix
+		std::vector<uint32_t> row;  // Indices of the current sample
+		size_t n = 0;               // Number of generated samples
 		Vector<uint32_t> usage(
 		    n_bits,
 		    MatrixFlags::ZEROS);  // Vector tracking how often each bit is used
@@ -267,6 +353,7 @@ public:
 		PermutationTrieNode root(n_bits, n_ones);
 		for (size_t i = 0; i < n_samples; i++) {
 			PermutationTrieNode *node = &root;
+			row.clear();
 			for (size_t j = 0; j < n_ones; j++) {
 				const size_t idx = node->idx();
 
@@ -403,13 +490,15 @@ public:
 				}
 
 				// Set the corresponding output bit to one and update the trie
-				res.set_bit(i, chosen_idx);
+				row.push_back(chosen_idx);
 				usage[chosen_idx]++;
 				if (unique) {
 					node->decrement_permutation(chosen_idx);
 				}
 				node = &node->fetch(chosen_idx);
 			}
+			sink(i, row);
+			n = i + 1;
 
 			// Regularly call the progress function
 			if ((i == 0) || (i == n_samples - 1) || (i % 100 == 0)) {
@@ -419,7 +508,7 @@ public:
 			}
 		}
 
-		return res;
+		return n;
 	}
 
 	/**
@@ -0,0 +1,182 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_FIXED_BINARY_MATRIX_HPP
+#define CPPNAM_UTIL_FIXED_BINARY_MATRIX_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "util/binary_matrix.hpp"
+
+namespace nam {
+
+namespace internal {
+template <typename F, size_t... I>
+inline void unroll(F &&f, std::index_sequence<I...>)
+{
+	(void)std::initializer_list<int>{(f(I), 0)...};
+}
+}
+
+/**
+ * Calls @param f with the indices 0 ... N - 1. The loop is expanded at
+ * compile time, so every call sees a constant index.
+ */
+template <size_t N, typename F>
+inline void unroll(F &&f)
+{
+	internal::unroll(f, std::make_index_sequence<N>());
+}
+
+/**
+ * BinaryMatrix with dimensions known at compile time. The cells are stored
+ * inline (no heap allocation), rows are not padded. Loops over the cells of
+ * a row are unrolled, which pays off for the small networks of hardware
+ * experiments (e.g. 384 x 256 on Spikey), where loop overhead dominates.
+ * The bit layout of a row is the same as in BinaryMatrix, so rows can be
+ * exchanged through ConstRowView.
+ */
+template <typename T, size_t Rows, size_t Cols>
+class FixedBinaryMatrix {
+	static_assert(Rows > 0 && Cols > 0,
+	              "FixedBinaryMatrix needs at least one row and column");
+
+public:
+	static constexpr size_t intWidth = std::numeric_limits<T>::digits;
+	static constexpr T intMax = std::numeric_limits<T>::max();
+
+	/**
+	 * Number of cells in a row
+	 */
+	static constexpr size_t CELLS = (Cols + intWidth - 1) / intWidth;
+
+	/**
+	 * Mask of the valid bits of the last cell of a row
+	 */
+	static constexpr T LAST_MASK =
+	    Cols % intWidth ? T((T(1) << (Cols % intWidth)) - 1) : intMax;
+
+private:
+	alignas(64) T m_mat[Rows * CELLS];
+
+public:
+	/**
+	 * Initialiser with zeros.
+	 */
+	FixedBinaryMatrix() : m_mat() {}
+
+	/**
+	 * Copies @param mat, throws std::out_of_range if the dimensions differ.
+	 */
+	explicit FixedBinaryMatrix(const BinaryMatrix<T> &mat) : m_mat()
+	{
+		if (mat.rows() != Rows || mat.cols() != Cols) {
+			std::stringstream ss;
+			ss << "Matrix of size " << mat.rows() << "x" << mat.cols()
+			   << " does not fit to fixed size " << Rows << "x" << Cols
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		for (size_t i = 0; i < Rows; i++) {
+			const T *src = mat.row_ptr(i);
+			unroll<CELLS>([&](size_t c) { m_mat[i * CELLS + c] = src[c]; });
+		}
+	}
+
+#ifndef NDEBUG
+	void check_range(size_t row, size_t col) const
+	{
+		if (row >= Rows || col >= Cols) {
+			std::stringstream ss;
+			ss << "Index (" << row << ", " << col
+			   << ") out of range for matrix of size " << Rows << "x" << Cols
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+#else
+	void check_range(size_t, size_t) const {}
+#endif
+
+	bool get_bit(size_t row, size_t col) const
+	{
+		check_range(row, col);
+		return (m_mat[row * CELLS + col / intWidth] >> (col % intWidth)) & 1;
+	}
+
+	FixedBinaryMatrix &set_bit(size_t row, size_t col, bool val = true)
+	{
+		check_range(row, col);
+		T &cell = m_mat[row * CELLS + col / intWidth];
+		const T mask = T(1) << (col % intWidth);
+		cell = val ? T(cell | mask) : T(cell & ~mask);
+		return *this;
+	}
+
+	T get_cell(size_t row, size_t c) const { return m_mat[row * CELLS + c]; }
+
+	T *row_ptr(size_t row) { return m_mat + row * CELLS; }
+	const T *row_ptr(size_t row) const { return m_mat + row * CELLS; }
+
+	ConstRowView<T> row(size_t i) const { return {row_ptr(i), Cols}; }
+	RowView<T> row(size_t i) { return {row_ptr(i), Cols}; }
+
+	static constexpr size_t rows() { return Rows; }
+	static constexpr size_t cols() { return Cols; }
+	static constexpr size_t size() { return Rows * Cols; }
+
+	/**
+	 * Copies the matrix into a dynamically sized BinaryMatrix
+	 */
+	BinaryMatrix<T> toBinaryMatrix() const
+	{
+		BinaryMatrix<T> res(Rows, Cols);
+		for (size_t i = 0; i < Rows; i++) {
+			T *dst = res.row_ptr(i);
+			unroll<CELLS>([&](size_t c) { dst[c] = m_mat[i * CELLS + c]; });
+		}
+		return res;
+	}
+};
+
+/**
+ * Expressions for the linker
+ */
+template <typename T, size_t Rows, size_t Cols>
+constexpr size_t FixedBinaryMatrix<T, Rows, Cols>::intWidth;
+
+template <typename T, size_t Rows, size_t Cols>
+constexpr T FixedBinaryMatrix<T, Rows, Cols>::intMax;
+
+template <typename T, size_t Rows, size_t Cols>
+constexpr size_t FixedBinaryMatrix<T, Rows, Cols>::CELLS;
+
+template <typename T, size_t Rows, size_t Cols>
+constexpr T FixedBinaryMatrix<T, Rows, Cols>::LAST_MASK;
+}
+
+#endif /* CPPNAM_UTIL_FIXED_BINARY_MATRIX_HPP */
@@ -0,0 +1,184 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "matrix_file.hpp"
+
+namespace nam {
+
+constexpr uint32_t MatrixFile::VERSION;
+constexpr size_t MatrixFile::HEADER_SIZE;
+
+namespace {
+const char MAGIC[8] = {'C', 'P', 'P', 'N', 'A', 'M', 'M', 'F'};
+
+/**
+ * Written as native integer, reads as 0x04030201 with the other byte order
+ */
+const uint32_t ORDER_MARK = 0x01020304;
+
+/**
+ * Generator flags in Header::flags
+ */
+const uint32_t FLAG_RANDOM = 1, FLAG_BALANCED = 2, FLAG_UNIQUE = 4;
+
+const uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+
+uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+uint64_t mix(uint64_t lane, uint64_t word)
+{
+	return rotl(lane + word * PRIME_2, 31) * PRIME_1;
+}
+
+size_t header_checksum_bytes()
+{
+	return offsetof(MatrixFile::Header, header_checksum);
+}
+
+std::runtime_error invalid(const std::string &path, const std::string &what)
+{
+	return std::runtime_error("Invalid matrix file \"" + path + "\": " + what);
+}
+}
+
+static_assert(sizeof(MatrixFile::Header) <= MatrixFile::HEADER_SIZE,
+              "Header does not fit into HEADER_SIZE");
+
+MatrixFile::Info MatrixFile::Header::info() const
+{
+	Info res;
+	res.content = Content(content);
+	res.ones = ones;
+	res.seed = seed;
+	res.random = flags & FLAG_RANDOM;
+	res.balanced = flags & FLAG_BALANCED;
+	res.unique = flags & FLAG_UNIQUE;
+	return res;
+}
+
+bool MatrixFile::little_endian()
+{
+	const uint16_t x = 1;
+	uint8_t first;
+	std::memcpy(&first, &x, 1);
+	return first == 1;
+}
+
+bool MatrixFile::is_matrix_file(const std::string &path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	char magic[sizeof(MAGIC)];
+	ifs.read(magic, sizeof(magic));
+	return ifs.good() && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+MatrixFile::Header MatrixFile::read_header(const std::string &path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.good()) {
+		throw std::runtime_error("Cannot open \"" + path + "\"");
+	}
+	Header header;
+	ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!ifs.good() ||
+	    std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		throw invalid(path, "no matrix file header");
+	}
+	if (header.byte_order != ORDER_MARK) {
+		throw invalid(path, "written on a machine with another byte order");
+	}
+	if (header.version > VERSION) {
+		throw invalid(path, "unsupported version " +
+		                        std::to_string(header.version));
+	}
+	if (checksum(&header, header_checksum_bytes()) !=
+	    header.header_checksum) {
+		throw invalid(path, "header checksum mismatch");
+	}
+	const uint64_t max_size = std::numeric_limits<uint32_t>::max();
+	const bool dense = header.encoding == uint32_t(Encoding::DENSE);
+	if (header.data_offset < header.header_size || header.rows > max_size ||
+	    header.cols > max_size ||
+	    (dense && header.data_bytes != header.rows * header.row_bytes)) {
+		throw invalid(path, "inconsistent data size");
+	}
+	return header;
+}
+
+uint64_t MatrixFile::checksum(const void *data, size_t bytes)
+{
+	const uint8_t *p = static_cast<const uint8_t *>(data);
+	uint64_t lanes[4] = {PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1};
+	size_t i = 0;
+	for (; i + 32 <= bytes; i += 32) {
+		uint64_t words[4];
+		std::memcpy(words, p + i, sizeof(words));
+		for (size_t k = 0; k < 4; k++) {
+			lanes[k] = mix(lanes[k], words[k]);
+		}
+	}
+	uint64_t res = rotl(lanes[0], 1) + rotl(lanes[1], 7) +
+	               rotl(lanes[2], 12) + rotl(lanes[3], 18);
+	for (; i < bytes; i += 8) {
+		uint64_t word = 0;
+		std::memcpy(&word, p + i, std::min<size_t>(8, bytes - i));
+		res = mix(res, word);
+	}
+	res ^= bytes;
+	res ^= res >> 33;
+	res *= PRIME_2;
+	res ^= res >> 29;
+	return res;
+}
+
+void MatrixFile::Header::seal()
+{
+	header_checksum = checksum(this, header_checksum_bytes());
+}
+
+MatrixFile::Header MatrixFile::make_header(const Info &info, uint64_t rows,
+                                           uint64_t cols)
+{
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.byte_order = ORDER_MARK;
+	header.header_size = sizeof(Header);
+	header.content = uint32_t(info.content);
+	header.encoding = uint32_t(Encoding::DENSE);
+	header.rows = rows;
+	header.cols = cols;
+	header.data_offset = HEADER_SIZE;
+	header.ones = info.ones;
+	header.seed = info.seed;
+	header.flags = (info.random ? FLAG_RANDOM : 0) |
+	               (info.balanced ? FLAG_BALANCED : 0) |
+	               (info.unique ? FLAG_UNIQUE : 0);
+	return header;
+}
+}
@@ -0,0 +1,231 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_MATRIX_FILE_HPP
+#define CPPNAM_UTIL_MATRIX_FILE_HPP
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "util/binary_matrix.hpp"
+
+namespace nam {
+
+/**
+ * File format for sample matrices and trained BiNAMs. A header of
+ * HEADER_SIZE bytes describes the content, followed by the rows of the
+ * matrix exactly as a BinaryMatrix keeps them in memory, i.e. padded to whole
+ * cache lines. read() therefore maps the rows directly from the file instead
+ * of reading them. The header records the cell width and the byte order of
+ * the writer, and checksums of itself and of the data, so a file is never
+ * misinterpreted.
+ *
+ * Files without the header are read in the raw format of
+ * BinaryMatrix::write(), as written by older versions. Sparse pattern sets
+ * use the same header with another encoding, see PatternFileWriter.
+ */
+class MatrixFile {
+public:
+	/**
+	 * Current version of the format
+	 */
+	static constexpr uint32_t VERSION = 1;
+
+	/**
+	 * Size of the header, the data starts at this offset. One page, so the
+	 * mapped rows are page aligned.
+	 */
+	static constexpr size_t HEADER_SIZE = 4096;
+
+	/**
+	 * Kind of matrix stored in a file
+	 */
+	enum class Content : uint32_t { DATA = 1, BINAM = 2 };
+
+	/**
+	 * Encoding of the data: dense rows of cells or blocks of compressed
+	 * indices, see PatternFileWriter
+	 */
+	enum class Encoding : uint32_t { DENSE = 1, SPARSE = 2 };
+
+	/**
+	 * Description of the stored matrix. For sample data the parameters of
+	 * the DataGenerator are recorded, so the data can be regenerated.
+	 */
+	struct Info {
+		Content content = Content::DATA;
+		uint64_t ones = 0;
+		uint64_t seed = 0;
+		bool random = false, balanced = false, unique = false;
+	};
+
+	/**
+	 * On-disk header, written in the byte order of the writer
+	 */
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t header_size;
+		uint32_t cell_bits;
+		uint32_t content;
+		uint32_t encoding;
+		uint64_t rows, cols;
+		uint64_t row_bytes;
+		uint64_t data_offset, data_bytes;
+		uint64_t ones, seed;
+		uint32_t flags;
+		uint32_t block_rows;
+		uint64_t index_offset;
+		uint64_t data_checksum;
+		uint64_t header_checksum;
+
+		/**
+		 * Generator parameters and content recorded in the header
+		 */
+		Info info() const;
+
+		/**
+		 * Computes header_checksum, must be called after the last change
+		 */
+		void seal();
+	};
+
+	/**
+	 * Returns true if the file @param path starts with the header magic.
+	 */
+	static bool is_matrix_file(const std::string &path);
+
+	/**
+	 * Reads and validates the header of @param path. Throws
+	 * std::runtime_error if the file is no matrix file, has an unsupported
+	 * version, was written with another byte order or is corrupted.
+	 */
+	static Header read_header(const std::string &path);
+
+	/**
+	 * Header for a @param rows x @param cols matrix described by
+	 * @param info. The fields describing the data are zero, the encoding is
+	 * DENSE and the data starts at HEADER_SIZE.
+	 */
+	static Header make_header(const Info &info, uint64_t rows, uint64_t cols);
+
+	/**
+	 * 64 bit checksum of @param bytes bytes at @param data. Processes four
+	 * independent words per step, so it runs at several GB/s.
+	 */
+	static uint64_t checksum(const void *data, size_t bytes);
+
+	/**
+	 * Writes @param mat with the description @param info to @param path.
+	 * Throws std::runtime_error on failure.
+	 */
+	template <typename T>
+	static void write(const std::string &path, const BinaryMatrix<T> &mat,
+	                  const Info &info = Info())
+	{
+		const size_t row_bytes = mat.stride() * sizeof(T);
+		const size_t data_bytes = mat.rows() * row_bytes;
+		const char *data = reinterpret_cast<const char *>(mat.row_ptr(0));
+		Header header = make_header(info, mat.rows(), mat.cols());
+		header.cell_bits = BinaryMatrix<T>::intWidth;
+		header.row_bytes = row_bytes;
+		header.data_bytes = data_bytes;
+		header.data_checksum = checksum(data, data_bytes);
+		header.seal();
+
+		std::ofstream ofs(path, std::ios::binary);
+		ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		const std::string padding(HEADER_SIZE - sizeof(header), '\0');
+		ofs.write(padding.data(), padding.size());
+		ofs.write(data, data_bytes);
+		if (!ofs.good()) {
+			throw std::runtime_error("Cannot write \"" + path + "\"");
+		}
+	}
+
+	/**
+	 * Reads the matrix in @param path. The rows of a matrix file are mapped
+	 * privately, so loading takes constant time, pages are read on first
+	 * access and changes of the matrix never reach the file. Unless
+	 * @param verify is false, the data checksum is compared, which reads the
+	 * whole file once. The description is written to @param info if given.
+	 *
+	 * Files with another cell width are accepted on little endian machines,
+	 * where the bit layout of a row does not depend on the cell width.
+	 * Throws std::runtime_error if the file cannot be read or is invalid.
+	 */
+	template <typename T>
+	static BinaryMatrix<T> read(const std::string &path, bool verify = true,
+	                            Info *info = nullptr)
+	{
+		if (!is_matrix_file(path)) {
+			std::ifstream ifs(path, std::ios::binary);
+			if (!ifs.good()) {
+				throw std::runtime_error("Cannot open \"" + path + "\"");
+			}
+			if (info) {
+				*info = Info();
+			}
+			return BinaryMatrix<T>::read(ifs);
+		}
+
+		const Header header = read_header(path);
+		if (header.encoding == uint32_t(Encoding::SPARSE)) {
+			throw std::runtime_error("File \"" + path +
+			                         "\" holds sparse patterns, use "
+			                         "PatternFileReader");
+		}
+		const size_t row_bytes =
+		    BinaryMatrix<T>::rowStride(header.cols) * sizeof(T);
+		if (header.encoding != uint32_t(Encoding::DENSE) ||
+		    header.row_bytes != row_bytes ||
+		    (header.cell_bits != BinaryMatrix<T>::intWidth &&
+		     !little_endian())) {
+			std::stringstream ss;
+			ss << "File \"" << path << "\" with " << header.cell_bits
+			   << " bit cells and " << header.row_bytes
+			   << " bytes per row cannot be read as matrix of "
+			   << BinaryMatrix<T>::intWidth << " bit cells" << std::endl;
+			throw std::runtime_error(ss.str());
+		}
+		auto res = BinaryMatrix<T>::mapped(path, header.rows, header.cols,
+		                                   header.data_offset, false);
+		if (verify && checksum(res.row_ptr(0), header.data_bytes) !=
+		                  header.data_checksum) {
+			throw std::runtime_error("Checksum mismatch in \"" + path + "\"");
+		}
+		if (info) {
+			*info = header.info();
+		}
+		return res;
+	}
+
+private:
+	static bool little_endian();
+};
+}
+
+#endif /* CPPNAM_UTIL_MATRIX_FILE_HPP */
@@ -0,0 +1,295 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "pattern_file.hpp"
+
+namespace nam {
+
+constexpr size_t PatternFileWriter::DEFAULT_BLOCK_ROWS;
+
+namespace {
+void write_varint(std::vector<uint8_t> &dst, uint64_t v)
+{
+	while (v >= 0x80) {
+		dst.push_back(uint8_t(v) | 0x80);
+		v >>= 7;
+	}
+	dst.push_back(uint8_t(v));
+}
+
+/**
+ * Reads a varint from [@param p, @param end), returns false if the data ends
+ * early or the value does not fit into 64 bits
+ */
+bool read_varint(const uint8_t *&p, const uint8_t *end, uint64_t &res)
+{
+	res = 0;
+	for (int shift = 0; shift < 64 && p != end; shift += 7) {
+		const uint8_t byte = *p++;
+		res |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+}
+
+PatternFileWriter::PatternFileWriter(const std::string &path, size_t cols,
+                                     const MatrixFile::Info &info,
+                                     size_t block_rows)
+    : m_path(path),
+      m_ofs(path, std::ios::binary | std::ios::trunc),
+      m_info(info),
+      m_cols(cols),
+      m_block_rows(std::max<size_t>(1, block_rows)),
+      m_pos(MatrixFile::HEADER_SIZE)
+{
+	// The header is written by close(), once the size is known
+	const std::string header(MatrixFile::HEADER_SIZE, '\0');
+	m_ofs.write(header.data(), header.size());
+	if (!m_ofs.good()) {
+		throw std::runtime_error("Cannot write \"" + path + "\"");
+	}
+}
+
+PatternFileWriter::~PatternFileWriter()
+{
+	try {
+		close();
+	}
+	catch (...) {
+	}
+}
+
+PatternFileWriter &PatternFileWriter::add(const uint32_t *idx, size_t n)
+{
+	if (m_closed) {
+		throw std::runtime_error("Pattern file \"" + m_path +
+		                         "\" is already closed");
+	}
+	m_sorted.assign(idx, idx + n);
+	std::sort(m_sorted.begin(), m_sorted.end());
+	for (size_t j = 0; j < n; j++) {
+		if (m_sorted[j] >= m_cols ||
+		    (j > 0 && m_sorted[j] == m_sorted[j - 1])) {
+			std::stringstream ss;
+			ss << "Invalid index " << m_sorted[j] << " in pattern " << m_rows
+			   << " of length " << m_cols << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+	write_varint(m_block, n);
+	for (size_t j = 0; j < n; j++) {
+		write_varint(m_block,
+		             j == 0 ? m_sorted[0] : m_sorted[j] - m_sorted[j - 1] - 1);
+	}
+	if (m_rows == 0) {
+		m_ones = n;
+	}
+	m_same_ones = m_same_ones && n == m_ones;
+	m_rows++;
+	if (++m_block_count == m_block_rows) {
+		flush_block();
+	}
+	return *this;
+}
+
+PatternFileWriter &PatternFileWriter::add(const SparsePatternMatrix &mat)
+{
+	for (size_t i = 0; i < mat.rows(); i++) {
+		add(mat.row_ptr(i), mat.ones());
+	}
+	return *this;
+}
+
+void PatternFileWriter::flush_block()
+{
+	if (m_block_count == 0) {
+		return;
+	}
+	m_index.push_back(
+	    {m_pos, MatrixFile::checksum(m_block.data(), m_block.size())});
+	m_ofs.write(reinterpret_cast<const char *>(m_block.data()),
+	            m_block.size());
+	m_pos += m_block.size();
+	m_block.clear();
+	m_block_count = 0;
+}
+
+void PatternFileWriter::close()
+{
+	if (m_closed) {
+		return;
+	}
+	m_closed = true;
+	flush_block();
+
+	const size_t index_bytes = m_index.size() * sizeof(BlockEntry);
+	m_ofs.write(reinterpret_cast<const char *>(m_index.data()), index_bytes);
+
+	m_info.ones = m_same_ones ? m_ones : 0;
+	MatrixFile::Header header =
+	    MatrixFile::make_header(m_info, m_rows, m_cols);
+	header.encoding = uint32_t(MatrixFile::Encoding::SPARSE);
+	header.block_rows = m_block_rows;
+	header.index_offset = m_pos;
+	header.data_bytes = m_pos + index_bytes - header.data_offset;
+	header.data_checksum = MatrixFile::checksum(m_index.data(), index_bytes);
+	header.seal();
+	m_ofs.seekp(0);
+	m_ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	m_ofs.close();
+	if (!m_ofs.good()) {
+		throw std::runtime_error("Cannot write \"" + m_path + "\"");
+	}
+}
+
+PatternFileReader::PatternFileReader(const std::string &path, bool verify)
+    : m_header(MatrixFile::read_header(path)), m_verify(verify)
+{
+	using Entry = PatternFileWriter::BlockEntry;
+	const size_t n_blocks =
+	    m_header.block_rows
+	        ? (m_header.rows + m_header.block_rows - 1) / m_header.block_rows
+	        : 0;
+	const size_t index_bytes = n_blocks * sizeof(Entry);
+	if (m_header.encoding != uint32_t(MatrixFile::Encoding::SPARSE) ||
+	    (m_header.rows > 0 && m_header.block_rows == 0) ||
+	    m_header.index_offset < m_header.data_offset ||
+	    m_header.index_offset + index_bytes !=
+	        m_header.data_offset + m_header.data_bytes) {
+		throw std::runtime_error("\"" + path + "\" is no valid pattern file");
+	}
+	m_file = AlignedBuffer<uint8_t>::map(path, m_header.index_offset +
+	                                               index_bytes,
+	                                     0, false);
+	m_index.resize(n_blocks);
+	std::memcpy(m_index.data(), m_file.data() + m_header.index_offset,
+	            index_bytes);
+	if (MatrixFile::checksum(m_index.data(), index_bytes) !=
+	    m_header.data_checksum) {
+		throw std::runtime_error("Index checksum mismatch in \"" + path +
+		                         "\"");
+	}
+	for (size_t b = 0; b < n_blocks; b++) {
+		const uint64_t end = b + 1 < n_blocks ? m_index[b + 1].offset
+		                                      : m_header.index_offset;
+		if (m_index[b].offset < m_header.data_offset ||
+		    m_index[b].offset > end) {
+			throw std::runtime_error("Invalid block index in \"" + path +
+			                         "\"");
+		}
+	}
+	m_file.advise(0, m_file.size(), AlignedMemory::Advice::SEQUENTIAL);
+}
+
+std::runtime_error PatternFileReader::corrupted(size_t block) const
+{
+	return std::runtime_error("Pattern block " + std::to_string(block) +
+	                          " is corrupted");
+}
+
+void PatternFileReader::decode_block(size_t b, std::vector<uint32_t> &idx,
+                                     std::vector<size_t> &offs) const
+{
+	if (b >= blocks()) {
+		std::stringstream ss;
+		ss << "Block " << b << " out of range for pattern file with "
+		   << blocks() << " blocks" << std::endl;
+		throw std::out_of_range(ss.str());
+	}
+	const size_t first = m_index[b].offset;
+	const size_t last =
+	    b + 1 < blocks() ? m_index[b + 1].offset : m_header.index_offset;
+	if (b + 1 < blocks()) {
+		const size_t next_last = b + 2 < blocks() ? m_index[b + 2].offset
+		                                          : m_header.index_offset;
+		m_file.advise(last, next_last - last,
+		              AlignedMemory::Advice::WILLNEED);
+	}
+	const uint8_t *p = m_file.data() + first;
+	const uint8_t *end = m_file.data() + last;
+	if (m_verify &&
+	    MatrixFile::checksum(p, last - first) != m_index[b].checksum) {
+		throw corrupted(b);
+	}
+
+	idx.clear();
+	offs.clear();
+	for (size_t i = block_begin(b); i < block_end(b); i++) {
+		offs.push_back(idx.size());
+		uint64_t n, v, cur = 0;
+		if (!read_varint(p, end, n) || n > cols()) {
+			throw corrupted(b);
+		}
+		for (size_t j = 0; j < n; j++) {
+			if (!read_varint(p, end, v)) {
+				throw corrupted(b);
+			}
+			cur = j == 0 ? v : cur + v + 1;
+			if (cur >= cols()) {
+				throw corrupted(b);
+			}
+			idx.push_back(cur);
+		}
+	}
+	offs.push_back(idx.size());
+	if (p != end) {
+		throw corrupted(b);
+	}
+}
+
+SparsePatternMatrix PatternFileReader::sparse_block(size_t b) const
+{
+	std::vector<uint32_t> idx;
+	std::vector<size_t> offs;
+	decode_block(b, idx, offs);
+	SparsePatternMatrix res(block_end(b) - block_begin(b), cols(), ones());
+	for (size_t i = 0; i < res.rows(); i++) {
+		if (offs[i + 1] - offs[i] != ones()) {
+			throw corrupted(b);
+		}
+		res.set_row(i, idx.data() + offs[i]);
+	}
+	return res;
+}
+
+SparsePatternMatrix PatternFileReader::read_sparse() const
+{
+	SparsePatternMatrix res(rows(), cols(), ones());
+	std::vector<uint32_t> idx;
+	std::vector<size_t> offs;
+	for (size_t b = 0; b < blocks(); b++) {
+		decode_block(b, idx, offs);
+		for (size_t i = 0; i + 1 < offs.size(); i++) {
+			if (offs[i + 1] - offs[i] != ones()) {
+				throw corrupted(b);
+			}
+			res.set_row(block_begin(b) + i, idx.data() + offs[i]);
+		}
+	}
+	return res;
+}
+}
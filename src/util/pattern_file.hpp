@@ -0,0 +1,291 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_PATTERN_FILE_HPP
+#define CPPNAM_UTIL_PATTERN_FILE_HPP
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/aligned_buffer.hpp"
+#include "util/binary_matrix.hpp"
+#include "util/matrix_file.hpp"
+#include "util/sparse_pattern_matrix.hpp"
+
+namespace nam {
+
+/**
+ * Writes a set of sparse patterns in the SPARSE encoding of MatrixFile. Each
+ * pattern is stored as the number of set bits followed by the sorted indices,
+ * the first one absolute and every further one as distance to its
+ * predecessor minus one, all as LEB128 varints. A 1600 bit pattern with four
+ * ones takes about 9 instead of 200 bytes. The patterns are grouped into
+ * blocks of block_rows patterns, which can be decoded independently, an index
+ * of the block offsets and checksums follows the last block.
+ *
+ * Patterns are appended one by one, so corpora larger than main memory can
+ * be written while they are generated.
+ */
+class PatternFileWriter {
+public:
+	/**
+	 * Default number of patterns per block
+	 */
+	static constexpr size_t DEFAULT_BLOCK_ROWS = 4096;
+
+	/**
+	 * Offset of a block in the file and checksum of its bytes
+	 */
+	struct BlockEntry {
+		uint64_t offset;
+		uint64_t checksum;
+	};
+
+private:
+	std::string m_path;
+	std::ofstream m_ofs;
+	MatrixFile::Info m_info;
+	size_t m_cols, m_block_rows;
+	size_t m_rows = 0, m_ones = 0;
+	bool m_same_ones = true, m_closed = false;
+	size_t m_pos;
+	std::vector<uint8_t> m_block;
+	size_t m_block_count = 0;
+	std::vector<BlockEntry> m_index;
+	std::vector<uint32_t> m_sorted;
+
+	void flush_block();
+
+public:
+	/**
+	 * Creates the file @param path for patterns of length @param cols.
+	 * @param info is stored in the header, its number of ones is replaced by
+	 * the number of set bits of the patterns if all have the same, by zero
+	 * otherwise. Throws std::runtime_error if the file cannot be created.
+	 */
+	PatternFileWriter(const std::string &path, size_t cols,
+	                  const MatrixFile::Info &info = MatrixFile::Info(),
+	                  size_t block_rows = DEFAULT_BLOCK_ROWS);
+
+	PatternFileWriter(const PatternFileWriter &) = delete;
+	PatternFileWriter &operator=(const PatternFileWriter &) = delete;
+
+	/**
+	 * Calls close(), errors are ignored
+	 */
+	~PatternFileWriter();
+
+	/**
+	 * Appends the pattern with the @param n set bits @param idx, given in any
+	 * order. Throws std::out_of_range if an index is out of range or given
+	 * twice.
+	 */
+	PatternFileWriter &add(const uint32_t *idx, size_t n);
+	PatternFileWriter &add(const std::vector<uint32_t> &idx)
+	{
+		return add(idx.data(), idx.size());
+	}
+
+	/**
+	 * Appends all rows of @param mat
+	 */
+	PatternFileWriter &add(const SparsePatternMatrix &mat);
+	template <typename T>
+	PatternFileWriter &add(const BinaryMatrix<T> &mat)
+	{
+		std::vector<uint32_t> idx;
+		for (size_t i = 0; i < mat.rows(); i++) {
+			mat.active_bits(i, idx);
+			add(idx);
+		}
+		return *this;
+	}
+
+	/**
+	 * Number of patterns added so far
+	 */
+	size_t rows() const { return m_rows; }
+
+	/**
+	 * Writes the last block, the index and the header. Nothing can be added
+	 * afterwards. Throws std::runtime_error on failure.
+	 */
+	void close();
+};
+
+/**
+ * Reads pattern files written by PatternFileWriter. The file is mapped, so
+ * opening it takes constant time, and single blocks are decoded on request.
+ * Large corpora are processed block by block without ever being held in
+ * memory, e.g.
+ *
+ *     for (size_t b = 0; b < in.blocks(); b++) {
+ *         auto recall = binam.recallMat(in.dense_block<uint64_t>(b));
+ *         ...
+ *     }
+ *
+ * While a block is decoded, the kernel is asked to read the next one.
+ */
+class PatternFileReader {
+private:
+	AlignedBuffer<uint8_t> m_file;
+	MatrixFile::Header m_header;
+	std::vector<PatternFileWriter::BlockEntry> m_index;
+	bool m_verify;
+
+	std::runtime_error corrupted(size_t block) const;
+
+public:
+	/**
+	 * Opens the pattern file @param path. The header and the block index are
+	 * always validated, if @param verify is set the checksum of every block
+	 * is compared before it is decoded. Throws std::runtime_error if the file
+	 * is no valid pattern file.
+	 */
+	explicit PatternFileReader(const std::string &path, bool verify = true);
+
+	size_t rows() const { return m_header.rows; }
+	size_t cols() const { return m_header.cols; }
+
+	/**
+	 * Number of set bits in every pattern, zero if it differs between the
+	 * patterns
+	 */
+	size_t ones() const { return m_header.ones; }
+
+	/**
+	 * Number of blocks, patterns per block and the patterns of block
+	 * @param b
+	 */
+	size_t blocks() const { return m_index.size(); }
+	size_t block_rows() const { return m_header.block_rows; }
+	size_t block_begin(size_t b) const { return b * block_rows(); }
+	size_t block_end(size_t b) const
+	{
+		return std::min(rows(), (b + 1) * block_rows());
+	}
+
+	/**
+	 * Description stored in the header
+	 */
+	MatrixFile::Info info() const { return m_header.info(); }
+
+	/**
+	 * Size of the file in bytes
+	 */
+	size_t bytes() const { return m_file.size(); }
+
+	/**
+	 * Decodes block @param b: the indices of all its patterns are written to
+	 * @param idx, pattern i of the block starts at idx[offs[i]] and ends at
+	 * idx[offs[i + 1]]. Both vectors are cleared first, their capacity is
+	 * reused. Throws std::runtime_error if the block is corrupted.
+	 */
+	void decode_block(size_t b, std::vector<uint32_t> &idx,
+	                  std::vector<size_t> &offs) const;
+
+	/**
+	 * Block @param b as sparse matrix, requires ones() to be non-zero
+	 */
+	SparsePatternMatrix sparse_block(size_t b) const;
+
+	/**
+	 * Block @param b as dense matrix
+	 */
+	template <typename T>
+	BinaryMatrix<T> dense_block(size_t b) const
+	{
+		std::vector<uint32_t> idx;
+		std::vector<size_t> offs;
+		decode_block(b, idx, offs);
+		BinaryMatrix<T> res(block_end(b) - block_begin(b), cols());
+		for (size_t i = 0; i + 1 < offs.size(); i++) {
+			for (size_t j = offs[i]; j < offs[i + 1]; j++) {
+				res.set_bit(i, idx[j]);
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Decodes the whole file into a dense matrix
+	 */
+	template <typename T>
+	BinaryMatrix<T> read() const
+	{
+		BinaryMatrix<T> res(rows(), cols());
+		std::vector<uint32_t> idx;
+		std::vector<size_t> offs;
+		for (size_t b = 0; b < blocks(); b++) {
+			decode_block(b, idx, offs);
+			for (size_t i = 0; i + 1 < offs.size(); i++) {
+				for (size_t j = offs[i]; j < offs[i + 1]; j++) {
+					res.set_bit(block_begin(b) + i, idx[j]);
+				}
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Decodes the whole file into a sparse matrix, requires ones() to be
+	 * non-zero
+	 */
+	SparsePatternMatrix read_sparse() const;
+};
+
+/**
+ * Returns true if @param path is a sparse pattern file written by
+ * PatternFileWriter
+ */
+inline bool is_pattern_file(const std::string &path)
+{
+	return MatrixFile::is_matrix_file(path) &&
+	       MatrixFile::read_header(path).encoding ==
+	           uint32_t(MatrixFile::Encoding::SPARSE);
+}
+
+/**
+ * Reads the samples in @param path, decoding sparse pattern files with
+ * PatternFileReader and reading all other files with MatrixFile::read(). The
+ * description is written to @param info if given.
+ */
+template <typename T>
+BinaryMatrix<T> read_pattern_file(const std::string &path,
+                                  MatrixFile::Info *info = nullptr)
+{
+	if (is_pattern_file(path)) {
+		PatternFileReader reader(path);
+		if (info) {
+			*info = reader.info();
+		}
+		return reader.read<T>();
+	}
+	return MatrixFile::read<T>(path, true, info);
+}
+}
+
+#endif /* CPPNAM_UTIL_PATTERN_FILE_HPP */
@@ -27,10 +27,15 @@
 
 namespace nam {
 
+/**
+ * 128 bit cell type, see dispatch_cell_type()
+ */
+__extension__ typedef unsigned __int128 uint128_t;
+
 template <typename T>
 size_t population_count(T i)
 {
-	size_t res;
+	size_t res = 0;
 	for (size_t j = 0; j < sizeof(T) * 8; j++) {
 		res += (i & (T(1) << j)) ? 1 : 0;
 	}
@@ -84,6 +89,30 @@ inline size_t population_count<uint64_t>(uint64_t i)
 {
 	return __builtin_popcountll(i);
 }
+
+template <>
+inline size_t population_count<uint128_t>(uint128_t i)
+{
+	return __builtin_popcountll(uint64_t(i)) +
+	       __builtin_popcountll(uint64_t(i >> 64));
+}
+
+/**
+ * Returns the index of the least significant set bit in @param i. The result
+ * is undefined if no bit is set.
+ */
+template <typename T>
+inline size_t trailing_zeros(T i)
+{
+	return __builtin_ctzll(uint64_t(i));
+}
+
+template <>
+inline size_t trailing_zeros<uint128_t>(uint128_t i)
+{
+	return uint64_t(i) ? __builtin_ctzll(uint64_t(i))
+	                   : 64 + __builtin_ctzll(uint64_t(i >> 64));
+}
 }
 
 #endif /* CPPNAM_POPULATION_COUNT_HPP */
@@ -0,0 +1,210 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_SPARSE_PATTERN_MATRIX_HPP
+#define CPPNAM_UTIL_SPARSE_PATTERN_MATRIX_HPP
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "util/binary_matrix.hpp"
+#include "util/bitops.hpp"
+
+namespace nam {
+
+/**
+ * Matrix of sparse binary patterns with the same number of set bits in every
+ * row, e.g. the input or output samples of a BiNAM. Only the indices of the
+ * set bits are stored, sorted ascending and contiguous for all rows, so a row
+ * is scanned in O(ones). For 1600 bit patterns with four ones this needs 16
+ * instead of 200 bytes per row.
+ */
+class SparsePatternMatrix {
+private:
+	std::vector<uint32_t> m_idx;
+	size_t m_rows = 0, m_cols = 0, m_ones = 0;
+
+	void check_row(size_t row) const
+	{
+		if (row >= m_rows) {
+			std::stringstream ss;
+			ss << "Row " << row << " out of range for matrix with " << m_rows
+			   << " rows" << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+	}
+
+public:
+	/**
+	 * Default constructor. Creates an empty matrix.
+	 */
+	SparsePatternMatrix() = default;
+
+	/**
+	 * Creates a matrix of @param rows patterns of length @param cols with
+	 * @param ones set bits each. The rows have to be written with set_row()
+	 * before they are used, initially they contain the indices 0 ... ones-1.
+	 */
+	SparsePatternMatrix(size_t rows, size_t cols, size_t ones)
+	    : m_idx(rows * ones), m_rows(rows), m_cols(cols), m_ones(ones)
+	{
+		if (ones > cols) {
+			std::stringstream ss;
+			ss << ones << " ones do not fit into patterns of length " << cols
+			   << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		for (size_t i = 0; i < rows; i++) {
+			for (size_t j = 0; j < ones; j++) {
+				m_idx[i * ones + j] = j;
+			}
+		}
+	}
+
+	size_t rows() const { return m_rows; }
+	size_t cols() const { return m_cols; }
+	size_t size() const { return m_rows * m_cols; }
+
+	/**
+	 * Number of set bits in every row
+	 */
+	size_t ones() const { return m_ones; }
+
+	/**
+	 * Sorted indices of the bits set in row @param row, ones() entries
+	 */
+	const uint32_t *row_ptr(size_t row) const
+	{
+		return m_idx.data() + row * m_ones;
+	}
+	const uint32_t *row_begin(size_t row) const { return row_ptr(row); }
+	const uint32_t *row_end(size_t row) const { return row_ptr(row) + m_ones; }
+
+	/**
+	 * Overwrites row @param row with the ones() indices at @param idx, in any
+	 * order. Throws std::out_of_range if an index is out of range or given
+	 * twice.
+	 */
+	SparsePatternMatrix &set_row(size_t row, const uint32_t *idx)
+	{
+		check_row(row);
+		uint32_t *dst = m_idx.data() + row * m_ones;
+		std::copy(idx, idx + m_ones, dst);
+		std::sort(dst, dst + m_ones);
+		for (size_t j = 0; j < m_ones; j++) {
+			if (dst[j] >= m_cols || (j > 0 && dst[j] == dst[j - 1])) {
+				std::stringstream ss;
+				ss << "Invalid index " << dst[j] << " in row " << row
+				   << " of a matrix with " << m_cols << " columns"
+				   << std::endl;
+				throw std::out_of_range(ss.str());
+			}
+		}
+		return *this;
+	}
+
+	SparsePatternMatrix &set_row(size_t row, const std::vector<uint32_t> &idx)
+	{
+		if (idx.size() != m_ones) {
+			std::stringstream ss;
+			ss << "Got " << idx.size() << " indices for row " << row
+			   << ", expected " << m_ones << std::endl;
+			throw std::out_of_range(ss.str());
+		}
+		return set_row(row, idx.data());
+	}
+
+	/**
+	 * Returns true if bit @param col of row @param row is set, in
+	 * O(log ones)
+	 */
+	bool get_bit(size_t row, size_t col) const
+	{
+		return std::binary_search(row_begin(row), row_end(row), col);
+	}
+
+	/**
+	 * Writes row @param row to @param res, which must have cols() bits
+	 */
+	template <typename T>
+	void row_into(size_t row, const RowView<T> &res) const
+	{
+		res.clear();
+		for (const uint32_t *p = row_begin(row); p != row_end(row); p++) {
+			res.set_bit(*p);
+		}
+	}
+
+	/**
+	 * Converts the matrix into a dense BinaryMatrix
+	 */
+	template <typename T>
+	BinaryMatrix<T> toBinaryMatrix() const
+	{
+		BinaryMatrix<T> res(m_rows, m_cols);
+		for (size_t i = 0; i < m_rows; i++) {
+			row_into(i, res.row(i));
+		}
+		return res;
+	}
+
+	/**
+	 * Converts the dense matrix @param mat, all rows must have the same
+	 * number of set bits. Throws std::out_of_range otherwise.
+	 */
+	template <typename T>
+	static SparsePatternMatrix fromBinaryMatrix(const BinaryMatrix<T> &mat)
+	{
+		const size_t n_cells = mat.numberOfCells(mat.cols());
+		const size_t ones =
+		    mat.rows() > 0 ? BitOps::popcount(mat.row_ptr(0), n_cells) : 0;
+		SparsePatternMatrix res(mat.rows(), mat.cols(), ones);
+		std::vector<uint32_t> idx;
+		for (size_t i = 0; i < mat.rows(); i++) {
+			mat.active_bits(i, idx);
+			res.set_row(i, idx);
+		}
+		return res;
+	}
+
+	/**
+	 * Drops all rows from @param rows on
+	 */
+	void truncate(size_t rows)
+	{
+		if (rows < m_rows) {
+			m_rows = rows;
+			m_idx.resize(rows * m_ones);
+		}
+	}
+
+	/**
+	 * Number of bytes used by the indices
+	 */
+	size_t memory() const { return m_idx.size() * sizeof(uint32_t); }
+};
+}
+
+#endif /* CPPNAM_UTIL_SPARSE_PATTERN_MATRIX_HPP */
@@ -0,0 +1,173 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "thread_pool.hpp"
+
+namespace nam {
+
+constexpr const char *ThreadPool::ENV_THREADS;
+
+ThreadPool::ThreadPool(size_t threads)
+{
+	if (threads == 0) {
+		threads = default_threads();
+	}
+	for (size_t i = 1; i < threads; i++) {
+		m_workers.emplace_back([this]() { worker(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cond.notify_all();
+	for (auto &t : m_workers) {
+		t.join();
+	}
+}
+
+void ThreadPool::worker()
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cond.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty()) {
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+size_t ThreadPool::default_threads()
+{
+	const char *env = std::getenv(ENV_THREADS);
+	if (env && *env) {
+		size_t pos = 0;
+		unsigned long threads = 0;
+		try {
+			threads = std::stoul(env, &pos);
+		}
+		catch (...) {
+			pos = 0;
+		}
+		if (pos == 0 || env[pos] != '\0' || threads == 0) {
+			throw std::invalid_argument(std::string("Invalid value \"") + env +
+			                            "\" for " + ENV_THREADS);
+		}
+		return threads;
+	}
+	return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared(size_t threads)
+{
+	static std::mutex mutex;
+	static std::shared_ptr<ThreadPool> pool;
+	if (threads == 0) {
+		threads = default_threads();
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!pool || pool->threads() != threads) {
+		pool = std::make_shared<ThreadPool>(threads);
+	}
+	return pool;
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t align,
+                              const std::function<void(size_t, size_t)> &f)
+{
+	if (begin >= end) {
+		return;
+	}
+
+	// Several blocks per thread, so uneven blocks are balanced out
+	align = std::max<size_t>(align, 1);
+	const size_t n_split = 4 * threads();
+	size_t block = (end - begin + n_split - 1) / n_split;
+	block = ((block + align - 1) / align) * align;
+	const size_t n_blocks = (end - begin + block - 1) / block;
+	if (n_blocks == 1 || m_workers.empty()) {
+		f(begin, end);
+		return;
+	}
+
+	// The state is shared with the helper tasks, which may only get to run
+	// after all blocks are done. These do not touch f anymore.
+	struct State {
+		std::atomic<size_t> next{0};
+		std::atomic<bool> failed{false};
+		size_t done = 0;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable cond;
+	};
+	auto state = std::make_shared<State>();
+	auto run = [state, &f, begin, end, block, n_blocks]() {
+		size_t b;
+		while ((b = state->next++) < n_blocks) {
+			if (!state->failed) {
+				try {
+					f(begin + b * block,
+					  std::min(end, begin + (b + 1) * block));
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (!state->error) {
+						state->error = std::current_exception();
+					}
+					state->failed = true;
+				}
+			}
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (++state->done == n_blocks) {
+				state->cond.notify_all();
+			}
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < std::min(m_workers.size(), n_blocks - 1); i++) {
+			m_tasks.emplace_back(run);
+		}
+	}
+	m_cond.notify_all();
+	run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->cond.wait(lock, [&]() { return state->done == n_blocks; });
+	if (state->error) {
+		std::rethrow_exception(state->error);
+	}
+}
+}
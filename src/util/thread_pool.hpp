@@ -0,0 +1,115 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef CPPNAM_UTIL_THREAD_POOL_HPP
+#define CPPNAM_UTIL_THREAD_POOL_HPP
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nam {
+
+/**
+ * Simple pool of worker threads used to split loops over independent blocks
+ * (e.g. rows of a BinaryMatrix) onto several cores. The thread calling
+ * parallel_for() takes part in the work, so nested calls and calls from
+ * within a worker cannot deadlock. A pool with a single thread does not start
+ * any worker and runs everything in the calling thread.
+ */
+class ThreadPool {
+private:
+	std::vector<std::thread> m_workers;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_stop = false;
+
+	void worker();
+
+public:
+	/**
+	 * Name of the environment variable overriding the default thread count.
+	 */
+	static constexpr const char *ENV_THREADS = "CPPNAM_THREADS";
+
+	/**
+	 * Creates a pool with @param threads threads including the calling
+	 * thread. A value of zero selects default_threads().
+	 */
+	explicit ThreadPool(size_t threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * Number of threads working on a parallel_for(), including the caller.
+	 */
+	size_t threads() const { return m_workers.size() + 1; }
+
+	/**
+	 * Default number of threads: the value of the environment variable
+	 * CPPNAM_THREADS if set, otherwise the number of hardware threads.
+	 */
+	static size_t default_threads();
+
+	/**
+	 * Returns a pool shared by the whole process with @param threads threads
+	 * (zero selects default_threads()). The pool is only recreated if a
+	 * different number of threads is requested.
+	 */
+	static std::shared_ptr<ThreadPool> shared(size_t threads = 0);
+
+	/**
+	 * Calls @param f(block_begin, block_end) for disjoint blocks covering
+	 * [begin, end) and returns when all blocks are done. Apart from the first
+	 * and last one, all block boundaries are multiples of @param align
+	 * relative to begin, e.g. the cell width if blocks must not share a cell.
+	 * The first exception thrown by @param f is rethrown in the caller.
+	 */
+	void parallel_for(size_t begin, size_t end, size_t align,
+	                  const std::function<void(size_t, size_t)> &f);
+};
+
+/**
+ * Runs parallel_for() on @param pool, or @param f(begin, end) in the calling
+ * thread if no pool is given.
+ */
+inline void parallel_for(ThreadPool *pool, size_t begin, size_t end,
+                         size_t align,
+                         const std::function<void(size_t, size_t)> &f)
+{
+	if (pool) {
+		pool->parallel_for(begin, end, align, f);
+	}
+	else if (begin < end) {
+		f(begin, end);
+	}
+}
+}
+
+#endif /* CPPNAM_UTIL_THREAD_POOL_HPP */
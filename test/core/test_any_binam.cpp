@@ -0,0 +1,179 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <core/any_binam.hpp>
+#include <core/binam.hpp>
+#include <core/parameters.hpp>
+
+namespace nam {
+
+TEST(AnyBiNAM, dispatch)
+{
+	EXPECT_EQ(std::vector<size_t>({32, 64, 128}), cell_type_widths());
+	size_t bits = 0;
+	auto f = [&](auto tag) {
+		bits = BinaryMatrix<typename decltype(tag)::type>::intWidth;
+	};
+	for (size_t width : cell_type_widths()) {
+		EXPECT_TRUE(dispatch_cell_type(width, f));
+		EXPECT_EQ(width, bits);
+	}
+	EXPECT_FALSE(dispatch_cell_type(16, f));
+	EXPECT_TRUE((dispatch_cell_type<std::tuple<uint8_t>>(8, f)));
+	EXPECT_EQ(8u, bits);
+	EXPECT_ANY_THROW(AnyBiNAM_Container::make(DataParameters(10, 10, 2, 2, 5),
+	                                          16));
+}
+
+TEST(AnyBiNAM, cell_types)
+{
+	// Every cell width gives the results of the 64 bit cells, for the fixed
+	// geometry 100 x 100 and for pattern lengths which are no multiple of
+	// any width
+	for (const auto &params : {DataParameters(100, 100, 3, 3, 300),
+	                           DataParameters(333, 301, 4, 3, 400)}) {
+		BiNAM_Container<uint64_t> ref(params,
+		                              DataGenerationParameters(3, 1, 1, 1));
+		ref.set_up().recall();
+		const auto ref_res = ref.analysis();
+		const auto ref_thresh = ref.analysis_thresholds(1, 4);
+		const auto ref_kwta = ref.kwta(3).recall().analysis();
+		for (size_t bits : cell_type_widths()) {
+			auto binam = AnyBiNAM_Container::make(
+			    params, DataGenerationParameters(3, 1, 1, 1), bits);
+			EXPECT_EQ(bits, binam->cell_bits());
+			binam->set_up().recall();
+			binam->visit([&](auto &cont) {
+				const auto &recall = cont.recall_matrix();
+				ASSERT_EQ(ref.recall_matrix().rows(), recall.rows());
+				for (size_t i = 0; i < recall.rows(); i++) {
+					for (size_t j = 0; j < recall.cols(); j++) {
+						ASSERT_EQ(ref.recall_matrix().get_bit(i, j),
+						          recall.get_bit(i, j));
+					}
+				}
+			});
+			const auto res = binam->analysis();
+			EXPECT_DOUBLE_EQ(ref_res.Info, res.Info);
+			EXPECT_DOUBLE_EQ(ref_res.fp, res.fp);
+			EXPECT_DOUBLE_EQ(ref_res.synapses, res.synapses);
+			EXPECT_DOUBLE_EQ(ref_res.max_out, res.max_out);
+			EXPECT_DOUBLE_EQ(ref_res.fp, binam->recall_analysis().fp);
+			const auto thresh = binam->analysis_thresholds(1, 4);
+			ASSERT_EQ(ref_thresh.size(), thresh.size());
+			for (size_t k = 0; k < thresh.size(); k++) {
+				EXPECT_DOUBLE_EQ(ref_thresh[k].fp, thresh[k].fp);
+				EXPECT_DOUBLE_EQ(ref_thresh[k].fn, thresh[k].fn);
+			}
+			EXPECT_DOUBLE_EQ(ref_res.fp,
+			                 binam->input_major().recall().analysis().fp);
+			EXPECT_DOUBLE_EQ(
+			    ref_res.fp,
+			    binam->input_major(false).fixed(false).recall().analysis().fp);
+			const auto kwta = binam->kwta(3).recall().analysis();
+			EXPECT_DOUBLE_EQ(ref_kwta.fp, kwta.fp);
+			EXPECT_DOUBLE_EQ(ref_kwta.fn, kwta.fn);
+		}
+	}
+}
+
+TEST(AnyBiNAM, width_independent)
+{
+	// The width chosen by CellCalibration::select() may differ between runs,
+	// so every width has to give exactly the same results
+	const DataParameters params(257, 190, 4, 3, 350);
+	const DataGenerationParameters datagen(7, 1, 1, 1);
+	auto run = [&](size_t bits) {
+		auto binam = AnyBiNAM_Container::make(params, datagen, bits);
+		binam->set_up().recall();
+		return std::make_pair(binam->false_bits(), binam->analysis());
+	};
+	const auto ref = run(cell_type_widths()[0]);
+	auto widths = cell_type_widths();
+	widths.push_back(0);
+	for (size_t bits : widths) {
+		const auto res = run(bits);
+		ASSERT_EQ(ref.first.size(), res.first.size());
+		for (size_t i = 0; i < res.first.size(); i++) {
+			EXPECT_DOUBLE_EQ(ref.first[i].fp, res.first[i].fp);
+			EXPECT_DOUBLE_EQ(ref.first[i].fn, res.first[i].fn);
+		}
+		EXPECT_DOUBLE_EQ(ref.second.Info, res.second.Info);
+		EXPECT_DOUBLE_EQ(ref.second.fp, res.second.fp);
+		EXPECT_DOUBLE_EQ(ref.second.fn, res.second.fn);
+		EXPECT_DOUBLE_EQ(ref.second.rr, res.second.rr);
+		EXPECT_DOUBLE_EQ(ref.second.fill, res.second.fill);
+		EXPECT_DOUBLE_EQ(ref.second.synapses, res.second.synapses);
+		EXPECT_DOUBLE_EQ(ref.second.max_in, res.second.max_in);
+		EXPECT_DOUBLE_EQ(ref.second.max_out, res.second.max_out);
+	}
+}
+
+TEST(CellCalibration, select)
+{
+	EXPECT_EQ(std::vector<size_t>({32}),
+	          CellCalibration::candidates(DataParameters(16, 12, 2, 2, 10)));
+	EXPECT_EQ(std::vector<size_t>({32, 64}),
+	          CellCalibration::candidates(DataParameters(40, 12, 2, 2, 10)));
+	EXPECT_EQ(std::vector<size_t>({32, 64, 128}),
+	          CellCalibration::candidates(DataParameters(100, 90, 3, 3, 10)));
+
+	// Large networks are benchmarked on a part of the output neurons
+	const DataParameters large(100000, 200000, 10, 20, 100000);
+	const auto bench = CellCalibration::benchmark_params(large);
+	EXPECT_EQ(large.bits_in(), bench.bits_in());
+	EXPECT_EQ(large.ones_in(), bench.ones_in());
+	EXPECT_EQ(CellCalibration::MAX_SAMPLES, bench.samples());
+	EXPECT_GT(large.bits_out(), bench.bits_out());
+	EXPECT_GE(CellCalibration::MAX_BYTES,
+	          bench.bits_out() * BinaryMatrix<uint64_t>::rowStride(100000) *
+	              sizeof(uint64_t));
+	EXPECT_LE(1u, bench.ones_out());
+
+	const DataParameters params(100, 90, 3, 3, 200);
+	const auto timings = CellCalibration::benchmark(params);
+	ASSERT_EQ(3u, timings.size());
+	for (const auto &t : timings) {
+		EXPECT_LT(0.0, t.seconds);
+	}
+	CellCalibration::clear();
+	const size_t bits = CellCalibration::select(params);
+	EXPECT_NE(0u, std::count_if(
+	                  timings.begin(), timings.end(),
+	                  [bits](const CellCalibration::Timing &t) {
+		                  return t.bits == bits;
+		              }));
+	EXPECT_EQ(bits, CellCalibration::select(params));
+	EXPECT_EQ(bits, AnyBiNAM_Container::make(params)->cell_bits());
+	EXPECT_EQ(32u, CellCalibration::select(DataParameters(16, 12, 2, 2, 10)));
+
+	setenv(CellCalibration::ENV_CELL_BITS, "128", 1);
+	EXPECT_EQ(128u, CellCalibration::select(params));
+	setenv(CellCalibration::ENV_CELL_BITS, "7", 1);
+	EXPECT_THROW(CellCalibration::select(params), std::invalid_argument);
+	unsetenv(CellCalibration::ENV_CELL_BITS);
+	EXPECT_EQ(bits, CellCalibration::select(params));
+}
+}
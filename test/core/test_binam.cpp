@@ -18,6 +18,9 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <random>
+
 #include <core/binam.hpp>
 #include <core/entropy.hpp>
 #include <core/parameters.hpp>
@@ -561,4 +564,762 @@ TEST(BiNAM, binam5)
 		}
 	}
 }
+TEST(BiNAM, input_major)
+{
+	DataParameters params(100, 70, 4, 3, 200);
+	BinaryMatrix<uint64_t> input =
+	    DataGenerator(size_t(1234)).generate<uint64_t>(params.bits_in(),
+	                                           params.ones_in(),
+	                                           params.samples());
+	BinaryMatrix<uint64_t> output =
+	    DataGenerator(size_t(1239)).generate<uint64_t>(params.bits_out(),
+	                                           params.ones_out(),
+	                                           params.samples());
+	BiNAM<uint64_t> binam(params.bits_out(), params.bits_in());
+	BiNAM<uint64_t> binam_col(params.bits_out(), params.bits_in(), true);
+	binam.train_mat(input, output);
+	binam_col.train_mat(input, output);
+	EXPECT_FALSE(binam.input_major());
+	EXPECT_TRUE(binam_col.input_major());
+
+	// Enabling the mode after training has to yield the same results
+	BiNAM<uint64_t> binam_late = binam;
+	binam_late.input_major(true);
+
+	auto res = binam.recallMat(input);
+	auto res_col = binam_col.recallMat(input);
+	auto res_late = binam_late.recallMat(input);
+	for (size_t i = 0; i < res.rows(); i++) {
+		for (size_t j = 0; j < res.cols(); j++) {
+			EXPECT_EQ(res.get_bit(i, j), res_col.get_bit(i, j));
+			EXPECT_EQ(res.get_bit(i, j), res_late.get_bit(i, j));
+		}
+	}
+
+	// Threshold recall via the vertical counters on the columns
+	for (size_t thresh : {1, 2, 4, 5}) {
+		for (size_t i = 0; i < input.rows(); i += 7) {
+			auto vec = binam.recall(input.row_vec(i), thresh);
+			auto vec_col = binam_col.recall(input.row_vec(i), thresh);
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(vec.get_bit(j), vec_col.get_bit(j));
+			}
+		}
+	}
+
+	// Threshold recall against the dendritic sums computed bit by bit, for
+	// training patterns and for the OR of two of them
+	BiNAM<uint64_t> binam_sum = binam;
+	binam_sum.summaries(true);
+	for (size_t thresh : {size_t(0), size_t(1), size_t(3), params.ones_in(),
+	                      params.ones_in() + 1, 2 * params.ones_in() + 1}) {
+		for (size_t i = 0; i + 1 < input.rows(); i += 11) {
+			BinaryVector<uint64_t> in = input.row_vec(i);
+			if (i % 2) {
+				for (size_t k = 0; k < params.bits_in(); k++) {
+					if (input.get_bit(i + 1, k)) {
+						in.set_bit(k);
+					}
+				}
+			}
+			for (auto *b : {&binam, &binam_col, &binam_sum}) {
+				auto vec = b->recall(in, thresh);
+				for (size_t j = 0; j < params.bits_out(); j++) {
+					size_t sum = 0;
+					for (size_t k = 0; k < params.bits_in(); k++) {
+						sum += in.get_bit(k) && b->get_bit(j, k);
+					}
+					ASSERT_EQ(sum >= thresh, vec.get_bit(j));
+				}
+			}
+		}
+	}
+
+	// Empty input recalls every output neuron
+	BinaryVector<uint64_t> empty(params.bits_in());
+	EXPECT_EQ(params.bits_out(), binam_col.digit_sum(binam_col.recall(empty)));
+
+	BiNAM_Container<uint8_t> cont(DataParameters(10, 10, 3, 3, 10));
+	cont.input_major();
+	EXPECT_TRUE(cont.trained_matrix().input_major());
+}
+TEST(BiNAM, train_idx)
+{
+	BinaryMatrix<uint8_t> input(3, 20), output(3, 10);
+	input.set_bit(0, 1).set_bit(0, 9).set_bit(1, 17).set_bit(2, 0).set_bit(
+	    2, 19);
+	output.set_bit(0, 0).set_bit(0, 8).set_bit(1, 9).set_bit(2, 3);
+
+	BiNAM<uint8_t> binam(10, 20), binam_idx(10, 20, true);
+	binam.train_mat(input, output);
+
+	std::vector<uint32_t> idx_in, idx_out;
+	for (size_t i = 0; i < input.rows(); i++) {
+		input.active_bits(i, idx_in);
+		output.active_bits(i, idx_out);
+		binam_idx.train_idx(idx_in, idx_out);
+	}
+	input.active_bits(0, idx_in);
+	EXPECT_EQ(std::vector<uint32_t>({1, 9}), idx_in);
+	for (size_t i = 0; i < binam.rows(); i++) {
+		for (size_t j = 0; j < binam.cols(); j++) {
+			EXPECT_EQ(binam.get_bit(i, j), binam_idx.get_bit(i, j));
+		}
+	}
+	EXPECT_TRUE(binam.get_bit(9, 17));
+	EXPECT_TRUE(binam.get_bit(3, 19));
+	EXPECT_FALSE(binam.get_bit(3, 17));
+	EXPECT_TRUE(binam_idx.recall(input.row_vec(1)).get_bit(9));
+
+	EXPECT_ANY_THROW(binam_idx.train_idx({20}, {0}));
+	EXPECT_ANY_THROW(binam_idx.train_idx({0}, {10}));
+}
+TEST(BiNAM, recall_batched)
+{
+	// More samples than fit into one tile, odd sizes to check the padding
+	DataParameters params(131, 77, 5, 3, 150);
+	BinaryMatrix<uint16_t> input =
+	    DataGenerator(size_t(4321)).generate<uint16_t>(
+	        params.bits_in(), params.ones_in(), params.samples());
+	BinaryMatrix<uint16_t> output =
+	    DataGenerator(size_t(4326)).generate<uint16_t>(
+	        params.bits_out(), params.ones_out(), params.samples());
+	input.set_bit(149, 0).set_bit(149, 130);  // One sample with more bits
+	BiNAM<uint16_t> binam(params.bits_out(), params.bits_in());
+	binam.train_mat(input, output);
+
+	auto res = binam.recallMat(input);
+	ASSERT_EQ(input.rows(), res.rows());
+	ASSERT_EQ(params.bits_out(), res.cols());
+	for (size_t i = 0; i < input.rows(); i++) {
+		auto vec = binam.recall(input.row_vec(i));
+		for (size_t j = 0; j < params.bits_out(); j++) {
+			EXPECT_EQ(vec.get_bit(j), res.get_bit(i, j));
+		}
+	}
+	for (size_t thresh : {0, 1, 3, 5, 6}) {
+		auto res_th = binam.recallMat(input, thresh);
+		for (size_t i = 0; i < input.rows(); i++) {
+			auto vec = binam.recall(input.row_vec(i), thresh);
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(vec.get_bit(j), res_th.get_bit(i, j));
+			}
+		}
+	}
+}
+TEST(BiNAM, false_bits_thresholds)
+{
+	DataParameters params(90, 70, 4, 3, 120);
+	BiNAM_Container<uint64_t> cont(params,
+	                               DataGenerationParameters(7, 1, 1, 1));
+	cont.set_up();
+	// Disturb some samples to get false negatives as well
+	BinaryMatrix<uint64_t> input = cont.input_matrix();
+	input.set_bit(0, 89).set_bit(3, 0).set_bit(3, 1);
+
+	auto se = cont.trained_matrix().false_bits_thresholds(
+	    input, cont.output_matrix(), 0, 6);
+	ASSERT_EQ(7u, se.size());
+	for (size_t thresh = 0; thresh <= 6; thresh++) {
+		BiNAM<uint64_t> binam = cont.trained_matrix();
+		auto se_ref = binam.false_bits_mat(cont.output_matrix(),
+		                                   binam.recallMat(input, thresh));
+		ASSERT_EQ(se_ref.size(), se[thresh].size());
+		for (size_t i = 0; i < se_ref.size(); i++) {
+			EXPECT_EQ(se_ref[i].fp, se[thresh][i].fp);
+			EXPECT_EQ(se_ref[i].fn, se[thresh][i].fn);
+		}
+	}
+
+	auto res = cont.analysis_thresholds(3, 4);
+	ASSERT_EQ(2u, res.size());
+	cont.recall();
+	auto res_exact = cont.analysis();
+	EXPECT_EQ(res_exact.fp, res[1].fp);
+	EXPECT_EQ(res_exact.fn, res[1].fn);
+	EXPECT_DOUBLE_EQ(res_exact.Info, res[1].Info);
+	EXPECT_LE(res[1].fp, res[0].fp);
+}
+TEST(BiNAM, recall_kwta)
+{
+	BiNAM<uint8_t> binam(10, 10);
+	binam.set_bit(0, 0).set_bit(0, 1).set_bit(0, 2);  // sum 3
+	binam.set_bit(1, 0).set_bit(1, 1);                // sum 2
+	binam.set_bit(2, 1).set_bit(2, 2);                // sum 2
+	binam.set_bit(3, 2);                              // sum 1
+	binam.set_bit(9, 5);                              // sum 0
+	BinaryVector<uint8_t> in(10);
+	in.set_bit(0).set_bit(1).set_bit(2);
+	BiNAM<uint8_t> binam_col = binam;
+	binam_col.input_major(true);
+
+	for (auto *b : {&binam, &binam_col}) {
+		auto res1 = b->recall_kwta(in, 1);
+		EXPECT_EQ(1u, b->digit_sum(res1));
+		EXPECT_TRUE(res1.get_bit(0));
+
+		// Ties at the k-th largest sum are all activated
+		auto res2 = b->recall_kwta(in, 2);
+		EXPECT_EQ(3u, b->digit_sum(res2));
+		EXPECT_TRUE(res2.get_bit(1));
+		EXPECT_TRUE(res2.get_bit(2));
+
+		// Neurons without any input never fire
+		auto res10 = b->recall_kwta(in, 10);
+		EXPECT_EQ(4u, b->digit_sum(res10));
+		EXPECT_FALSE(res10.get_bit(9));
+
+		EXPECT_EQ(0u, b->digit_sum(b->recall_kwta(in, 0)));
+		EXPECT_EQ(0u,
+		          b->digit_sum(b->recall_kwta(BinaryVector<uint8_t>(10), 3)));
+		EXPECT_THROW(b->recall_kwta(BinaryVector<uint8_t>(30), 3),
+		             std::out_of_range);
+		EXPECT_THROW(b->recall_kwta(BinaryVector<uint8_t>(9), 3),
+		             std::out_of_range);
+	}
+
+	// Incomplete inputs: exact recall fails, k-WTA recovers the pattern
+	DataParameters params(100, 100, 6, 6, 50);
+	BiNAM_Container<uint64_t> cont(params,
+	                               DataGenerationParameters(11, 1, 1, 1));
+	cont.set_up();
+	BinaryMatrix<uint64_t> noisy = cont.input_matrix();
+	for (size_t i = 0; i < noisy.rows(); i++) {
+		std::vector<uint32_t> idx;
+		noisy.active_bits(i, idx);
+		noisy.set_bit(i, idx[0], false).set_bit(i, idx[1], false);
+	}
+	BiNAM<uint64_t> binam_cont = cont.trained_matrix();
+	auto res = binam_cont.recallMat_kwta(noisy, 6);
+	auto res_single = binam_cont.recall_kwta(noisy.row_vec(3), 6);
+	for (size_t j = 0; j < params.bits_out(); j++) {
+		EXPECT_EQ(res.get_bit(3, j), res_single.get_bit(j));
+	}
+	cont.kwta(params.ones_out()).recall();
+	auto se = cont.sum_false_bits(cont.false_bits());
+	EXPECT_EQ(0, se.fn);
+}
+TEST(BiNAM, thread_pool)
+{
+	DataParameters params(300, 200, 4, 3, 500);
+	BiNAM_Container<uint64_t> cont(params,
+	                               DataGenerationParameters(5, 1, 1, 1, 1));
+	cont.set_up().recall();
+	auto pool = std::make_shared<ThreadPool>(4);
+
+	for (bool input_major : {false, true}) {
+		BiNAM<uint64_t> binam(params.bits_out(), params.bits_in(),
+		                      input_major);
+		binam.pool(pool);
+		binam.train_mat(cont.input_matrix(), cont.output_matrix());
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				EXPECT_EQ(cont.trained_matrix().get_bit(i, j),
+				          binam.get_bit(i, j));
+			}
+		}
+		auto res = binam.recallMat(cont.input_matrix());
+		auto res_thresh = binam.recallMat(cont.input_matrix(), 3);
+		auto res_kwta = binam.recallMat_kwta(cont.input_matrix(), 3);
+		BiNAM<uint64_t> seq = cont.trained_matrix();
+		auto ref_thresh = seq.recallMat(cont.input_matrix(), 3);
+		auto ref_kwta = seq.recallMat_kwta(cont.input_matrix(), 3);
+		for (size_t i = 0; i < params.samples(); i++) {
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(cont.recall_matrix().get_bit(i, j),
+				          res.get_bit(i, j));
+				EXPECT_EQ(ref_thresh.get_bit(i, j), res_thresh.get_bit(i, j));
+				EXPECT_EQ(ref_kwta.get_bit(i, j), res_kwta.get_bit(i, j));
+			}
+		}
+		auto se = BiNAM<uint64_t>::false_bits_mat(cont.output_matrix(), res, 0,
+		                                          pool.get());
+		ASSERT_EQ(cont.false_bits().size(), se.size());
+		for (size_t i = 0; i < se.size(); i++) {
+			EXPECT_EQ(cont.false_bits()[i].fp, se[i].fp);
+			EXPECT_EQ(cont.false_bits()[i].fn, se[i].fn);
+		}
+		auto se_thresh = binam.false_bits_thresholds(
+		    cont.input_matrix(), cont.output_matrix(), 1, 4);
+		auto ref_se_thresh = seq.false_bits_thresholds(
+		    cont.input_matrix(), cont.output_matrix(), 1, 4);
+		for (size_t k = 0; k < se_thresh.size(); k++) {
+			for (size_t i = 0; i < params.samples(); i++) {
+				EXPECT_EQ(ref_se_thresh[k][i].fp, se_thresh[k][i].fp);
+				EXPECT_EQ(ref_se_thresh[k][i].fn, se_thresh[k][i].fn);
+			}
+		}
+	}
+}
+TEST(BiNAM, train_sharded)
+{
+	DataParameters params(150, 130, 4, 3, 400);
+	BiNAM_Container<uint64_t> cont(params,
+	                               DataGenerationParameters(7, 1, 1, 1, 1));
+	cont.set_up().recall();
+	const auto &in = cont.input_matrix();
+	const auto &out = cont.output_matrix();
+	auto expect_equal = [&](const BinaryMatrix<uint64_t> &mat) {
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				EXPECT_EQ(cont.trained_matrix().get_bit(i, j),
+				          mat.get_bit(i, j));
+			}
+		}
+	};
+
+	for (bool input_major : {false, true}) {
+		BiNAM<uint64_t> binam(params.bits_out(), params.bits_in(),
+		                      input_major);
+		binam.pool(std::make_shared<ThreadPool>(3));
+		binam.train_mat_sharded(in, out, 5);
+		expect_equal(binam);
+		auto res = binam.recallMat(in);
+		for (size_t i = 0; i < params.samples(); i++) {
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(cont.recall_matrix().get_bit(i, j),
+				          res.get_bit(i, j));
+			}
+		}
+
+		// Shards trained separately, merged with and without input-major copy
+		BiNAM<uint64_t> a(params.bits_out(), params.bits_in(), input_major);
+		BiNAM<uint64_t> b(params.bits_out(), params.bits_in(), true);
+		a.train_mat(in, out, 0, 123);
+		b.train_mat(in, out, 123, params.samples());
+		a.merge(b);
+		expect_equal(a);
+		EXPECT_EQ(cont.recall_matrix().get_bit(17, 3),
+		          a.recall(in.row_vec(17)).get_bit(3));
+		auto ref = BiNAM<uint64_t>(cont.trained_matrix()).recallMat(in, 2);
+		for (size_t i = 0; i < params.samples(); i++) {
+			auto vec = a.recall(in.row_vec(i), 2);
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(ref.get_bit(i, j), vec.get_bit(j));
+			}
+		}
+	}
+
+	// A merged matrix written to a stream and read back stays the same
+	std::stringstream ss;
+	cont.trained_matrix().write(ss);
+	expect_equal(BiNAM<uint64_t>(BinaryMatrix<uint64_t>::read(ss)));
+
+	BiNAM<uint64_t> wrong(params.bits_out(), params.bits_in() + 1);
+	BiNAM<uint64_t> binam(params.bits_out(), params.bits_in());
+	EXPECT_ANY_THROW(binam.merge(wrong));
+	EXPECT_ANY_THROW(binam.train_mat(in, out, 10, params.samples() + 1));
+}
+TEST(BiNAM, recall_analysis)
+{
+	DataParameters params(120, 100, 3, 3, 700);
+	for (size_t kwta : {0, 3}) {
+		for (size_t threads : {1, 3}) {
+			BiNAM_Container<uint64_t> cont(
+			    params, DataGenerationParameters(3, 1, 1, 1, threads));
+			cont.kwta(kwta).set_up().recall();
+			auto ref = cont.analysis();
+			auto ref_errs = cont.false_bits();
+
+			auto res = cont.recall_analysis(true);
+			EXPECT_EQ(0u, cont.recall_matrix().size());
+			EXPECT_NEAR(ref.Info, res.Info, 1e-9 * ref.Info);
+			EXPECT_EQ(ref.fp, res.fp);
+			EXPECT_EQ(ref.fn, res.fn);
+			ASSERT_EQ(ref_errs.size(), cont.false_bits().size());
+			for (size_t i = 0; i < ref_errs.size(); i++) {
+				EXPECT_EQ(ref_errs[i].fp, cont.false_bits()[i].fp);
+				EXPECT_EQ(ref_errs[i].fn, cont.false_bits()[i].fn);
+			}
+			EXPECT_EQ(res.Info, cont.recall_analysis().Info);
+			EXPECT_TRUE(cont.false_bits().empty());
+		}
+	}
+}
+TEST(BiNAM, row_views)
+{
+	DataParameters params(90, 70, 4, 3, 120);
+	BinaryMatrix<uint32_t> input =
+	    DataGenerator(size_t(77)).generate<uint32_t>(
+	        params.bits_in(), params.ones_in(), params.samples());
+	BinaryMatrix<uint32_t> output =
+	    DataGenerator(size_t(82)).generate<uint32_t>(
+	        params.bits_out(), params.ones_out(), params.samples());
+	BiNAM<uint32_t> binam(params.bits_out(), params.bits_in());
+	binam.train_mat(input, output);
+
+	for (bool input_major : {false, true}) {
+		BiNAM<uint32_t> binam_row(params.bits_out(), params.bits_in(),
+		                          input_major);
+		for (size_t i = 0; i < input.rows(); i++) {
+			binam_row.train_vec_check(input.row(i), output.row(i));
+		}
+		for (size_t i = 0; i < binam.rows(); i++) {
+			for (size_t j = 0; j < binam.cols(); j++) {
+				EXPECT_EQ(binam.get_bit(i, j), binam_row.get_bit(i, j));
+			}
+		}
+
+		// Recall into a reused buffer
+		auto res = binam.recallMat(input);
+		auto res_th = binam.recallMat(input, 3);
+		BinaryVector<uint32_t> vec(params.bits_out());
+		for (size_t i = 0; i < input.rows(); i++) {
+			binam_row.recall_into(input.row(i), vec.row(0));
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(res.get_bit(i, j), vec.get_bit(j));
+			}
+			auto se = BiNAM<uint32_t>::false_bits(output.row(i), vec.row(0));
+			auto se_vec = BiNAM<uint32_t>::false_bits(output.row_vec(i), vec);
+			EXPECT_EQ(se_vec.fp, se.fp);
+			EXPECT_EQ(se_vec.fn, se.fn);
+
+			binam_row.recall_into(input.row(i), 3, vec.row(0));
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				EXPECT_EQ(res_th.get_bit(i, j), vec.get_bit(j));
+			}
+		}
+		EXPECT_ANY_THROW(binam_row.recall_into(output.row(0), vec.row(0)));
+		EXPECT_ANY_THROW(
+		    binam_row.train_vec_check(output.row(0), output.row(0)));
+	}
+}
+TEST(BiNAM, recall_reverse)
+{
+	DataParameters params(100, 150, 4, 3, 300);
+	BinaryMatrix<uint16_t> input =
+	    DataGenerator(size_t(5)).generate<uint16_t>(
+	        params.bits_in(), params.ones_in(), params.samples());
+	BinaryMatrix<uint16_t> output =
+	    DataGenerator(size_t(10)).generate<uint16_t>(
+	        params.bits_out(), params.ones_out(), params.samples());
+
+	// Reference: a matrix trained in the other direction
+	BiNAM<uint16_t> backward(params.bits_in(), params.bits_out());
+	backward.train_mat(output, input);
+	for (bool input_major : {false, true}) {
+		BiNAM<uint16_t> binam(params.bits_out(), params.bits_in(),
+		                      input_major);
+		binam.train_mat(input, output);
+		auto res = binam.recallMat_reverse(output);
+		auto ref = backward.recallMat(output);
+		auto res_th = binam.recallMat_reverse(output, 2);
+		auto ref_th = backward.recallMat(output, 2);
+		ASSERT_EQ(params.samples(), res.rows());
+		ASSERT_EQ(params.bits_in(), res.cols());
+		BinaryVector<uint16_t> vec(params.bits_in());
+		for (size_t i = 0; i < params.samples(); i++) {
+			auto single = binam.recall_reverse(output.row_vec(i));
+			binam.recall_reverse_into(output.row(i), 2, vec.row(0));
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				EXPECT_EQ(ref.get_bit(i, j), res.get_bit(i, j));
+				EXPECT_EQ(ref.get_bit(i, j), single.get_bit(j));
+				EXPECT_EQ(ref_th.get_bit(i, j), res_th.get_bit(i, j));
+				EXPECT_EQ(ref_th.get_bit(i, j), vec.get_bit(j));
+			}
+			// Every stored input pattern is recalled
+			EXPECT_TRUE(BitOps::is_subset(input.row_ptr(i), res.row_ptr(i),
+			                              res.stride()));
+		}
+		EXPECT_ANY_THROW(binam.recallMat_reverse(input));
+		EXPECT_ANY_THROW(binam.recall_reverse(input.row_vec(0)));
+	}
+}
+TEST(BiNAM, sparse_patterns)
+{
+	DataParameters params(300, 200, 4, 3, 500);
+	auto input = DataGenerator(size_t(3)).generate_sparse(
+	    params.bits_in(), params.ones_in(), params.samples());
+	auto output = DataGenerator(size_t(8)).generate_sparse(
+	    params.bits_out(), params.ones_out(), params.samples());
+	auto input_dense = input.toBinaryMatrix<uint32_t>();
+	auto output_dense = output.toBinaryMatrix<uint32_t>();
+	for (bool input_major : {false, true}) {
+		BiNAM<uint32_t> ref(params.bits_out(), params.bits_in(), input_major);
+		BiNAM<uint32_t> binam(params.bits_out(), params.bits_in(),
+		                      input_major);
+		binam.pool(std::make_shared<ThreadPool>(3));
+		ref.train_mat(input_dense, output_dense);
+		binam.train_mat(input, output);
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				ASSERT_EQ(ref.get_bit(i, j), binam.get_bit(i, j));
+			}
+		}
+		auto recall = binam.recallMat(input_dense, 2);
+		auto se_ref = ref.false_bits_mat(output_dense, recall);
+		auto se = binam.false_bits_mat(output, recall);
+		ASSERT_EQ(se_ref.size(), se.size());
+		for (size_t i = 0; i < se.size(); i++) {
+			EXPECT_EQ(se_ref[i].fp, se[i].fp);
+			EXPECT_EQ(se_ref[i].fn, se[i].fn);
+		}
+		EXPECT_ANY_THROW(binam.train_mat(output, input));
+	}
+}
+
+TEST(BiNAM, mapped)
+{
+	DataParameters params(300, 200, 4, 3, 400);
+	auto input = DataGenerator(size_t(3)).generate<uint64_t>(
+	    params.bits_in(), params.ones_in(), params.samples());
+	auto output = DataGenerator(size_t(8)).generate<uint64_t>(
+	    params.bits_out(), params.ones_out(), params.samples());
+	for (bool input_major : {false, true}) {
+		BiNAM<uint64_t> ref(params.bits_out(), params.bits_in(), input_major);
+		BiNAM<uint64_t> binam(
+		    BinaryMatrix<uint64_t>::mapped(params.bits_out(), params.bits_in()),
+		    input_major);
+		EXPECT_TRUE(binam.mapped());
+		binam.pool(std::make_shared<ThreadPool>(3));
+		ref.train_mat(input, output);
+		binam.train_mat(input, output);
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				ASSERT_EQ(ref.get_bit(i, j), binam.get_bit(i, j));
+			}
+		}
+		auto recall_ref = ref.recallMat(input);
+		auto recall = binam.recallMat(input);
+		for (size_t i = 0; i < recall.rows(); i++) {
+			for (size_t j = 0; j < recall.cols(); j++) {
+				ASSERT_EQ(recall_ref.get_bit(i, j), recall.get_bit(i, j));
+			}
+		}
+
+		// Moving must hand over the mapped storage instead of copying it
+		BiNAM<uint64_t> moved(std::move(binam));
+		EXPECT_TRUE(moved.mapped());
+		BiNAM<uint64_t> assigned;
+		assigned = std::move(moved);
+		EXPECT_TRUE(assigned.mapped());
+		EXPECT_EQ(input_major, assigned.input_major());
+		auto recall_moved = assigned.recallMat(input);
+		for (size_t i = 0; i < recall.rows(); i++) {
+			for (size_t j = 0; j < recall.cols(); j++) {
+				ASSERT_EQ(recall_ref.get_bit(i, j),
+				          recall_moved.get_bit(i, j));
+			}
+		}
+	}
+}
+
+TEST(BiNAM, train_stream)
+{
+	const std::string file_in = "test_binam_stream_in.bin";
+	const std::string file_out = "test_binam_stream_out.bin";
+	DataParameters params(300, 200, 4, 3, 500);
+	auto input = DataGenerator(size_t(3)).generate_sparse(
+	    params.bits_in(), params.ones_in(), params.samples());
+	auto output = DataGenerator(size_t(8)).generate_sparse(
+	    params.bits_out(), params.ones_out(), params.samples());
+
+	// Fixed number of ones and varying number of ones
+	for (bool dense : {false, true}) {
+		auto in_dense = input.toBinaryMatrix<uint64_t>();
+		if (dense) {
+			in_dense.set_bit(0, (input.row_ptr(0)[0] + 1) % params.bits_in());
+		}
+		PatternFileWriter(file_in, params.bits_in(), MatrixFile::Info(), 128)
+		    .add(in_dense)
+		    .close();
+		PatternFileWriter(file_out, params.bits_out(), MatrixFile::Info(), 128)
+		    .add(output)
+		    .close();
+		PatternFileReader in(file_in), out(file_out);
+		EXPECT_EQ(dense, in.ones() == 0);
+
+		BiNAM<uint64_t> binam(params.bits_out(), params.bits_in());
+		binam.pool(std::make_shared<ThreadPool>(3));
+		binam.train_stream(in, out);
+		BiNAM<uint64_t> expected(params.bits_out(), params.bits_in());
+		expected.train_mat(in_dense, output.toBinaryMatrix<uint64_t>());
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			for (size_t j = 0; j < params.bits_in(); j++) {
+				ASSERT_EQ(expected.get_bit(i, j), binam.get_bit(i, j));
+			}
+		}
+		EXPECT_ANY_THROW(binam.train_stream(out, in));
+	}
+	std::remove(file_in.c_str());
+	std::remove(file_out.c_str());
+}
+
+template <typename T>
+static void test_summaries()
+{
+	DataParameters params(250, 300, 4, 3, 300);
+	auto input = DataGenerator(size_t(11)).generate<T>(
+	    params.bits_in(), params.ones_in(), params.samples());
+	auto output = DataGenerator(size_t(12)).generate<T>(
+	    params.bits_out(), params.ones_out(), params.samples());
+	auto sparse_in = SparsePatternMatrix::fromBinaryMatrix(input);
+	auto sparse_out = SparsePatternMatrix::fromBinaryMatrix(output);
+
+	// Summaries maintained by every training function
+	BiNAM<T> ref(params.bits_out(), params.bits_in());
+	BiNAM<T> vec(params.bits_out(), params.bits_in());
+	BiNAM<T> mat(params.bits_out(), params.bits_in());
+	BiNAM<T> sparse(params.bits_out(), params.bits_in());
+	BiNAM<T> merged(params.bits_out(), params.bits_in());
+	vec.summaries(true);
+	mat.summaries(true).pool(std::make_shared<ThreadPool>(3));
+	sparse.summaries(true).pool(std::make_shared<ThreadPool>(3));
+	merged.summaries(true);
+	EXPECT_TRUE(vec.summaries());
+	EXPECT_FALSE(ref.summaries());
+	ref.train_mat(input, output);
+	for (size_t i = 0; i < params.samples(); i++) {
+		vec.train_vec_check(input.row(i), output.row(i));
+	}
+	mat.train_mat(input, output);
+	sparse.train_mat(sparse_in, sparse_out);
+	merged.train_mat(input, output, 0, 100);
+	BiNAM<T> part(params.bits_out(), params.bits_in());
+	part.train_mat(input, output, 100, params.samples());
+	merged.merge(part);
+
+	// Queries: trained samples, partial samples and random patterns
+	BinaryMatrix<T> queries(3 * params.samples(), params.bits_in());
+	std::mt19937 gen(3);
+	std::bernoulli_distribution dist(0.02);
+	for (size_t i = 0; i < params.samples(); i++) {
+		queries.row(i).assign(input.row(i));
+		std::vector<uint32_t> idx;
+		input.active_bits(i, idx);
+		queries.set_bit(params.samples() + i, idx[0]);
+		for (size_t j = 0; j < params.bits_in(); j++) {
+			queries.set_bit(2 * params.samples() + i, j, dist(gen));
+		}
+	}
+	BinaryVector<T> expected(params.bits_out()), res(params.bits_out());
+	for (auto binam : {&vec, &mat, &sparse, &merged}) {
+		for (size_t i = 0; i < queries.rows(); i++) {
+			ref.recall_into(queries.row(i), expected.row(0));
+			binam->recall_into(queries.row(i), res.row(0));
+			for (size_t j = 0; j < params.bits_out(); j++) {
+				ASSERT_EQ(expected.get_bit(j), res.get_bit(j));
+			}
+			for (size_t thresh : {0, 1, 3}) {
+				ref.recall_into(queries.row(i), thresh, expected.row(0));
+				binam->recall_into(queries.row(i), thresh, res.row(0));
+				for (size_t j = 0; j < params.bits_out(); j++) {
+					ASSERT_EQ(expected.get_bit(j), res.get_bit(j));
+				}
+			}
+		}
+	}
+	vec.summaries(false);
+	EXPECT_FALSE(vec.summaries());
+	vec.recall_into(queries.row(0), res.row(0));
+	ref.recall_into(queries.row(0), expected.row(0));
+	for (size_t j = 0; j < params.bits_out(); j++) {
+		EXPECT_EQ(expected.get_bit(j), res.get_bit(j));
+	}
+}
+
+TEST(BiNAM, summaries)
+{
+	test_summaries<uint8_t>();
+	test_summaries<uint64_t>();
+}
+
+template <typename T>
+static void expect_counts(const BiNAM<T> &binam)
+{
+	const FillStatistics stats = binam.fill_statistics();
+	std::vector<uint32_t> row_ones(binam.rows(), 0), col_ones(binam.cols(), 0);
+	size_t synapses = 0;
+	for (size_t i = 0; i < binam.rows(); i++) {
+		for (size_t j = 0; j < binam.cols(); j++) {
+			if (binam.get_bit(i, j)) {
+				row_ones[i]++;
+				col_ones[j]++;
+				synapses++;
+			}
+		}
+	}
+	EXPECT_EQ(row_ones, stats.row_ones);
+	EXPECT_EQ(col_ones, stats.col_ones);
+	EXPECT_EQ(synapses, stats.synapses);
+	EXPECT_EQ(synapses, binam.synapses());
+	EXPECT_DOUBLE_EQ(double(synapses) / binam.size(), binam.fill());
+	EXPECT_EQ(*std::max_element(row_ones.begin(), row_ones.end()),
+	          stats.max_row_ones());
+	EXPECT_EQ(*std::max_element(col_ones.begin(), col_ones.end()),
+	          stats.max_col_ones());
+}
+
+template <typename T>
+static void test_fill_statistics()
+{
+	DataParameters params(203, 150, 5, 4, 200);
+	auto input = DataGenerator(size_t(13)).generate<T>(
+	    params.bits_in(), params.ones_in(), params.samples());
+	auto output = DataGenerator(size_t(14)).generate<T>(
+	    params.bits_out(), params.ones_out(), params.samples());
+	auto sparse_in = SparsePatternMatrix::fromBinaryMatrix(input);
+	auto sparse_out = SparsePatternMatrix::fromBinaryMatrix(output);
+
+	// Counts maintained by every training function after recount(), serial
+	// and with thread-local column counts
+	BiNAM<T> vec(params.bits_out(), params.bits_in());
+	BiNAM<T> idx(params.bits_out(), params.bits_in());
+	BiNAM<T> mat(params.bits_out(), params.bits_in());
+	BiNAM<T> mat_serial(params.bits_out(), params.bits_in());
+	BiNAM<T> sparse(params.bits_out(), params.bits_in());
+	BiNAM<T> merged(params.bits_out(), params.bits_in());
+	BiNAM<T> uncounted(params.bits_out(), params.bits_in());
+	for (auto binam : {&vec, &idx, &mat, &mat_serial, &sparse, &merged}) {
+		binam->recount();
+	}
+	expect_counts(vec);
+	EXPECT_EQ(0u, vec.synapses());
+	std::vector<uint32_t> idx_in, idx_out;
+	for (size_t i = 0; i < params.samples(); i++) {
+		vec.train_vec_check(input.row(i), output.row(i));
+		input.active_bits(i, idx_in);
+		output.active_bits(i, idx_out);
+		idx.train_idx(idx_in, idx_out);
+	}
+	mat.pool(std::make_shared<ThreadPool>(3)).train_mat(input, output);
+	mat_serial.train_mat(input, output);
+	uncounted.pool(std::make_shared<ThreadPool>(3)).train_mat(input, output);
+	sparse.pool(std::make_shared<ThreadPool>(3))
+	    .train_mat(sparse_in, sparse_out);
+	merged.train_mat(input, output, 0, 80);
+	BiNAM<T> part(params.bits_out(), params.bits_in());
+	part.train_mat(input, output, 80, params.samples());
+	merged.merge(part);
+	for (auto binam :
+	     {&vec, &idx, &mat, &mat_serial, &sparse, &merged, &uncounted}) {
+		expect_counts(*binam);
+		EXPECT_EQ(vec.synapses(), binam->synapses());
+	}
+	EXPECT_LT(0.0, vec.fill());
+
+	// Matrices from existing data are counted on request
+	BiNAM<T> loaded(static_cast<const BinaryMatrix<T> &>(vec));
+	loaded.pool(std::make_shared<ThreadPool>(3));
+	expect_counts(loaded);
+	loaded.recount().train_vec_check(input.row(0), output.row(1));
+	expect_counts(loaded);
+
+	// The results of the container carry the statistics
+	BiNAM_Container<T> cont(params, DataGenerationParameters(13, 1, 1, 1));
+	cont.set_up().recall();
+	const FillStatistics stats = cont.fill_statistics();
+	const ExpResults res = cont.analysis();
+	EXPECT_DOUBLE_EQ(stats.fill(), res.fill);
+	EXPECT_DOUBLE_EQ(stats.synapses, res.synapses);
+	EXPECT_DOUBLE_EQ(stats.max_row_ones(), res.max_in);
+	EXPECT_DOUBLE_EQ(stats.max_col_ones(), res.max_out);
+	EXPECT_LT(0u, stats.synapses);
+}
+
+TEST(BiNAM, fill_statistics)
+{
+	test_fill_statistics<uint8_t>();
+	test_fill_statistics<uint64_t>();
+}
 }
@@ -0,0 +1,80 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <core/binam.hpp>
+#include <core/capacity_curve.hpp>
+
+namespace nam {
+
+TEST(CapacityCurve, incremental)
+{
+	DataParameters params(96, 80, 3, 3, 600);
+	CapacityCurve<uint64_t> curve(params,
+	                              DataGenerationParameters(17, 1, 1, 1, 1));
+	curve.set_up();
+	EXPECT_EQ(0u, curve.samples());
+
+	std::vector<size_t> checkpoints = {1, 2, 10, 100, 250, 251, 600};
+	auto res = curve.run(checkpoints);
+	ASSERT_EQ(checkpoints.size(), res.size());
+	EXPECT_EQ(600u, curve.samples());
+	for (size_t k = 0; k < checkpoints.size(); k++) {
+		const size_t n = checkpoints[k];
+		BiNAM_Container<uint64_t> cont(DataParameters(params).samples(n));
+		cont.input_matrix(curve.input_matrix().row_range(0, n));
+		cont.output_matrix(curve.output_matrix().row_range(0, n));
+		BiNAM<uint64_t> binam(params.bits_out(), params.bits_in());
+		binam.train_mat(cont.input_matrix(), cont.output_matrix());
+		cont.trained_matrix(binam);
+		auto ref = cont.recall().analysis();
+		EXPECT_NEAR(ref.Info, res[k].Info, 1e-9 * ref.Info);
+		EXPECT_EQ(ref.fp, res[k].fp);
+		EXPECT_EQ(0, res[k].fn);
+		if (n == 600) {
+			for (size_t i = 0; i < n; i++) {
+				EXPECT_EQ(cont.false_bits()[i].fp,
+				          curve.false_positives()[i]);
+			}
+		}
+	}
+	EXPECT_GT(res.back().fp, 0);
+	EXPECT_ANY_THROW(curve.train_until(601));
+}
+
+TEST(CapacityCurve, on_recall)
+{
+	DataParameters params(64, 64, 2, 2, 300);
+	BinaryMatrix<uint64_t> recall(300, 64);
+	CapacityCurve<uint64_t> curve(params,
+	                              DataGenerationParameters(3, 1, 1, 1, 1));
+	curve.on_recall([&](size_t q, uint32_t i) {
+		EXPECT_FALSE(recall.get_bit(q, i));
+		recall.set_bit(q, i);
+	});
+	curve.set_up().train_until(300);
+	auto ref = BiNAM<uint64_t>(curve.trained_matrix())
+	               .recallMat(curve.input_matrix());
+	for (size_t q = 0; q < 300; q++) {
+		for (size_t i = 0; i < 64; i++) {
+			EXPECT_EQ(ref.get_bit(q, i), recall.get_bit(q, i));
+		}
+	}
+}
+}
@@ -0,0 +1,122 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include <core/binam.hpp>
+#include <core/compressed_binam.hpp>
+#include <core/parameters.hpp>
+#include <util/data.hpp>
+#include <util/thread_pool.hpp>
+
+namespace nam {
+
+TEST(CompressedBiNAM, recall)
+{
+	DataParameters params(1000, 700, 4, 3, 400);
+	BinaryMatrix<uint64_t> input =
+	    DataGenerator(size_t(11)).generate<uint64_t>(
+	        params.bits_in(), params.ones_in(), params.samples());
+	BinaryMatrix<uint64_t> output =
+	    DataGenerator(size_t(12)).generate<uint64_t>(
+	        params.bits_out(), params.ones_out(), params.samples());
+	input.set_bit(3, 0).set_bit(3, 999);  // One sample with more bits
+
+	BiNAM<uint64_t> ref(params.bits_out(), params.bits_in());
+	ref.train_mat(input, output);
+	CompressedBiNAM<uint64_t> binam(params.bits_out(), params.bits_in());
+	binam.pool(std::make_shared<ThreadPool>(3));
+	binam.train_mat(input, output);
+	CompressedBiNAM<uint64_t> copy(ref);
+
+	size_t count = 0;
+	for (size_t i = 0; i < params.bits_out(); i++) {
+		for (size_t j = 0; j < params.bits_in(); j++) {
+			ASSERT_EQ(ref.get_bit(i, j), binam.get_bit(i, j));
+			ASSERT_EQ(ref.get_bit(i, j), copy.get_bit(i, j));
+			count += ref.get_bit(i, j);
+		}
+	}
+	EXPECT_EQ(count, binam.count());
+	EXPECT_EQ(0u, binam.containers(CompressedBitmap::Type::BITMAP));
+	auto back = binam.toBiNAM();
+	for (size_t i = 0; i < params.bits_out(); i++) {
+		for (size_t c = 0; c < back.numberOfCells(back.cols()); c++) {
+			ASSERT_EQ(ref.get_cell(i, c), back.get_cell(i, c));
+		}
+	}
+	EXPECT_EQ(count, back.synapses());
+	EXPECT_EQ(ref.fill_statistics().row_ones, back.fill_statistics().row_ones);
+	EXPECT_EQ(ref.fill_statistics().col_ones, back.fill_statistics().col_ones);
+
+	auto res = binam.recallMat(input);
+	auto res_ref = ref.recallMat(input);
+	for (size_t q = 0; q < params.samples(); q++) {
+		auto vec = binam.recall(input.row_vec(q));
+		for (size_t i = 0; i < params.bits_out(); i++) {
+			EXPECT_EQ(res_ref.get_bit(q, i), res.get_bit(q, i));
+			EXPECT_EQ(res_ref.get_bit(q, i), vec.get_bit(i));
+		}
+	}
+	for (size_t thresh : {0, 1, 3, 4}) {
+		auto res_th = binam.recallMat(input, thresh);
+		auto ref_th = ref.recallMat(input, thresh);
+		for (size_t q = 0; q < params.samples(); q++) {
+			auto vec = binam.recall(input.row_vec(q), thresh);
+			for (size_t i = 0; i < params.bits_out(); i++) {
+				EXPECT_EQ(ref_th.get_bit(q, i), res_th.get_bit(q, i));
+				EXPECT_EQ(ref_th.get_bit(q, i), vec.get_bit(i));
+			}
+		}
+	}
+
+	// Training with sparse patterns
+	CompressedBiNAM<uint64_t> sparse(params.bits_out(), params.bits_in());
+	sparse.train_mat(
+	    DataGenerator(size_t(11)).generate_sparse(
+	        params.bits_in(), params.ones_in(), params.samples()),
+	    DataGenerator(size_t(12)).generate_sparse(
+	        params.bits_out(), params.ones_out(), params.samples()));
+	ref = BiNAM<uint64_t>(params.bits_out(), params.bits_in());
+	ref.train_mat(DataGenerator(size_t(11)).generate<uint64_t>(
+	                  params.bits_in(), params.ones_in(), params.samples()),
+	              output);
+	for (size_t i = 0; i < params.bits_out(); i++) {
+		for (size_t j = 0; j < params.bits_in(); j++) {
+			ASSERT_EQ(ref.get_bit(i, j), sparse.get_bit(i, j));
+		}
+	}
+
+	// Large, lightly loaded memory
+	CompressedBiNAM<uint64_t> large(20000, 20000);
+	large.train_mat(DataGenerator(size_t(1), true, false, false)
+	                    .generate_sparse(20000, 10, 100),
+	                DataGenerator(size_t(2), true, false, false)
+	                    .generate_sparse(20000, 10, 100));
+	EXPECT_GT(large.count(), 9900u);  // 100 x 10 x 10 minus overlaps
+	EXPECT_LT(large.memory(), 20000u * 20000u / 8 / 20);
+
+	EXPECT_ANY_THROW(binam.recallMat(output));
+	EXPECT_ANY_THROW(binam.train_mat(output, input));
+	EXPECT_ANY_THROW(binam.recall(output.row_vec(0)));
+}
+}
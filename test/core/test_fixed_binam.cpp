@@ -0,0 +1,166 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include <core/binam.hpp>
+#include <core/fixed_binam.hpp>
+#include <core/parameters.hpp>
+#include <util/data.hpp>
+#include <util/fixed_binary_matrix.hpp>
+#include <util/thread_pool.hpp>
+
+namespace nam {
+
+template <typename T, size_t Outputs, size_t Inputs>
+void test_fixed_binam()
+{
+	DataParameters params(Inputs, Outputs, 4, 3, 200);
+	BinaryMatrix<T> input = DataGenerator(size_t(Inputs)).generate<T>(
+	    params.bits_in(), params.ones_in(), params.samples());
+	BinaryMatrix<T> output = DataGenerator(size_t(Outputs)).generate<T>(
+	    params.bits_out(), params.ones_out(), params.samples());
+	input.set_bit(7, 0).set_bit(7, Inputs - 1);  // One sample with more bits
+
+	BiNAM<T> binam(Outputs, Inputs);
+	binam.train_mat(input, output);
+	FixedBiNAM<T, Outputs, Inputs> fixed;
+	fixed.train_mat(input, output);
+	for (size_t i = 0; i < Outputs; i++) {
+		for (size_t j = 0; j < Inputs; j++) {
+			ASSERT_EQ(binam.get_bit(i, j), fixed.get_bit(i, j));
+		}
+	}
+	FixedBiNAM<T, Outputs, Inputs> copy(binam);
+	auto mat = copy.toBinaryMatrix();
+
+	ThreadPool pool(3);
+	auto ref = binam.recallMat(input);
+	auto res = fixed.recallMat(input, &pool);
+	auto res_copy = copy.recallMat(input);
+	BinaryVector<T> vec(Outputs);
+	for (size_t q = 0; q < input.rows(); q++) {
+		fixed.recall_into(input.row(q), vec.row(0));
+		for (size_t i = 0; i < Outputs; i++) {
+			EXPECT_EQ(ref.get_bit(q, i), res.get_bit(q, i));
+			EXPECT_EQ(ref.get_bit(q, i), res_copy.get_bit(q, i));
+			EXPECT_EQ(ref.get_bit(q, i), vec.get_bit(i));
+		}
+		auto se_ref = BiNAM<T>::false_bits(output.row(q), ref.row(q));
+		auto se = FixedBiNAM<T, Outputs, Inputs>::false_bits(output.row(q),
+		                                                     res.row(q));
+		EXPECT_EQ(se_ref.fp, se.fp);
+		EXPECT_EQ(se_ref.fn, se.fn);
+	}
+	for (size_t thresh : {0, 1, 3, 4}) {
+		auto ref_th = binam.recallMat(input, thresh);
+		auto res_th = fixed.recallMat(input, thresh);
+		for (size_t q = 0; q < input.rows(); q++) {
+			fixed.recall_into(input.row(q), thresh, vec.row(0));
+			for (size_t i = 0; i < Outputs; i++) {
+				EXPECT_EQ(ref_th.get_bit(q, i), res_th.get_bit(q, i));
+				EXPECT_EQ(ref_th.get_bit(q, i), vec.get_bit(i));
+			}
+		}
+	}
+	for (size_t i = 0; i < Outputs; i++) {
+		for (size_t j = 0; j < Inputs; j++) {
+			EXPECT_EQ(binam.get_bit(i, j), mat.get_bit(i, j));
+		}
+	}
+}
+
+TEST(FixedBiNAM, recall)
+{
+	test_fixed_binam<uint64_t, 100, 100>();
+	test_fixed_binam<uint64_t, 384, 256>();
+	test_fixed_binam<uint8_t, 96, 64>();
+	test_fixed_binam<uint16_t, 37, 130>();
+	test_fixed_binam<uint32_t, 70, 33>();
+
+	FixedBiNAM<uint64_t, 10, 20> fixed;
+	EXPECT_THROW(fixed.train_vec(BinaryVector<uint64_t>(21).row(0),
+	                             BinaryVector<uint64_t>(10).row(0)),
+	             std::out_of_range);
+	EXPECT_THROW(fixed.recallMat(BinaryMatrix<uint64_t>(3, 10)),
+	             std::out_of_range);
+	EXPECT_THROW((FixedBiNAM<uint64_t, 10, 20>(BinaryMatrix<uint64_t>(20, 10))),
+	             std::out_of_range);
+}
+
+TEST(FixedBiNAM, dispatch)
+{
+	size_t outputs = 0, inputs = 0;
+	auto f = [&](auto tag) {
+		using Fixed = typename decltype(tag)::type;
+		outputs = Fixed::rows();
+		inputs = Fixed::cols();
+	};
+	EXPECT_TRUE(dispatch_fixed_binam<uint64_t>(384, 256, f));
+	EXPECT_EQ(384u, outputs);
+	EXPECT_EQ(256u, inputs);
+	EXPECT_FALSE(dispatch_fixed_binam<uint64_t>(256, 384, f));
+	EXPECT_EQ(384u, outputs);
+	EXPECT_TRUE(
+	    (dispatch_fixed_binam<uint64_t, std::tuple<FixedSize<3, 5>>>(3, 5, f)));
+	EXPECT_EQ(3u, outputs);
+	EXPECT_EQ(5u, inputs);
+
+	// The container gives the same results with and without FixedBiNAM
+	DataParameters params(100, 100, 3, 3, 300);
+	BiNAM_Container<uint64_t> cont(params,
+	                               DataGenerationParameters(5, 1, 1, 1, 2));
+	cont.set_up().recall();
+	auto ref = cont.recall_matrix();
+	auto ref_errs = cont.false_bits();
+	cont.fixed(false).recall();
+	ASSERT_EQ(ref.rows(), cont.recall_matrix().rows());
+	for (size_t q = 0; q < ref.rows(); q++) {
+		for (size_t i = 0; i < ref.cols(); i++) {
+			EXPECT_EQ(ref.get_bit(q, i), cont.recall_matrix().get_bit(q, i));
+		}
+		EXPECT_EQ(ref_errs[q].fp, cont.false_bits()[q].fp);
+		EXPECT_EQ(ref_errs[q].fn, cont.false_bits()[q].fn);
+	}
+
+	// Training with the FixedBiNAM gives the same storage matrix, also when
+	// training on top of existing synapses
+	BiNAM_Container<uint64_t> dyn(params,
+	                              DataGenerationParameters(5, 1, 1, 1, 2));
+	dyn.fixed(false).set_up().set_up();
+	cont.set_up();
+	for (size_t i = 0; i < params.bits_out(); i++) {
+		for (size_t j = 0; j < params.bits_in(); j++) {
+			ASSERT_EQ(dyn.trained_matrix().get_bit(i, j),
+			          cont.trained_matrix().get_bit(i, j));
+		}
+	}
+	dyn.recall();
+	cont.recall();
+	for (size_t q = 0; q < ref.rows(); q++) {
+		EXPECT_EQ(dyn.false_bits()[q].fp, cont.false_bits()[q].fp);
+		EXPECT_EQ(dyn.false_bits()[q].fn, cont.false_bits()[q].fn);
+	}
+	EXPECT_EQ(dyn.trained_matrix().synapses(),
+	          cont.trained_matrix().synapses());
+}
+}
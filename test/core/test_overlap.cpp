@@ -0,0 +1,152 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include <core/binam.hpp>
+#include <core/overlap.hpp>
+#include <util/data.hpp>
+
+namespace nam {
+
+static size_t shared_bits(const BinaryMatrix<uint64_t> &a, size_t i,
+                          const BinaryMatrix<uint64_t> &b, size_t j)
+{
+	size_t res = 0;
+	for (size_t k = 0; k < a.cols(); k++) {
+		res += a.get_bit(i, k) && b.get_bit(j, k);
+	}
+	return res;
+}
+
+template <typename T>
+static void test_intersections()
+{
+	auto a = DataGenerator(size_t(5)).generate<T>(150, 20, 130);
+	auto b = DataGenerator(size_t(6)).generate<T>(150, 20, 70);
+	auto pool = std::make_shared<ThreadPool>(3);
+	auto res = PatternOverlap::intersections(a, b, pool.get());
+	ASSERT_EQ(a.rows() * b.rows(), res.size());
+	EXPECT_EQ(res, PatternOverlap::intersections(a, b));
+	std::vector<uint32_t> idx_a, idx_b;
+	for (size_t i = 0; i < a.rows(); i++) {
+		a.active_bits(i, idx_a);
+		for (size_t j = 0; j < b.rows(); j++) {
+			b.active_bits(j, idx_b);
+			size_t n = 0;
+			for (auto k : idx_a) {
+				n += b.get_bit(j, k);
+			}
+			ASSERT_EQ(n, res[i * b.rows() + j]);
+		}
+	}
+	EXPECT_ANY_THROW(
+	    PatternOverlap::intersections(a, BinaryMatrix<T>(3, 149)));
+}
+
+TEST(PatternOverlap, intersections)
+{
+	test_intersections<uint8_t>();
+	test_intersections<uint64_t>();
+}
+
+TEST(PatternOverlap, statistics)
+{
+	auto pool = std::make_shared<ThreadPool>(3);
+	// Sparse and dense data use different algorithms
+	for (size_t ones : {3, 60}) {
+		auto mat = DataGenerator(size_t(7), true, false, false)
+		               .generate<uint64_t>(100, ones, 300);
+		mat.row(17).assign(mat.row(3));
+		mat.row(250).assign(mat.row(3));
+
+		auto usage = PatternOverlap::usage(mat);
+		ASSERT_EQ(100u, usage.size());
+		for (size_t k = 0; k < 100; k++) {
+			size_t n = 0;
+			for (size_t i = 0; i < mat.rows(); i++) {
+				n += mat.get_bit(i, k);
+			}
+			EXPECT_EQ(n, usage[k]);
+		}
+
+		std::vector<size_t> hist(101, 0);
+		std::vector<uint32_t> max_overlap(mat.rows(), 0);
+		size_t duplicates = 0;
+		for (size_t i = 0; i < mat.rows(); i++) {
+			for (size_t j = 0; j < mat.rows(); j++) {
+				if (i == j) {
+					continue;
+				}
+				const size_t c = shared_bits(mat, i, mat, j);
+				max_overlap[i] = std::max<uint32_t>(max_overlap[i], c);
+				if (j > i) {
+					hist[c]++;
+					duplicates += c == ones;
+				}
+			}
+		}
+		for (auto p : {pool.get(), (ThreadPool *)nullptr}) {
+			auto stats = PatternOverlap::statistics(mat, p);
+			EXPECT_EQ(hist, stats.histogram);
+			EXPECT_EQ(max_overlap, stats.max_overlap);
+			EXPECT_EQ(duplicates, stats.duplicates);
+			EXPECT_EQ(300u * 299u / 2, stats.pairs());
+			EXPECT_LE(3u, stats.duplicates);
+			EXPECT_EQ(ones, stats.max_overlap[3]);
+		}
+	}
+}
+
+TEST(PatternOverlap, predict_false_positives)
+{
+	// Balanced and unbalanced data, fewer and more input bits than
+	// MAX_EXACT_ONES. The latter are only approximated.
+	for (size_t ones_in : {4, 14}) {
+		const bool exact = ones_in <= PatternOverlap::MAX_EXACT_ONES;
+		for (bool balanced : {true, false}) {
+			DataParameters params(120, 120, ones_in, 4, exact ? 400 : 260);
+			BiNAM_Container<uint64_t> cont(
+			    params, DataGenerationParameters(11, 1, balanced, 1));
+			cont.set_up().recall();
+			const auto ref =
+			    BiNAM_Container<uint64_t>::sum_false_bits(cont.false_bits());
+			const auto predicted = cont.predicted_false_bits();
+			ASSERT_EQ(params.samples(), predicted.size());
+			const auto sum =
+			    BiNAM_Container<uint64_t>::sum_false_bits(predicted);
+			EXPECT_GT(ref.fp, 0);
+			EXPECT_NEAR(ref.fp, sum.fp, (exact ? 0.1 : 0.4) * ref.fp);
+			EXPECT_EQ(0, sum.fn);
+		}
+	}
+
+	// Repeated inputs with different outputs are predicted as errors
+	BinaryMatrix<uint64_t> in(2, 64), out(2, 64);
+	in.set_bit(0, 3).set_bit(0, 5);
+	in.row(1).assign(in.row(0));
+	out.set_bit(0, 1).set_bit(1, 2);
+	auto res = PatternOverlap::predict_false_positives(in, out);
+	EXPECT_DOUBLE_EQ(1.0, res[0].fp);
+	EXPECT_DOUBLE_EQ(1.0, res[1].fp);
+	EXPECT_ANY_THROW(PatternOverlap::predict_false_positives(
+	    in, BinaryMatrix<uint64_t>(3, 64)));
+}
+}
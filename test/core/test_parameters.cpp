@@ -41,4 +41,23 @@ TEST(parameters, optimal)
 	EXPECT_EQ(2u, DataParameters::optimal(16).ones_out());
 	EXPECT_EQ(2u, DataParameters::optimal(32).ones_out());
 }
+
+TEST(parameters, data_generation_threads)
+{
+	// "threads" is optional and missing in most configurations, so it does
+	// not print a default value warning
+	testing::internal::CaptureStderr();
+	DataGenerationParameters params(cypress::Json::parse(
+	    "{\"seed\": 3, \"random\": 1, \"balanced\": 1, \"unique\": 0}"));
+	EXPECT_EQ("", testing::internal::GetCapturedStderr());
+	EXPECT_EQ(0u, params.threads());
+	EXPECT_EQ(3u, params.seed());
+	EXPECT_FALSE(params.unique());
+
+	params = DataGenerationParameters(cypress::Json::parse(
+	    "{\"seed\": 3, \"random\": 1, \"balanced\": 1, \"unique\": 1, "
+	    "\"threads\": 4}"));
+	EXPECT_EQ(4u, params.threads());
+	EXPECT_TRUE(params.unique());
+}
 }
@@ -17,6 +17,10 @@
  */
 
 #include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <vector>
 #include <gtest/gtest.h>
 #include <util/binary_matrix.hpp>
 #include <cypress/util/matrix.hpp>
@@ -147,4 +151,234 @@ TEST(BinaryMatrix, manipulation)
 	EXPECT_EQ(uint8_t(1), mat.get_bit(2,2));
 	
 }
+
+TEST(BinaryMatrix, active_bits_range)
+{
+	BinaryMatrix<uint8_t> mat(1, 20);
+	mat.set_bit(0, 1).set_bit(0, 7).set_bit(0, 8).set_bit(0, 15).set_bit(0, 19);
+	std::vector<uint32_t> idx;
+	mat.active_bits(0, idx);
+	EXPECT_EQ(std::vector<uint32_t>({1, 7, 8, 15, 19}), idx);
+	mat.active_bits(0, 2, 16, idx);
+	EXPECT_EQ(std::vector<uint32_t>({7, 8, 15}), idx);
+	mat.active_bits(0, 8, 15, idx);
+	EXPECT_EQ(std::vector<uint32_t>({8}), idx);
+	mat.active_bits(0, 16, 100, idx);
+	EXPECT_EQ(std::vector<uint32_t>({19}), idx);
+	mat.active_bits(0, 9, 9, idx);
+	EXPECT_TRUE(idx.empty());
+}
+
+TEST(BinaryMatrix, row_range_merge_io)
+{
+	BinaryMatrix<uint8_t> mat(5, 11), mat2(5, 11);
+	mat.set_bit(0, 0).set_bit(2, 10).set_bit(4, 5);
+	mat2.set_bit(2, 3).set_bit(4, 5);
+
+	auto part = mat.row_range(2, 5);
+	EXPECT_EQ(3u, part.rows());
+	EXPECT_EQ(11u, part.cols());
+	EXPECT_TRUE(part.get_bit(0, 10));
+	EXPECT_TRUE(part.get_bit(2, 5));
+	EXPECT_EQ(0u, mat.row_range(5, 5).rows());
+	EXPECT_ANY_THROW(mat.row_range(3, 6));
+
+	mat |= mat2;
+	EXPECT_TRUE(mat.get_bit(0, 0));
+	EXPECT_TRUE(mat.get_bit(2, 3));
+	EXPECT_TRUE(mat.get_bit(2, 10));
+	EXPECT_TRUE(mat.get_bit(4, 5));
+	EXPECT_FALSE(mat.get_bit(4, 4));
+	EXPECT_ANY_THROW(mat |= BinaryMatrix<uint8_t>(5, 12));
+
+	std::stringstream ss;
+	mat.write(ss);
+	auto mat3 = BinaryMatrix<uint8_t>::read(ss);
+	EXPECT_EQ(mat.rows(), mat3.rows());
+	EXPECT_EQ(mat.cols(), mat3.cols());
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < mat.cols(); j++) {
+			EXPECT_EQ(mat.get_bit(i, j), mat3.get_bit(i, j));
+		}
+	}
+	std::stringstream truncated(ss.str().substr(0, 20));
+	EXPECT_ANY_THROW(BinaryMatrix<uint8_t>::read(truncated));
+}
+
+TEST(BinaryMatrix, aligned_storage)
+{
+	BinaryMatrix<uint64_t> mat(3, 130);
+	EXPECT_EQ(8u, mat.stride());
+	EXPECT_EQ(64u, BinaryMatrix<uint8_t>(1, 9).stride());
+	for (size_t i = 0; i < mat.rows(); i++) {
+		EXPECT_EQ(0u, uintptr_t(mat.row_ptr(i)) % 64);
+	}
+
+	// Padding stays zero and is not part of the file format
+	mat.set_bit(1, 129).set_cell(2, 0, 5);
+	BinaryMatrix<uint64_t> mat2(3, 130);
+	mat2.set_cell(0, 1, BinaryMatrix<uint64_t>::intMax);
+	mat |= mat2;
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 3; j < mat.stride(); j++) {
+			EXPECT_EQ(0u, mat.row_ptr(i)[j]);
+		}
+	}
+	std::stringstream ss;
+	mat.write(ss);
+	EXPECT_EQ(2 * sizeof(size_t) + 3 * 3 * sizeof(uint64_t), ss.str().size());
+	auto mat3 = BinaryMatrix<uint64_t>::read(ss);
+	EXPECT_TRUE(mat3.get_bit(1, 129));
+	EXPECT_EQ(5u, mat3.get_cell(2, 0));
+	EXPECT_EQ(BinaryMatrix<uint64_t>::intMax, mat3.get_cell(0, 1));
+
+	// Huge page backed allocations are zeroed and aligned to huge pages
+	size_t old = AlignedMemory::huge_page_threshold();
+	AlignedMemory::huge_page_threshold(1 << 20);
+	BinaryMatrix<uint64_t> large(1024, 8192);
+	AlignedMemory::huge_page_threshold(old);
+	EXPECT_EQ(0u, uintptr_t(large.row_ptr(0)) % AlignedMemory::HUGE_PAGE_SIZE);
+	EXPECT_EQ(0u, large.get_cell(1023, 127));
+	large.set_bit(1023, 8191);
+	EXPECT_TRUE(BinaryMatrix<uint64_t>(large).get_bit(1023, 8191));
+}
+
+TEST(BinaryMatrix, row_views)
+{
+	BinaryMatrix<uint8_t> mat(3, 20);
+	mat.set_bit(1, 3).set_bit(1, 19);
+	auto view = mat.row(1);
+	EXPECT_EQ(20u, view.size());
+	EXPECT_EQ(3u, view.numberOfCells());
+	EXPECT_TRUE(view.get_bit(19));
+	EXPECT_FALSE(view.get_bit(18));
+	std::vector<uint32_t> idx;
+	view.active_bits(idx);
+	EXPECT_EQ(std::vector<uint32_t>({3, 19}), idx);
+
+	// Writes through the view are visible in the matrix
+	mat.row(2).set_bit(7);
+	mat.row(2).set_bit(0);
+	mat.row(2).set_bit(0, false);
+	EXPECT_TRUE(mat.get_bit(2, 7));
+	EXPECT_FALSE(mat.get_bit(2, 0));
+	mat.row(0).assign(mat.row(1));
+	EXPECT_TRUE(mat.get_bit(0, 19));
+	mat.row(1).clear();
+	EXPECT_FALSE(mat.get_bit(1, 3));
+
+	// row_vec_into() reuses the vector
+	BinaryVector<uint8_t> vec(20);
+	const uint8_t *ptr = vec.row_ptr(0);
+	mat.row_vec_into(2, vec);
+	EXPECT_EQ(ptr, vec.row_ptr(0));
+	EXPECT_TRUE(vec.get_bit(7));
+	BinaryVector<uint8_t> res(20);
+	vec.VectorMult_into(mat.row_vec(0), res);
+	EXPECT_EQ(0u, res.get_cell(0));
+	BinaryVector<uint8_t> wrong(21);
+	EXPECT_ANY_THROW(vec.VectorMult_into(vec, wrong));
+}
+
+template <typename T>
+static void test_transpose(size_t rows, size_t cols)
+{
+	std::mt19937 gen(rows * 1000 + cols);
+	BinaryMatrix<T> mat(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < cols; j++) {
+			mat.set_bit(i, j, gen() % 3 == 0);
+		}
+	}
+	auto check = [&](const BinaryMatrix<T> &t) {
+		ASSERT_EQ(cols, t.rows());
+		ASSERT_EQ(rows, t.cols());
+		for (size_t i = 0; i < rows; i++) {
+			for (size_t j = 0; j < cols; j++) {
+				ASSERT_EQ(mat.get_bit(i, j), t.get_bit(j, i));
+			}
+		}
+		// The padding stays zero
+		for (size_t j = 0; j < cols; j++) {
+			for (size_t k = t.numberOfCells(rows); k < t.stride(); k++) {
+				ASSERT_EQ(T(0), t.row_ptr(j)[k]);
+			}
+		}
+	};
+	check(mat.transposed());
+	ThreadPool pool(3);
+	check(mat.transposed(&pool));
+	BinaryMatrix<T> mat2 = mat;
+	check(mat2.transpose());
+	mat2.transpose(&pool);
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < cols; j++) {
+			ASSERT_EQ(mat.get_bit(i, j), mat2.get_bit(i, j));
+		}
+	}
+}
+
+TEST(BinaryMatrix, transpose)
+{
+	for (auto size : std::vector<std::pair<size_t, size_t>>{
+	         {0, 0}, {1, 1}, {3, 70}, {64, 64}, {130, 70}, {200, 200}}) {
+		test_transpose<uint8_t>(size.first, size.second);
+		test_transpose<uint16_t>(size.first, size.second);
+		test_transpose<uint32_t>(size.second, size.first);
+		test_transpose<uint64_t>(size.second, size.first);
+	}
+}
+
+TEST(BinaryMatrix, mapped)
+{
+	std::mt19937 gen(5);
+	std::bernoulli_distribution dist(0.3);
+	BinaryMatrix<uint32_t> mat(150, 70);
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < mat.cols(); j++) {
+			mat.set_bit(i, j, dist(gen));
+		}
+	}
+	auto equal = [&mat](const BinaryMatrix<uint32_t> &other) {
+		ASSERT_EQ(mat.rows(), other.rows());
+		ASSERT_EQ(mat.cols(), other.cols());
+		for (size_t i = 0; i < mat.rows(); i++) {
+			for (size_t j = 0; j < mat.cols(); j++) {
+				ASSERT_EQ(mat.get_bit(i, j), other.get_bit(i, j));
+			}
+		}
+	};
+
+	// Matrix on a temporary file
+	auto tmp = BinaryMatrix<uint32_t>::mapped(150, 70);
+	EXPECT_TRUE(tmp.mapped());
+	EXPECT_FALSE(mat.mapped());
+	for (size_t i = 0; i < mat.rows(); i++) {
+		EXPECT_TRUE(BitOps::none(tmp.row_ptr(i), tmp.stride()));
+		tmp.row(i).assign(mat.row(i));
+	}
+	equal(tmp);
+	auto t = tmp.transposed();
+	EXPECT_TRUE(t.mapped());
+	t.transpose();
+	equal(t);
+	BinaryMatrix<uint32_t> copy = tmp;
+	EXPECT_FALSE(copy.mapped());
+	equal(copy);
+
+	// Persistent file, reopened with the same and with a wrong size
+	const std::string path = "test_binary_matrix_mapped.bin";
+	std::remove(path.c_str());
+	{
+		auto file = BinaryMatrix<uint32_t>::mapped(path, 150, 70);
+		for (size_t i = 0; i < mat.rows(); i++) {
+			file.row(i).assign(mat.row(i));
+		}
+		file.sync();
+	}
+	equal(BinaryMatrix<uint32_t>::mapped(path, 150, 70));
+	EXPECT_THROW(BinaryMatrix<uint32_t>::mapped(path, 151, 70),
+	             std::runtime_error);
+	std::remove(path.c_str());
+}
 }
@@ -0,0 +1,128 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <util/binary_matrix.hpp>
+#include <util/bit_pack.hpp>
+
+namespace nam {
+
+TEST(BitPack, pack_unpack)
+{
+	std::mt19937 gen(42);
+	std::vector<uint8_t> src(80), dst(80);
+	for (size_t n = 0; n <= 64; n++) {
+		for (auto &v : src) {
+			v = gen() % 4;
+		}
+		for (uint8_t thresh = 0; thresh < 5; thresh++) {
+			uint64_t word = BitPack::pack64(src.data() + 3, n, thresh);
+			for (size_t i = 0; i < 64; i++) {
+				EXPECT_EQ(i < n && src[i + 3] >= thresh,
+				          bool((word >> i) & 1));
+			}
+			std::fill(dst.begin(), dst.end(), 7);
+			BitPack::unpack64(word, n, dst.data() + 1);
+			EXPECT_EQ(7, dst[0]);
+			for (size_t i = 0; i < n; i++) {
+				EXPECT_EQ((word >> i) & 1, dst[i + 1]);
+			}
+			EXPECT_EQ(7, dst[n + 1]);
+		}
+	}
+	for (size_t b = 0; b < 256; b++) {
+		uint64_t v = BitPack::spread8(b);
+		for (size_t k = 0; k < 8; k++) {
+			EXPECT_EQ((b >> k) & 1, (v >> (8 * k)) & 0xFF);
+		}
+	}
+}
+
+template <typename T>
+void test_convert(size_t rows, size_t cols)
+{
+	std::mt19937 gen(rows * 1000 + cols);
+	Matrix<uint8_t> mat(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < cols; j++) {
+			mat(i, j) = gen() % 3;
+		}
+	}
+
+	auto bm = BinaryMatrix<T>::fromMatrix(mat, 2);
+	auto dense = bm.convertToMatrix();
+	std::stringstream ss;
+	bm.print(ss);
+	std::vector<uint32_t> idx;
+	BinaryMatrix<T> from_idx(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		std::string line;
+		std::getline(ss, line);
+		ASSERT_EQ(cols, line.size());
+		for (size_t j = 0; j < cols; j++) {
+			EXPECT_EQ(mat(i, j) >= 2, bm.get_bit(i, j));
+			EXPECT_EQ(uint8_t(mat(i, j) >= 2), dense(i, j));
+			EXPECT_EQ(mat(i, j) >= 2 ? '1' : '0', line[j]);
+		}
+		bm.active_bits(i, idx);
+		from_idx.write_idx(i, idx);
+		// Padding bits stay zero
+		for (size_t j = bm.numberOfCells(cols); j < bm.stride(); j++) {
+			EXPECT_EQ(T(0), bm.row_ptr(i)[j]);
+		}
+	}
+
+	BinaryMatrix<T> from_cols(rows, cols);
+	for (size_t j = 0; j < cols; j++) {
+		Vector<uint8_t> vec(rows);
+		for (size_t i = 0; i < rows; i++) {
+			vec(i) = mat(i, j) >= 2;
+		}
+		from_cols.write_col_vec(j, vec);
+	}
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < bm.numberOfCells(cols); j++) {
+			EXPECT_EQ(bm.get_cell(i, j), from_idx.get_cell(i, j));
+			EXPECT_EQ(bm.get_cell(i, j), from_cols.get_cell(i, j));
+		}
+	}
+}
+
+TEST(BitPack, binary_matrix)
+{
+	for (auto shape : std::vector<std::pair<size_t, size_t>>{
+	         {0, 0}, {1, 1}, {3, 17}, {7, 64}, {5, 100}, {2, 600}}) {
+		test_convert<uint8_t>(shape.first, shape.second);
+		test_convert<uint16_t>(shape.first, shape.second);
+		test_convert<uint32_t>(shape.first, shape.second);
+		test_convert<uint64_t>(shape.first, shape.second);
+	}
+
+	BinaryMatrix<uint64_t> mat(2, 10);
+	EXPECT_THROW(mat.write_idx(0, {10}), std::out_of_range);
+	EXPECT_THROW(mat.write_col_vec(10, Vector<uint8_t>(2)), std::out_of_range);
+	EXPECT_THROW(mat.write_col_vec(0, Vector<uint8_t>(3)), std::out_of_range);
+}
+}
@@ -0,0 +1,74 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include <util/bit_sliced_counter.hpp>
+
+namespace nam {
+
+TEST(BitSlicedCounter, count)
+{
+	BitSlicedCounter<uint8_t> counter;
+	EXPECT_EQ(0u, counter.planes());
+	EXPECT_EQ(uint8_t(0xFF), counter.greater_equal(0));
+	EXPECT_EQ(uint8_t(0), counter.greater_equal(1));
+
+	counter.add(0x01);
+	counter.add(0x03);
+	counter.add(0x07);
+	EXPECT_EQ(2u, counter.planes());
+	EXPECT_EQ(3u, counter.count(0));
+	EXPECT_EQ(2u, counter.count(1));
+	EXPECT_EQ(1u, counter.count(2));
+	EXPECT_EQ(0u, counter.count(3));
+	EXPECT_EQ(uint8_t(0x07), counter.greater_equal(1));
+	EXPECT_EQ(uint8_t(0x03), counter.greater_equal(2));
+	EXPECT_EQ(uint8_t(0x01), counter.greater_equal(3));
+	EXPECT_EQ(uint8_t(0x00), counter.greater_equal(4));
+	EXPECT_EQ(uint8_t(0x00), counter.greater_equal(1000));
+
+	counter.reset();
+	EXPECT_EQ(0u, counter.count(0));
+}
+
+TEST(BitSlicedCounter, random)
+{
+	std::default_random_engine re(42);
+	std::uniform_int_distribution<uint64_t> dist;
+	BitSlicedCounter<uint64_t> counter;
+	std::vector<size_t> counts(64, 0);
+	for (size_t i = 0; i < 300; i++) {
+		uint64_t x = dist(re) & dist(re);
+		counter.add(x);
+		for (size_t j = 0; j < 64; j++) {
+			counts[j] += (x >> j) & 1;
+		}
+	}
+	for (size_t thresh = 0; thresh < 120; thresh += 7) {
+		uint64_t ge = counter.greater_equal(thresh);
+		for (size_t j = 0; j < 64; j++) {
+			EXPECT_EQ(counts[j], counter.count(j));
+			EXPECT_EQ(counts[j] >= thresh, bool((ge >> j) & 1));
+		}
+	}
+}
+}
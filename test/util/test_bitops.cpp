@@ -0,0 +1,126 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <util/bitops.hpp>
+#include <util/population_count.hpp>
+
+namespace nam {
+
+static const SimdLevel LEVELS[] = {SimdLevel::SCALAR, SimdLevel::SSE42,
+                                   SimdLevel::AVX2, SimdLevel::AVX512};
+
+TEST(BitOps, kernels)
+{
+	// Lengths around all vector widths and the Harley-Seal block size,
+	// unaligned starts
+	std::mt19937 gen(42);
+	std::vector<uint8_t> a(2000), b(2000), dst(2000), c(2000, 0);
+	for (auto level : LEVELS) {
+		if (!BitOps::supported(level)) {
+			continue;
+		}
+		const auto &k = BitOps::kernels(level);
+		EXPECT_EQ(level, k.level);
+		for (size_t n : {0, 1, 7, 8, 15, 16, 31, 33, 64, 100, 511, 512, 513,
+		                 1000, 1999}) {
+			const size_t offs = n % 3;
+			for (size_t i = 0; i < a.size(); i++) {
+				a[i] = gen();
+				b[i] = gen() | a[i];
+			}
+			size_t cnt = 0, cnt_and = 0, cnt_andnot = 0;
+			for (size_t i = offs; i < offs + n && i < a.size(); i++) {
+				cnt += population_count<uint8_t>(a[i]);
+				cnt_and += population_count<uint8_t>(a[i] & b[i]);
+				cnt_andnot += population_count<uint8_t>(b[i] & ~a[i]);
+			}
+			n = std::min(n, a.size() - offs);
+			EXPECT_EQ(cnt, k.popcount(&a[offs], n));
+			EXPECT_EQ(cnt_and, k.popcount_and(&a[offs], &b[offs], n));
+			EXPECT_EQ(cnt_andnot, k.popcount_andnot(&b[offs], &a[offs], n));
+			EXPECT_TRUE(k.is_subset(&a[offs], &b[offs], n));
+			EXPECT_EQ(cnt_andnot == 0, k.is_subset(&b[offs], &a[offs], n));
+			EXPECT_EQ(cnt > 0, k.any(&a[offs], n));
+
+			k.bit_and(&dst[offs], &a[offs], &b[offs], n);
+			for (size_t i = offs; i < offs + n; i++) {
+				EXPECT_EQ(uint8_t(a[i] & b[i]), dst[i]);
+			}
+			k.bit_xor(&dst[offs], &a[offs], &b[offs], n);
+			for (size_t i = offs; i < offs + n; i++) {
+				EXPECT_EQ(uint8_t(a[i] ^ b[i]), dst[i]);
+			}
+			k.bit_andnot(&dst[offs], &b[offs], &a[offs], n);
+			for (size_t i = offs; i < offs + n; i++) {
+				EXPECT_EQ(uint8_t(b[i] & ~a[i]), dst[i]);
+			}
+
+			// In-place operation
+			dst = a;
+			k.bit_or(&dst[offs], &dst[offs], &b[offs], n);
+			for (size_t i = offs; i < offs + n; i++) {
+				EXPECT_EQ(b[i], dst[i]);
+			}
+
+			// A single set bit at the end
+			std::fill(dst.begin(), dst.end(), 0);
+			EXPECT_FALSE(k.any(&dst[offs], n));
+			if (n > 0) {
+				dst[offs + n - 1] = 0x80;
+				EXPECT_TRUE(k.any(&dst[offs], n));
+				EXPECT_FALSE(k.is_subset(&dst[offs], &c[offs], n));
+				EXPECT_EQ(1u, k.popcount(&dst[offs], n));
+			}
+		}
+	}
+}
+
+TEST(BitOps, level)
+{
+	const SimdLevel old = BitOps::level();
+	EXPECT_TRUE(BitOps::supported(old));
+	EXPECT_TRUE(BitOps::supported(SimdLevel::SCALAR));
+	EXPECT_TRUE(BitOps::supported(BitOps::detect()));
+	EXPECT_EQ(std::string("avx2"), BitOps::name(SimdLevel::AVX2));
+
+	std::vector<uint64_t> a{0xFF, 0x1, 0x0}, b{0x0F, 0x3, 0x0}, c(3);
+	for (auto level : LEVELS) {
+		if (!BitOps::supported(level)) {
+			EXPECT_THROW(BitOps::level(level), std::invalid_argument);
+			continue;
+		}
+		BitOps::level(level);
+		EXPECT_EQ(level, BitOps::level());
+		EXPECT_EQ(9u, BitOps::popcount(a.data(), 3));
+		EXPECT_EQ(5u, BitOps::popcount_and(a.data(), b.data(), 3));
+		EXPECT_TRUE(BitOps::is_subset(b.data() + 1, b.data() + 1, 2));
+		EXPECT_FALSE(BitOps::is_subset(b.data(), a.data() + 1, 2));
+		EXPECT_TRUE(BitOps::none(a.data() + 2, 1));
+		BitOps::bit_andnot(c.data(), a.data(), b.data(), 3);
+		EXPECT_EQ(0xF0u, c[0]);
+	}
+	BitOps::level(old);
+}
+}
@@ -0,0 +1,90 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <util/compressed_bitmap.hpp>
+
+namespace nam {
+
+static void check_bitmap(const CompressedBitmap &bm,
+                         const std::set<size_t> &ref)
+{
+	EXPECT_EQ(ref.size(), bm.count());
+	std::vector<size_t> bits;
+	bm.for_each([&](size_t i) { bits.push_back(i); });
+	EXPECT_EQ(std::vector<size_t>(ref.begin(), ref.end()), bits);
+	for (size_t i = 0; i < bm.size(); i += 7) {
+		EXPECT_EQ(ref.count(i) > 0, bm.contains(i));
+	}
+}
+
+TEST(CompressedBitmap, add)
+{
+	using Type = CompressedBitmap::Type;
+	const size_t size = 3 * CompressedBitmap::CHUNK_BITS + 1000;
+	std::mt19937 gen(7);
+	CompressedBitmap bm(size);
+	std::set<size_t> ref;
+	EXPECT_EQ(0u, bm.count());
+
+	// Few bits: lists only
+	for (size_t k = 0; k < 100; k++) {
+		size_t i = gen() % size;
+		EXPECT_EQ(ref.insert(i).second, bm.add(i));
+	}
+	EXPECT_FALSE(bm.add(*ref.begin()));
+	check_bitmap(bm, ref);
+	EXPECT_EQ(0u, bm.containers(Type::BITMAP));
+	EXPECT_LT(bm.memory(), 2000u);
+
+	// Dense chunk: switches to a bitmap
+	for (size_t k = 0; k < 10000; k++) {
+		size_t i = gen() % 20000;
+		EXPECT_EQ(ref.insert(i).second, bm.add(i));
+	}
+	check_bitmap(bm, ref);
+	EXPECT_EQ(1u, bm.containers(Type::BITMAP));
+
+	// Long runs in the last, short chunk
+	for (size_t i = size - 900; i < size - 100; i++) {
+		ref.insert(i);
+		bm.add(i);
+	}
+	bm.optimize();
+	check_bitmap(bm, ref);
+	EXPECT_EQ(1u, bm.containers(Type::RUN));
+	EXPECT_EQ(1u, bm.containers(Type::BITMAP));
+
+	// Adding to runs decodes them
+	EXPECT_FALSE(bm.add(size - 500));
+	EXPECT_TRUE(bm.add(size - 50));
+	ref.insert(size - 50);
+	check_bitmap(bm, ref);
+	EXPECT_EQ(0u, bm.containers(Type::RUN));
+
+	EXPECT_THROW(bm.add(size), std::out_of_range);
+	EXPECT_FALSE(bm.contains(size));
+}
+}
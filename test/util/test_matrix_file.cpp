@@ -0,0 +1,155 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <util/binary_matrix.hpp>
+#include <util/matrix_file.hpp>
+
+namespace nam {
+
+template <typename T>
+static BinaryMatrix<T> random_matrix(size_t rows, size_t cols)
+{
+	std::mt19937 gen(7);
+	std::bernoulli_distribution dist(0.2);
+	BinaryMatrix<T> res(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < cols; j++) {
+			res.set_bit(i, j, dist(gen));
+		}
+	}
+	return res;
+}
+
+template <typename T, typename U>
+static void expect_equal(const BinaryMatrix<T> &a, const BinaryMatrix<U> &b)
+{
+	ASSERT_EQ(a.rows(), b.rows());
+	ASSERT_EQ(a.cols(), b.cols());
+	for (size_t i = 0; i < a.rows(); i++) {
+		for (size_t j = 0; j < a.cols(); j++) {
+			ASSERT_EQ(a.get_bit(i, j), b.get_bit(i, j));
+		}
+	}
+}
+
+TEST(MatrixFile, read_write)
+{
+	const std::string path = "test_matrix_file.bin";
+	auto mat = random_matrix<uint64_t>(300, 130);
+	MatrixFile::Info info;
+	info.content = MatrixFile::Content::DATA;
+	info.ones = 4;
+	info.seed = 1234;
+	info.balanced = true;
+	MatrixFile::write(path, mat, info);
+	EXPECT_TRUE(MatrixFile::is_matrix_file(path));
+
+	MatrixFile::Info res_info;
+	auto res = MatrixFile::read<uint64_t>(path, true, &res_info);
+	EXPECT_TRUE(res.mapped());
+	expect_equal(mat, res);
+	EXPECT_EQ(MatrixFile::Content::DATA, res_info.content);
+	EXPECT_EQ(4u, res_info.ones);
+	EXPECT_EQ(1234u, res_info.seed);
+	EXPECT_FALSE(res_info.random);
+	EXPECT_TRUE(res_info.balanced);
+	EXPECT_FALSE(res_info.unique);
+
+	// Changes of the loaded matrix stay in memory
+	res.set_bit(0, 0, !res.get_bit(0, 0));
+	expect_equal(mat, MatrixFile::read<uint64_t>(path));
+
+	// Same bit layout with other cell widths
+	expect_equal(mat, MatrixFile::read<uint8_t>(path));
+	expect_equal(mat, MatrixFile::read<uint32_t>(path));
+
+	// Empty matrix
+	MatrixFile::write(path, BinaryMatrix<uint64_t>(0, 10));
+	res = MatrixFile::read<uint64_t>(path);
+	EXPECT_EQ(0u, res.rows());
+	EXPECT_EQ(10u, res.cols());
+	std::remove(path.c_str());
+}
+
+TEST(MatrixFile, legacy_format)
+{
+	const std::string path = "test_matrix_file_legacy.bin";
+	auto mat = random_matrix<uint64_t>(50, 70);
+	{
+		std::ofstream ofs(path, std::ios::binary);
+		mat.write(ofs);
+	}
+	EXPECT_FALSE(MatrixFile::is_matrix_file(path));
+	MatrixFile::Info info;
+	info.ones = 5;
+	auto res = MatrixFile::read<uint64_t>(path, true, &info);
+	EXPECT_FALSE(res.mapped());
+	EXPECT_EQ(0u, info.ones);
+	expect_equal(mat, res);
+	std::remove(path.c_str());
+	EXPECT_THROW(MatrixFile::read<uint64_t>(path), std::runtime_error);
+}
+
+TEST(MatrixFile, corrupted)
+{
+	const std::string path = "test_matrix_file_corrupted.bin";
+	auto mat = random_matrix<uint64_t>(100, 100);
+	auto patch = [&](size_t offs, uint8_t value) {
+		MatrixFile::write(path, mat);
+		std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+		fs.seekp(offs);
+		fs.write(reinterpret_cast<const char *>(&value), 1);
+	};
+
+	// Data checksum, only tested if requested
+	patch(MatrixFile::HEADER_SIZE + 3, 0xAA);
+	EXPECT_THROW(MatrixFile::read<uint64_t>(path), std::runtime_error);
+	EXPECT_NO_THROW(MatrixFile::read<uint64_t>(path, false));
+
+	// Header fields
+	patch(offsetof(MatrixFile::Header, rows), 99);
+	EXPECT_THROW(MatrixFile::read<uint64_t>(path), std::runtime_error);
+	patch(offsetof(MatrixFile::Header, version), 2);
+	EXPECT_THROW(MatrixFile::read_header(path), std::runtime_error);
+	patch(offsetof(MatrixFile::Header, byte_order), 1);
+	EXPECT_THROW(MatrixFile::read_header(path), std::runtime_error);
+
+	// Truncated file
+	MatrixFile::write(path, mat);
+	{
+		std::ifstream ifs(path, std::ios::binary);
+		std::string data((std::istreambuf_iterator<char>(ifs)),
+		                 std::istreambuf_iterator<char>());
+		std::ofstream ofs(path, std::ios::binary);
+		ofs.write(data.data(), data.size() - 64);
+	}
+	EXPECT_THROW(MatrixFile::read<uint64_t>(path), std::runtime_error);
+	std::remove(path.c_str());
+}
+}
@@ -0,0 +1,151 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <util/binary_matrix.hpp>
+#include <util/data.hpp>
+#include <util/matrix_file.hpp>
+#include <util/pattern_file.hpp>
+
+namespace nam {
+
+TEST(PatternFile, fixed_ones)
+{
+	const std::string path = "test_pattern_file.bin";
+	auto data = DataGenerator(size_t(5)).generate_sparse(1600, 4, 1000);
+	MatrixFile::Info info;
+	info.seed = 5;
+	{
+		PatternFileWriter writer(path, 1600, info, 300);
+		writer.add(data);
+		EXPECT_EQ(1000u, writer.rows());
+	}
+
+	PatternFileReader reader(path);
+	EXPECT_EQ(1000u, reader.rows());
+	EXPECT_EQ(1600u, reader.cols());
+	EXPECT_EQ(4u, reader.ones());
+	EXPECT_EQ(5u, reader.info().seed);
+	EXPECT_EQ(4u, reader.blocks());
+	EXPECT_EQ(900u, reader.block_begin(3));
+	EXPECT_EQ(1000u, reader.block_end(3));
+	EXPECT_LT(reader.bytes(), MatrixFile::HEADER_SIZE + 1000 * 10);
+
+	auto sparse = reader.read_sparse();
+	ASSERT_EQ(data.rows(), sparse.rows());
+	for (size_t i = 0; i < data.rows(); i++) {
+		for (size_t j = 0; j < data.ones(); j++) {
+			ASSERT_EQ(data.row_ptr(i)[j], sparse.row_ptr(i)[j]);
+		}
+	}
+	auto dense = data.toBinaryMatrix<uint64_t>();
+	auto block = reader.dense_block<uint64_t>(2);
+	auto block_sparse = reader.sparse_block(2);
+	ASSERT_EQ(300u, block.rows());
+	for (size_t i = 0; i < block.rows(); i++) {
+		for (size_t j = 0; j < block.cols(); j++) {
+			ASSERT_EQ(dense.get_bit(600 + i, j), block.get_bit(i, j));
+			ASSERT_EQ(dense.get_bit(600 + i, j), block_sparse.get_bit(i, j));
+		}
+	}
+	EXPECT_THROW(reader.sparse_block(4), std::out_of_range);
+	EXPECT_THROW(MatrixFile::read<uint64_t>(path), std::runtime_error);
+	EXPECT_TRUE(is_pattern_file(path));
+	MatrixFile::Info res_info;
+	auto res = read_pattern_file<uint64_t>(path, &res_info);
+	EXPECT_EQ(5u, res_info.seed);
+	ASSERT_EQ(dense.rows(), res.rows());
+	for (size_t i = 0; i < dense.rows(); i++) {
+		for (size_t j = 0; j < dense.cols(); j++) {
+			ASSERT_EQ(dense.get_bit(i, j), res.get_bit(i, j));
+		}
+	}
+	std::remove(path.c_str());
+
+	MatrixFile::write(path, dense, info);
+	EXPECT_FALSE(is_pattern_file(path));
+	res = read_pattern_file<uint64_t>(path);
+	ASSERT_EQ(dense.rows(), res.rows());
+	for (size_t i = 0; i < dense.rows(); i++) {
+		for (size_t j = 0; j < dense.cols(); j++) {
+			ASSERT_EQ(dense.get_bit(i, j), res.get_bit(i, j));
+		}
+	}
+	std::remove(path.c_str());
+}
+
+TEST(PatternFile, variable_ones)
+{
+	const std::string path = "test_pattern_file_variable.bin";
+	BinaryMatrix<uint32_t> mat(70, 200);
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < i % 7; j++) {
+			mat.set_bit(i, (i * 31 + j * 29) % 200);
+		}
+	}
+	{
+		PatternFileWriter writer(path, 200, MatrixFile::Info(), 16);
+		writer.add(mat);
+		EXPECT_THROW(writer.add({3, 3}), std::out_of_range);
+		EXPECT_THROW(writer.add({200}), std::out_of_range);
+		writer.close();
+		EXPECT_THROW(writer.add({1}), std::runtime_error);
+	}
+	PatternFileReader reader(path);
+	EXPECT_EQ(0u, reader.ones());
+	EXPECT_THROW(reader.read_sparse(), std::runtime_error);
+	auto res = reader.read<uint32_t>();
+	ASSERT_EQ(mat.rows(), res.rows());
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < mat.cols(); j++) {
+			ASSERT_EQ(mat.get_bit(i, j), res.get_bit(i, j));
+		}
+	}
+
+	// Empty file
+	PatternFileWriter(path, 10).close();
+	EXPECT_EQ(0u, PatternFileReader(path).read<uint8_t>().rows());
+	std::remove(path.c_str());
+}
+
+TEST(PatternFile, corrupted)
+{
+	const std::string path = "test_pattern_file_corrupted.bin";
+	auto data = DataGenerator(size_t(2)).generate_sparse(100, 3, 50);
+	PatternFileWriter(path, 100, MatrixFile::Info(), 20).add(data).close();
+	{
+		std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+		fs.seekp(MatrixFile::HEADER_SIZE + 1);
+		fs.put(char(0xFF));
+	}
+	PatternFileReader reader(path);
+	EXPECT_THROW(reader.sparse_block(0), std::runtime_error);
+	EXPECT_NO_THROW(reader.sparse_block(1));
+	EXPECT_THROW(PatternFileReader(path, false).read<uint8_t>(),
+	             std::runtime_error);
+	std::remove(path.c_str());
+}
+}
@@ -29,4 +29,20 @@ TEST(population_count, basic) {
 	EXPECT_EQ(uint64_t(1), population_count<uint64_t>(0x1L << 63));
 }
 
+TEST(population_count, generic) {
+	// Types without a specialisation use the generic loop
+	EXPECT_EQ(0u, population_count<unsigned long long>(0));
+	EXPECT_EQ(64u, population_count<unsigned long long>(~0ULL));
+	EXPECT_EQ(3u, population_count<char32_t>(0x10101));
+}
+
+TEST(population_count, uint128) {
+	const uint128_t high = uint128_t(1) << 100;
+	EXPECT_EQ(2u, population_count<uint128_t>(high | 1));
+	EXPECT_EQ(128u, population_count<uint128_t>(~uint128_t(0)));
+	EXPECT_EQ(0u, trailing_zeros<uint128_t>(high | 1));
+	EXPECT_EQ(100u, trailing_zeros<uint128_t>(high));
+	EXPECT_EQ(64u, trailing_zeros<uint128_t>(uint128_t(1) << 64));
+}
+
 }
@@ -0,0 +1,91 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <util/binary_matrix.hpp>
+#include <util/data.hpp>
+#include <util/sparse_pattern_matrix.hpp>
+
+namespace nam {
+
+TEST(SparsePatternMatrix, convert)
+{
+	SparsePatternMatrix mat(3, 100, 3);
+	EXPECT_EQ(3u, mat.rows());
+	EXPECT_EQ(100u, mat.cols());
+	EXPECT_EQ(3u, mat.ones());
+	EXPECT_EQ(36u, mat.memory());
+	mat.set_row(0, {99, 5, 64}).set_row(2, {1, 2, 3});
+	EXPECT_EQ(5u, mat.row_ptr(0)[0]);
+	EXPECT_EQ(64u, mat.row_ptr(0)[1]);
+	EXPECT_EQ(99u, mat.row_ptr(0)[2]);
+	EXPECT_TRUE(mat.get_bit(0, 64));
+	EXPECT_FALSE(mat.get_bit(0, 63));
+	EXPECT_TRUE(mat.get_bit(1, 0));
+
+	auto dense = mat.toBinaryMatrix<uint16_t>();
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < mat.cols(); j++) {
+			EXPECT_EQ(mat.get_bit(i, j), dense.get_bit(i, j));
+		}
+	}
+	auto back = SparsePatternMatrix::fromBinaryMatrix(dense);
+	ASSERT_EQ(mat.rows(), back.rows());
+	ASSERT_EQ(mat.ones(), back.ones());
+	for (size_t i = 0; i < mat.rows(); i++) {
+		for (size_t j = 0; j < mat.ones(); j++) {
+			EXPECT_EQ(mat.row_ptr(i)[j], back.row_ptr(i)[j]);
+		}
+	}
+
+	EXPECT_THROW(mat.set_row(0, {1, 2}), std::out_of_range);
+	EXPECT_THROW(mat.set_row(0, {1, 2, 100}), std::out_of_range);
+	EXPECT_THROW(mat.set_row(0, {1, 2, 2}), std::out_of_range);
+	EXPECT_THROW(mat.set_row(3, {1, 2, 3}), std::out_of_range);
+	EXPECT_THROW(SparsePatternMatrix(1, 2, 3), std::out_of_range);
+	dense.set_bit(1, 50);
+	EXPECT_THROW(SparsePatternMatrix::fromBinaryMatrix(dense),
+	             std::out_of_range);
+}
+
+TEST(SparsePatternMatrix, generate)
+{
+	// Same patterns as the dense generator for all modes
+	for (int mode = 0; mode < 4; mode++) {
+		DataGenerator gen(size_t(17), mode != 1, mode == 2, mode == 3);
+		auto dense = gen.generate<uint64_t>(200, 5, 300);
+		auto sparse = gen.generate_sparse(200, 5, 300);
+		ASSERT_EQ(dense.rows(), sparse.rows());
+		for (size_t i = 0; i < dense.rows(); i++) {
+			for (size_t j = 0; j < dense.cols(); j++) {
+				ASSERT_EQ(dense.get_bit(i, j), sparse.get_bit(i, j));
+			}
+		}
+	}
+
+	// Aborted generation only returns the finished samples
+	auto sparse = DataGenerator(size_t(17)).generate_sparse(
+	    200, 5, 300, [](float p) { return p < 0.5; });
+	EXPECT_EQ(201u, sparse.rows());
+}
+}
@@ -0,0 +1,99 @@
+/*
+ *  CppNAM -- C++ Neural Associative Memory Simulator
+ *  Copyright (C) 2016  Christoph Jenzen, Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <util/thread_pool.hpp>
+
+namespace nam {
+
+TEST(ThreadPool, parallel_for)
+{
+	for (size_t threads : {1, 2, 4, 7}) {
+		ThreadPool pool(threads);
+		EXPECT_EQ(threads, pool.threads());
+		for (size_t align : {1, 3, 64}) {
+			std::vector<std::atomic<int>> visited(1000);
+			for (auto &v : visited) {
+				v = 0;
+			}
+			pool.parallel_for(10, 1000, align, [&](size_t begin, size_t end) {
+				EXPECT_EQ(0u, (begin - 10) % align);
+				EXPECT_TRUE(end == 1000 || (end - 10) % align == 0);
+				for (size_t i = begin; i < end; i++) {
+					visited[i]++;
+				}
+			});
+			for (size_t i = 0; i < visited.size(); i++) {
+				EXPECT_EQ(i < 10 ? 0 : 1, visited[i]);
+			}
+		}
+
+		// Empty ranges do not call the function
+		pool.parallel_for(5, 5, 1, [](size_t, size_t) { FAIL(); });
+	}
+}
+
+TEST(ThreadPool, nested)
+{
+	ThreadPool pool(4);
+	std::atomic<size_t> sum(0);
+	pool.parallel_for(0, 16, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			pool.parallel_for(0, 100, 1, [&](size_t b, size_t e) {
+				sum += e - b;
+			});
+		}
+	});
+	EXPECT_EQ(1600u, sum);
+}
+
+TEST(ThreadPool, exception)
+{
+	ThreadPool pool(4);
+	auto f = [](size_t begin, size_t) {
+		if (begin > 50) {
+			throw std::runtime_error("Test");
+		}
+	};
+	EXPECT_THROW(pool.parallel_for(0, 100, 1, f), std::runtime_error);
+
+	// The pool is still usable afterwards
+	std::atomic<size_t> sum(0);
+	pool.parallel_for(0, 100, 1, [&](size_t b, size_t e) { sum += e - b; });
+	EXPECT_EQ(100u, sum);
+}
+
+TEST(ThreadPool, default_threads)
+{
+	setenv(ThreadPool::ENV_THREADS, "3", 1);
+	EXPECT_EQ(3u, ThreadPool::default_threads());
+	EXPECT_EQ(3u, ThreadPool::shared()->threads());
+	EXPECT_EQ(2u, ThreadPool::shared(2)->threads());
+	EXPECT_EQ(ThreadPool::shared(2), ThreadPool::shared(2));
+	setenv(ThreadPool::ENV_THREADS, "three", 1);
+	EXPECT_THROW(ThreadPool::default_threads(), std::invalid_argument);
+	unsetenv(ThreadPool::ENV_THREADS);
+	EXPECT_LE(1u, ThreadPool::default_threads());
+}
+}